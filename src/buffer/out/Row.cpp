@@ -96,6 +96,13 @@ til::CoordType CharToColumnMapper::GetLeadingColumnAt(ptrdiff_t offset) noexcept
 {
     offset = clamp(offset, 0, _lastCharOffset);
 
+    // In a trivial layout, every column holds exactly 1 char.
+    if (!_charOffsets)
+    {
+        _currentColumn = gsl::narrow_cast<til::CoordType>(offset);
+        return _currentColumn;
+    }
+
     auto col = _currentColumn;
     const auto currentOffset = _charOffsets[col];
 
@@ -144,6 +151,10 @@ til::CoordType CharToColumnMapper::GetLeadingColumnAt(ptrdiff_t offset) noexcept
 til::CoordType CharToColumnMapper::GetTrailingColumnAt(ptrdiff_t offset) noexcept
 {
     auto col = GetLeadingColumnAt(offset);
+    if (!_charOffsets)
+    {
+        return col;
+    }
     // This loop is a little redundant with the forward search loop in GetLeadingColumnAt()
     // but it's realistically not worth caring about this. This code is not a bottleneck.
     for (; WI_IsFlagSet(_charOffsets[col + 1], CharOffsetsTrailer); ++col)
@@ -226,6 +237,16 @@ til::CoordType ROW::GetReadableColumnCount() const noexcept
     return (_columnCount - (_doubleBytePadded << 1)) >> 1;
 }
 
+void ROW::SetMutationId(const uint64_t mutationId) noexcept
+{
+    _mutationId = mutationId;
+}
+
+uint64_t ROW::GetMutationId() const noexcept
+{
+    return _mutationId;
+}
+
 // Routine Description:
 // - Sets all properties of the ROW to default values
 // Arguments:
@@ -252,25 +273,23 @@ void ROW::_init() noexcept
 #pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
 #pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
 
-    // Fills _charsBuffer with whitespace and correspondingly _charOffsets
-    // with successive numbers from 0 to _columnCount+1.
+    // Fills _charsBuffer with whitespace. Since every column now holds exactly 1 char,
+    // the row has a trivial layout and _charOffsets doesn't need to be filled in.
+    _trivialLayout = true;
+
 #if defined(TIL_SSE_INTRINSICS)
     alignas(__m256i) static constexpr uint16_t whitespaceData[]{ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20 };
-    alignas(__m256i) static constexpr uint16_t offsetsData[]{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
-    alignas(__m256i) static constexpr uint16_t increment16Data[]{ 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16 };
-    alignas(__m128i) static constexpr uint16_t increment8Data[]{ 8, 8, 8, 8, 8, 8, 8, 8 };
 
-    // The AVX loop operates on 32 bytes at a minimum. Since _charsBuffer/_charOffsets uses 2 byte large
-    // wchar_t/uint16_t respectively, this translates to 16-element writes, which equals a _columnCount of 15,
-    // because it doesn't include the past-the-end char-offset as described in the _charOffsets member comment.
+    // The AVX loop operates on 32 bytes at a minimum. Since _charsBuffer uses 2 byte large
+    // wchar_t, this translates to 16-element writes, which equals a _columnCount of 15,
+    // because CalculateCharsBufferSize() reserves room for 1 more element than the row is wide.
     if (__isa_available >= __ISA_AVAILABLE_AVX2 && _columnCount >= 15)
     {
         auto chars = _charsBuffer;
-        auto charOffsets = _charOffsets.data();
 
-        // The backing buffer for both chars and charOffsets is guaranteed to be 16-byte aligned,
+        // The backing buffer for chars is guaranteed to be 16-byte aligned,
         // but AVX operations are 32-byte large. As such, when we write out the last chunk, we
-        // have to align it to the ends of the 2 buffers. This results in a potential overlap of
+        // have to align it to the end of the buffer. This results in a potential overlap of
         // 16 bytes between the last write in the main loop below and the final write afterwards.
         //
         // An example:
@@ -286,80 +305,60 @@ void ROW::_init() noexcept
         // you'll see how this is effectively the inverse of what CalculateCharsBufferStride does.
         const auto tailColumnOffset = gsl::narrow_cast<uint16_t>((_columnCount - 8u) & ~7);
         const auto charsEndLoop = chars + tailColumnOffset;
-        const auto charOffsetsEndLoop = charOffsets + tailColumnOffset;
 
         const auto whitespace = _mm256_load_si256(reinterpret_cast<const __m256i*>(&whitespaceData[0]));
-        auto offsetsLoop = _mm256_load_si256(reinterpret_cast<const __m256i*>(&offsetsData[0]));
-        const auto offsets = _mm256_add_epi16(offsetsLoop, _mm256_set1_epi16(tailColumnOffset));
 
-        if (chars < charsEndLoop)
+        for (; chars < charsEndLoop; chars += 16)
         {
-            const auto increment = _mm256_load_si256(reinterpret_cast<const __m256i*>(&increment16Data[0]));
-
-            do
-            {
-                _mm256_storeu_si256(reinterpret_cast<__m256i*>(chars), whitespace);
-                _mm256_storeu_si256(reinterpret_cast<__m256i*>(charOffsets), offsetsLoop);
-                offsetsLoop = _mm256_add_epi16(offsetsLoop, increment);
-                chars += 16;
-                charOffsets += 16;
-            } while (chars < charsEndLoop);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(chars), whitespace);
         }
 
         _mm256_storeu_si256(reinterpret_cast<__m256i*>(charsEndLoop), whitespace);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(charOffsetsEndLoop), offsets);
     }
     else
     {
         auto chars = _charsBuffer;
-        auto charOffsets = _charOffsets.data();
         const auto charsEnd = chars + _columnCount;
 
         const auto whitespace = _mm_load_si128(reinterpret_cast<const __m128i*>(&whitespaceData[0]));
-        const auto increment = _mm_load_si128(reinterpret_cast<const __m128i*>(&increment8Data[0]));
-        auto offsets = _mm_load_si128(reinterpret_cast<const __m128i*>(&offsetsData[0]));
 
         do
         {
             _mm_storeu_si128(reinterpret_cast<__m128i*>(chars), whitespace);
-            _mm_storeu_si128(reinterpret_cast<__m128i*>(charOffsets), offsets);
-            offsets = _mm_add_epi16(offsets, increment);
             chars += 8;
-            charOffsets += 8;
-            // If _columnCount is something like 120, the actual backing buffer for charOffsets is 121 items large.
-            // --> The while loop uses <= to emit at least 1 more write.
-        } while (chars <= charsEnd);
+        } while (chars < charsEnd);
     }
 #elif defined(TIL_ARM_NEON_INTRINSICS)
-    alignas(uint16x8_t) static constexpr uint16_t offsetsData[]{ 0, 1, 2, 3, 4, 5, 6, 7 };
-
     auto chars = _charsBuffer;
-    auto charOffsets = _charOffsets.data();
     const auto charsEnd = chars + _columnCount;
 
     const auto whitespace = vdupq_n_u16(L' ');
-    const auto increment = vdupq_n_u16(8);
-    auto offsets = vld1q_u16(&offsetsData[0]);
 
     do
     {
         vst1q_u16(chars, whitespace);
-        vst1q_u16(charOffsets, offsets);
-        offsets = vaddq_u16(offsets, increment);
         chars += 8;
-        charOffsets += 8;
-        // If _columnCount is something like 120, the actual backing buffer for charOffsets is 121 items large.
-        // --> The while loop uses <= to emit at least 1 more write.
-    } while (chars <= charsEnd);
+    } while (chars < charsEnd);
 #else
 #error "Vectorizing this function improves overall performance by up to 40%. Don't remove this warning, just add the vectorized code."
     std::fill_n(_charsBuffer, _columnCount, UNICODE_SPACE);
-    std::iota(_charOffsets.begin(), _charOffsets.end(), uint16_t{ 0 });
 #endif
 
 #pragma warning(push)
 }
 
+// Switches the row from its trivial layout (see _trivialLayout) to explicit char offsets.
+// Since in a trivial layout every column maps to the char at the same offset,
+// this fills _charOffsets with successive numbers from 0 to _columnCount+1.
+void ROW::_initCharOffsets() noexcept
+{
+    if (_trivialLayout)
+    {
+        std::iota(_charOffsets.begin(), _charOffsets.end(), uint16_t{ 0 });
+        _trivialLayout = false;
+    }
+}
+
 void ROW::TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth)
 {
     _attr = attr;
@@ -562,6 +561,7 @@ void ROW::ReplaceAttributes(const til::CoordType beginIndex, const til::CoordTyp
     colEnd = colBeg;
     colEndDirty = 0;
     charsConsumed = 0;
+    fill = false;
 }
 
 [[msvc::forceinline]] bool ROW::WriteHelper::IsValid() const noexcept
@@ -596,8 +596,15 @@ catch (...)
     {
         colEndDirty = colLimit;
     }
+    else if (row._trivialLayout && width == 1 && chars.size() == 1)
+    {
+        colEnd = colEndNew;
+        colEndDirty = colEnd;
+        charsConsumed = 1;
+    }
     else
     {
+        row._initCharOffsets();
         til::at(row._charOffsets, colEnd++) = chBeg;
         for (; colEnd < colEndNew; ++colEnd)
         {
@@ -650,6 +657,82 @@ catch (...)
     const auto end = it + std::min<size_t>(chars.size(), colLimit - colBeg);
     size_t ch = chBeg;
 
+    // ASCII doesn't change a trivial layout, in which case there are no offsets to write
+    // and the loops below only need to find out how much of the text is ASCII.
+    const auto writeOffsets = !row._trivialLayout;
+
+    // For ASCII the char offsets are simply successive numbers starting at chBeg,
+    // so we can check and write entire blocks of them at once. A block that contains
+    // non-ASCII characters is left to the scalar loop below, which finds the exact
+    // position where it needs to hand off to _replaceTextUnicode.
+    //
+    // Since `end - it` is at most `colLimit - colEnd`, a full block never writes past colLimit.
+#pragma warning(push)
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if defined(TIL_SSE_INTRINSICS)
+    alignas(__m256i) static constexpr uint16_t offsetsData[]{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+    if (__isa_available >= __ISA_AVAILABLE_AVX2)
+    {
+        const auto offsets = _mm256_load_si256(reinterpret_cast<const __m256i*>(&offsetsData[0]));
+        const auto nonAscii = _mm256_set1_epi16(static_cast<short>(0xff80));
+
+        for (; end - it >= 16; it += 16, colEnd += 16, ch += 16)
+        {
+            const auto text = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&*it));
+            if (!_mm256_testz_si256(text, nonAscii))
+            {
+                break;
+            }
+            if (!writeOffsets)
+            {
+                continue;
+            }
+            const auto off = _mm256_add_epi16(offsets, _mm256_set1_epi16(gsl::narrow_cast<short>(ch)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(row._charOffsets.data() + colEnd), off);
+        }
+    }
+
+    {
+        const auto offsets = _mm_load_si128(reinterpret_cast<const __m128i*>(&offsetsData[0]));
+        const auto nonAscii = _mm_set1_epi16(static_cast<short>(0xff80));
+
+        for (; end - it >= 8; it += 8, colEnd += 8, ch += 8)
+        {
+            const auto text = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&*it));
+            const auto ascii = _mm_cmpeq_epi16(_mm_and_si128(text, nonAscii), _mm_setzero_si128());
+            if (_mm_movemask_epi8(ascii) != 0xffff)
+            {
+                break;
+            }
+            if (!writeOffsets)
+            {
+                continue;
+            }
+            const auto off = _mm_add_epi16(offsets, _mm_set1_epi16(gsl::narrow_cast<short>(ch)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row._charOffsets.data() + colEnd), off);
+        }
+    }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+    alignas(uint16x8_t) static constexpr uint16_t offsetsData[]{ 0, 1, 2, 3, 4, 5, 6, 7 };
+    const auto offsets = vld1q_u16(&offsetsData[0]);
+
+    for (; end - it >= 8; it += 8, colEnd += 8, ch += 8)
+    {
+        const auto text = vld1q_u16(reinterpret_cast<const uint16_t*>(&*it));
+        if (vmaxvq_u16(text) >= 0x80)
+        {
+            break;
+        }
+        if (!writeOffsets)
+        {
+            continue;
+        }
+        vst1q_u16(row._charOffsets.data() + colEnd, vaddq_u16(offsets, vdupq_n_u16(gsl::narrow_cast<uint16_t>(ch))));
+    }
+#endif
+#pragma warning(pop)
+
     while (it != end)
     {
         if (*it >= 0x80) [[unlikely]]
@@ -658,7 +741,10 @@ catch (...)
             return;
         }
 
-        til::at(row._charOffsets, colEnd) = gsl::narrow_cast<uint16_t>(ch);
+        if (writeOffsets)
+        {
+            til::at(row._charOffsets, colEnd) = gsl::narrow_cast<uint16_t>(ch);
+        }
         ++colEnd;
         ++ch;
         ++it;
@@ -709,6 +795,18 @@ catch (...)
             return;
         }
 
+        // Narrow characters that fit into a single wchar_t don't change a trivial layout.
+        if (row._trivialLayout)
+        {
+            if (width == 1 && advance == 1)
+            {
+                colEnd = colEndNew;
+                ch += advance;
+                continue;
+            }
+            row._initCharOffsets();
+        }
+
         // Fill our char-offset buffer with 1 entry containing the mapping from the
         // current column (colEnd) to the start of the glyph in the string (ch)...
         til::at(row._charOffsets, colEnd++) = gsl::narrow_cast<uint16_t>(ch);
@@ -726,6 +824,68 @@ catch (...)
     charsConsumed = ch - chBeg;
 }
 
+// Fills the columns [state.columnBegin, state.columnLimit) with copies of state.text, which must consist of
+// a single narrow character. This is the same as calling ReplaceText() repeatedly, just a lot faster, because
+// every column maps to exactly 1 character and so there's nothing to measure. state.text is left unmodified.
+void ROW::FillText(RowWriteState& state)
+try
+{
+    assert(state.text.size() == 1);
+
+    // Filling the entire row is what erasing the screen boils down to (ED, EL, DECFRA, etc.).
+    // It doesn't need to preserve anything, so we can simply re-initialize the row.
+    if (state.columnBegin <= 0 && state.columnLimit >= _columnCount && !state.text.empty())
+    {
+        _charsHeap.reset();
+        _chars = { _charsBuffer, _columnCount };
+        _init();
+        if (const auto ch = til::at(state.text, 0); ch != L' ')
+        {
+            std::fill_n(_charsBuffer, _columnCount, ch);
+        }
+        _doubleBytePadded = false;
+
+        state.columnEnd = _columnCount;
+        state.columnBeginDirty = 0;
+        state.columnEndDirty = _columnCount;
+        return;
+    }
+
+    WriteHelper h{ *this, state.columnBegin, state.columnLimit, state.text };
+    if (!h.IsValid())
+    {
+        state.columnEnd = h.colBeg;
+        state.columnBeginDirty = h.colBeg;
+        state.columnEndDirty = h.colBeg;
+        return;
+    }
+    h.FillText();
+    h.Finish();
+
+    state.columnEnd = h.colEnd;
+    state.columnBeginDirty = h.colBegDirty;
+    state.columnEndDirty = h.colEndDirty;
+}
+catch (...)
+{
+    Reset(TextAttribute{});
+    throw;
+}
+
+[[msvc::forceinline]] void ROW::WriteHelper::FillText() noexcept
+{
+    const auto count = gsl::narrow_cast<uint16_t>(colLimit - colBeg);
+    // FillText() only deals with narrow characters, which don't change a trivial layout.
+    if (!row._trivialLayout)
+    {
+        iota_n(row._charOffsets.begin() + colBeg, count, chBeg);
+    }
+    colEnd = colLimit;
+    colEndDirty = colLimit;
+    charsConsumed = count;
+    fill = true;
+}
+
 void ROW::CopyTextFrom(RowCopyTextFromState& state)
 try
 {
@@ -735,7 +895,13 @@ try
     std::span<const uint16_t> charOffsets;
     std::wstring_view chars;
 
-    if (sourceColBeg < sourceColLimit)
+    if (sourceColBeg < sourceColLimit && source._trivialLayout)
+    {
+        // In a trivial layout columns and char offsets are the same.
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        chars = { source._chars.data() + sourceColBeg, static_cast<size_t>(sourceColLimit) - sourceColBeg };
+    }
+    else if (sourceColBeg < sourceColLimit)
     {
         charOffsets = source._charOffsets.subspan(sourceColBeg, static_cast<size_t>(sourceColLimit) - sourceColBeg + 1);
         const auto beg = size_t{ charOffsets.front() } & CharOffsetsMask;
@@ -755,7 +921,7 @@ try
         // Any valid charOffsets array is at least 2 elements long (the 1st element is the start offset and the 2nd
         // element is the length of the first glyph) and begins/ends with a non-trailer offset. We don't really
         // need to test for the end offset, since `WriteHelper::WriteWithOffsets` already takes care of that.
-        charOffsets.size() < 2 || WI_IsFlagSet(charOffsets.front(), CharOffsetsTrailer))
+        (!source._trivialLayout && (charOffsets.size() < 2 || WI_IsFlagSet(charOffsets.front(), CharOffsetsTrailer))))
     {
         state.columnEnd = h.colBeg;
         state.columnBeginDirty = h.colBeg;
@@ -764,7 +930,14 @@ try
         return;
     }
 
-    h.CopyTextFrom(charOffsets);
+    if (source._trivialLayout)
+    {
+        h.CopyTrivialTextFrom();
+    }
+    else
+    {
+        h.CopyTextFrom(charOffsets);
+    }
     h.Finish();
 
     // state.columnEnd is computed identical to ROW::ReplaceText. Check it out for more information.
@@ -794,6 +967,7 @@ catch (...)
     const auto baseOffset = til::at(charOffsets, 0);
     const auto endOffset = til::at(charOffsets, colEndInput);
     const auto inToOutOffset = gsl::narrow_cast<uint16_t>(chBeg - baseOffset);
+    row._initCharOffsets();
 #pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
     const auto dst = row._charOffsets.data() + colEnd;
 
@@ -804,6 +978,21 @@ catch (...)
     charsConsumed = endOffset - baseOffset;
 }
 
+// Same as CopyTextFrom(), but for a source ROW with a trivial layout,
+// where every column holds exactly 1 char of WriteHelper::chars.
+[[msvc::forceinline]] void ROW::WriteHelper::CopyTrivialTextFrom() noexcept
+{
+    const auto count = gsl::narrow_cast<uint16_t>(std::min<size_t>(colLimit - colBeg, chars.size()));
+    if (!row._trivialLayout)
+    {
+        iota_n(row._charOffsets.begin() + colBeg, count, chBeg);
+    }
+
+    colEnd += count;
+    colEndDirty = colEnd;
+    charsConsumed = count;
+}
+
 #pragma warning(push)
 #pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
 [[msvc::forceinline]] void ROW::WriteHelper::_copyOffsets(uint16_t* __restrict dst, const uint16_t* __restrict src, uint16_t size, uint16_t offset) noexcept
@@ -841,17 +1030,31 @@ catch (...)
         // std::copy_n compiles to memmove. We can do better. It also gets rid of an extra branch,
         // because std::copy_n avoids calling memmove if the count is 0. It's never 0 for us.
         const auto itBeg = row._chars.begin() + chBeg;
-        memcpy(&*itBeg, chars.data(), charsConsumed * sizeof(wchar_t));
+        if (fill)
+        {
+            std::fill_n(itBeg, charsConsumed, til::at(chars, 0));
+        }
+        else
+        {
+            memcpy(&*itBeg, chars.data(), charsConsumed * sizeof(wchar_t));
+        }
 
+        // Whitespace is narrow and doesn't change a trivial layout.
         if (leadingSpaces)
         {
             fill_n_small(row._chars.begin() + chBegDirty, leadingSpaces, L' ');
-            iota_n(row._charOffsets.begin() + colBegDirty, leadingSpaces, chBegDirty);
+            if (!row._trivialLayout)
+            {
+                iota_n(row._charOffsets.begin() + colBegDirty, leadingSpaces, chBegDirty);
+            }
         }
         if (trailingSpaces)
         {
             fill_n_small(itBeg + charsConsumed, trailingSpaces, L' ');
-            iota_n(row._charOffsets.begin() + colEnd, trailingSpaces, gsl::narrow_cast<uint16_t>(chBeg + charsConsumed));
+            if (!row._trivialLayout)
+            {
+                iota_n(row._charOffsets.begin() + colEnd, trailingSpaces, gsl::narrow_cast<uint16_t>(chBeg + charsConsumed));
+            }
         }
     }
 
@@ -875,6 +1078,9 @@ catch (...)
 // local variables in ReplaceCharacters() which I've attempted to document there.
 void ROW::_resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDirty, uint16_t chEndDirtyOld)
 {
+    // Changing the number of chars means that columns and char offsets don't line up anymore.
+    _initCharOffsets();
+
     const auto diff = chEndDirty - chEndDirtyOld;
     const auto currentLength = _charSize();
     const auto newLength = currentLength + diff;
@@ -939,22 +1145,73 @@ uint16_t ROW::size() const noexcept
     return _columnCount;
 }
 
-til::CoordType ROW::MeasureLeft() const noexcept
+#pragma warning(push)
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+
+// til::find_first_not_space(), but with an additional AVX2 path for the bulk of the text.
+// Just like the other AVX2 code in this file, it's selected at runtime, which is why it isn't part of til.
+static size_t findFirstNotSpace(const std::wstring_view& text) noexcept
 {
-    const auto text = GetText();
-    const auto beg = text.begin();
-    const auto end = text.end();
-    auto it = beg;
+#if defined(TIL_SSE_INTRINSICS)
+    if (__isa_available >= __ISA_AVAILABLE_AVX2)
+    {
+        const auto beg = text.data();
+        auto it = beg;
 
-    for (; it != end; ++it)
+        for (const auto end16 = beg + (text.size() & ~size_t{ 15 }); it < end16; it += 16)
+        {
+            const auto wch = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            const auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(wch, _mm256_set1_epi16(L' '))));
+            if (mask)
+            {
+                unsigned long offset;
+                _BitScanForward(&offset, mask);
+                return static_cast<size_t>(it - beg) + offset / 2;
+            }
+        }
+
+        const auto done = static_cast<size_t>(it - beg);
+        const auto idx = til::find_first_not_space(text.substr(done));
+        return idx == std::wstring_view::npos ? idx : done + idx;
+    }
+#endif
+    return til::find_first_not_space(text);
+}
+
+// til::find_last_not_space(), but with an additional AVX2 path. See findFirstNotSpace().
+static size_t findLastNotSpace(const std::wstring_view& text) noexcept
+{
+#if defined(TIL_SSE_INTRINSICS)
+    if (__isa_available >= __ISA_AVAILABLE_AVX2)
     {
-        if (*it != L' ')
+        const auto beg = text.data();
+        auto it = beg + text.size();
+
+        for (const auto beg16 = beg + (text.size() & 15); it > beg16; it -= 16)
         {
-            break;
+            const auto wch = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it - 16));
+            const auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(wch, _mm256_set1_epi16(L' '))));
+            if (mask)
+            {
+                unsigned long offset;
+                _BitScanReverse(&offset, mask);
+                return static_cast<size_t>(it - 16 - beg) + offset / 2;
+            }
         }
+
+        return til::find_last_not_space(text.substr(0, static_cast<size_t>(it - beg)));
     }
+#endif
+    return til::find_last_not_space(text);
+}
 
-    return gsl::narrow_cast<til::CoordType>(it - beg);
+#pragma warning(pop)
+
+til::CoordType ROW::MeasureLeft() const noexcept
+{
+    const auto text = GetText();
+    const auto idx = findFirstNotSpace(text);
+    return gsl::narrow_cast<til::CoordType>(idx == std::wstring_view::npos ? text.size() : idx);
 }
 
 til::CoordType ROW::MeasureRight() const noexcept
@@ -970,43 +1227,21 @@ til::CoordType ROW::MeasureRight() const noexcept
     }
 
     const auto text = GetText();
-    const auto beg = text.begin();
-    const auto end = text.end();
-    auto it = end;
-
-    for (; it != beg; --it)
-    {
-        // it[-1] is safe as `it` is always greater than `beg` (loop invariant).
-        if (til::at(it, -1) != L' ')
-        {
-            break;
-        }
-    }
+    const auto idx = findLastNotSpace(text);
+    // The number of characters up to and including the last non-whitespace one.
+    const auto len = idx == std::wstring_view::npos ? 0 : idx + 1;
 
     // We're supposed to return the measurement in cells and not characters
-    // and therefore simply calculating `it - beg` would be wrong.
+    // and therefore simply returning `len` would be wrong.
     //
-    // An example: The row is 10 cells wide and `it` points to the second character.
-    // `it - beg` would return 1, but it's possible it's actually 1 wide glyph and 8 whitespace.
-    return gsl::narrow_cast<til::CoordType>(_columnCount - (end - it));
+    // An example: The row is 10 cells wide and `len` is 1 (the first character).
+    // It's possible that it's actually 1 wide glyph and 8 whitespace.
+    return gsl::narrow_cast<til::CoordType>(_columnCount - (text.size() - len));
 }
 
 bool ROW::ContainsText() const noexcept
 {
-    const auto text = GetText();
-    const auto beg = text.begin();
-    const auto end = text.end();
-    auto it = beg;
-
-    for (; it != end; ++it)
-    {
-        if (*it != L' ')
-        {
-            return true;
-        }
-    }
-
-    return false;
+    return findFirstNotSpace(GetText()) != std::wstring_view::npos;
 }
 
 std::wstring_view ROW::GlyphAt(til::CoordType column) const noexcept
@@ -1047,7 +1282,7 @@ DbcsAttribute ROW::DbcsAttrAt(til::CoordType column) const noexcept
 
 std::wstring_view ROW::GetText() const noexcept
 {
-    const auto width = size_t{ til::at(_charOffsets, GetReadableColumnCount()) } & CharOffsetsMask;
+    const size_t width = _uncheckedCharOffset(gsl::narrow_cast<size_t>(GetReadableColumnCount()));
     return { _chars.data(), width };
 }
 
@@ -1113,7 +1348,7 @@ constexpr uint16_t ROW::_clampedColumnInclusive(T v) const noexcept
 uint16_t ROW::_charSize() const noexcept
 {
     // Safety: _charOffsets is an array of `_columnCount + 1` entries.
-    return _charOffsets[_columnCount];
+    return _trivialLayout ? _columnCount : _charOffsets[_columnCount];
 }
 
 // Safety: off must be [0, _charSize()].
@@ -1128,7 +1363,7 @@ template<typename T>
 uint16_t ROW::_uncheckedCharOffset(T col) const noexcept
 {
     assert(col < _charOffsets.size());
-    return _charOffsets[col] & CharOffsetsMask;
+    return _trivialLayout ? gsl::narrow_cast<uint16_t>(col) : gsl::narrow_cast<uint16_t>(_charOffsets[col] & CharOffsetsMask);
 }
 
 // Safety: col must be [0, _columnCount].
@@ -1136,7 +1371,7 @@ template<typename T>
 bool ROW::_uncheckedIsTrailer(T col) const noexcept
 {
     assert(col < _charOffsets.size());
-    return WI_IsFlagSet(_charOffsets[col], CharOffsetsTrailer);
+    return !_trivialLayout && WI_IsFlagSet(_charOffsets[col], CharOffsetsTrailer);
 }
 
 template<typename T>
@@ -1170,5 +1405,5 @@ CharToColumnMapper ROW::_createCharToColumnMapper(ptrdiff_t offset) const noexce
     // We can sort of guess what column belongs to what offset because BMP glyphs are very common and
     // UTF-16 stores them in 1 char. In other words, usually a ROW will have N chars for N columns.
     const auto guessedColumn = gsl::narrow_cast<til::CoordType>(clamp(offset, 0, _columnCount));
-    return CharToColumnMapper{ _chars.data(), _charOffsets.data(), lastChar, guessedColumn };
+    return CharToColumnMapper{ _chars.data(), _trivialLayout ? nullptr : _charOffsets.data(), lastChar, guessedColumn };
 }
@@ -67,6 +67,7 @@ struct RowCopyTextFromState
 
 // This structure is basically an inverse of ROW::_charOffsets. If you have a pointer
 // into a ROW's text this class can tell you what cell that pointer belongs to.
+// charOffsets may be null, if the ROW has a trivial layout (see ROW::_trivialLayout).
 struct CharToColumnMapper
 {
     CharToColumnMapper(const wchar_t* chars, const uint16_t* charOffsets, ptrdiff_t lastCharOffset, til::CoordType currentColumn) noexcept;
@@ -129,6 +130,8 @@ public:
     void SetLineRendition(const LineRendition lineRendition) noexcept;
     LineRendition GetLineRendition() const noexcept;
     til::CoordType GetReadableColumnCount() const noexcept;
+    void SetMutationId(uint64_t mutationId) noexcept;
+    uint64_t GetMutationId() const noexcept;
 
     void Reset(const TextAttribute& attr) noexcept;
     void TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth);
@@ -144,6 +147,7 @@ public:
     void ReplaceAttributes(til::CoordType beginIndex, til::CoordType endIndex, const TextAttribute& newAttr);
     void ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, const std::wstring_view& chars);
     void ReplaceText(RowWriteState& state);
+    void FillText(RowWriteState& state);
     void CopyTextFrom(RowCopyTextFromState& state);
 
     til::small_rle<TextAttribute, uint16_t, 1>& Attributes() noexcept;
@@ -180,7 +184,9 @@ private:
         void ReplaceCharacters(til::CoordType width) noexcept;
         void ReplaceText() noexcept;
         void _replaceTextUnicode(size_t ch, std::wstring_view::const_iterator it) noexcept;
+        void FillText() noexcept;
         void CopyTextFrom(const std::span<const uint16_t>& charOffsets) noexcept;
+        void CopyTrivialTextFrom() noexcept;
         static void _copyOffsets(uint16_t* dst, const uint16_t* src, uint16_t size, uint16_t offset) noexcept;
         void Finish();
 
@@ -215,6 +221,9 @@ private:
         uint16_t leadingSpaces;
         // The amount of characters copied from WriteHelper::chars.
         size_t charsConsumed;
+        // FillText() repeats the first character of WriteHelper::chars charsConsumed-many times,
+        // instead of copying them from WriteHelper::chars. This tells Finish() to do the same.
+        bool fill;
     };
 
     // To simplify the detection of wide glyphs, we don't just store the simple character offset as described
@@ -243,6 +252,7 @@ private:
     T _adjustForward(T column) const noexcept;
 
     void _init() noexcept;
+    void _initCharOffsets() noexcept;
     void _resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDirty, uint16_t chEndDirtyOld);
     CharToColumnMapper _createCharToColumnMapper(ptrdiff_t offset) const noexcept;
 
@@ -285,10 +295,16 @@ private:
     //
     // In other words, _charOffsets tells us both the width in chars and width in columns.
     // See CharOffsetsTrailer for more information.
+    //
+    // The contents are only valid if _trivialLayout is false.
     std::span<uint16_t> _charOffsets;
     // _attr is a run-length-encoded vector of TextAttribute with a decompressed
     // length equal to _columnCount (= 1 TextAttribute per column).
     til::small_rle<TextAttribute, uint16_t, 1> _attr;
+    // The TextBuffer::GetLastMutationId() value at the time this ROW was last handed out for mutation.
+    // It's maintained by TextBuffer and allows it to tell which rows changed since a given mutation id.
+    // ROW itself never modifies it, not even in Reset(), as that would defeat its purpose.
+    uint64_t _mutationId = 0;
     // The width of the row in visual columns.
     uint16_t _columnCount = 0;
     // Stores double-width/height (DECSWL/DECDWL/DECDHL) attributes.
@@ -297,6 +313,11 @@ private:
     bool _wrapForced = false;
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded = false;
+    // Most rows only contain narrow characters that fit into a single wchar_t each (mostly ASCII). For them the
+    // column and the char offset are identical and _charOffsets would just contain 0, 1, 2, and so on.
+    // While this is true, _charOffsets isn't written nor read and its contents are undefined. Reset() sets it to
+    // true and the first write that needs more than this calls _initCharOffsets(), which clears it again.
+    bool _trivialLayout = true;
 };
 
 #ifdef UNIT_TESTING
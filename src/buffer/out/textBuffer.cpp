@@ -13,6 +13,7 @@
 #include "../renderer/base/renderer.hpp"
 #include "../types/inc/convert.hpp"
 #include "../types/inc/utils.hpp"
+#include "../../inc/PerfCounters.hpp"
 
 using namespace Microsoft::Console;
 using namespace Microsoft::Console::Types;
@@ -54,6 +55,7 @@ TextBuffer::TextBuffer(til::size screenBufferSize,
     // This way every TextBuffer will start with a ""unique"" _lastMutationId
     // and so it'll compare unequal with the counter of other TextBuffers.
     _lastMutationId{ s_lastMutationIdInitialValue.fetch_add(0x100000000) },
+    _lastResetMutationId{ _lastMutationId },
     _cursor{ cursorSize, *this },
     _isActiveBuffer{ isActiveBuffer }
 {
@@ -155,6 +157,7 @@ void TextBuffer::_construct(const std::byte* until) noexcept
         const auto chars = reinterpret_cast<wchar_t*>(_commitWatermark + _bufferOffsetChars);
         const auto indices = reinterpret_cast<uint16_t*>(_commitWatermark + _bufferOffsetCharOffsets);
         std::construct_at(row, chars, indices, _width, _initialAttributes);
+        row->SetMutationId(_lastResetMutationId);
     }
 }
 
@@ -184,7 +187,8 @@ ROW& TextBuffer::_getRowByOffsetDirect(size_t offset)
     return *reinterpret_cast<ROW*>(row);
 }
 
-ROW& TextBuffer::_getRow(til::CoordType y) const
+// Translates a row index relative to _firstRow into an offset suitable for _getRowByOffsetDirect().
+size_t TextBuffer::_getRowOffset(til::CoordType y) const noexcept
 {
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
     auto offset = (_firstRow + y) % _height;
@@ -197,8 +201,21 @@ ROW& TextBuffer::_getRow(til::CoordType y) const
     }
 
     // We add 1 to the row offset, because row "0" is the one returned by GetScratchpadRow().
+    return gsl::narrow_cast<size_t>(offset) + 1;
+}
+
+ROW& TextBuffer::_getRow(til::CoordType y) const
+{
 #pragma warning(suppress : 26492) // Don't use const_cast to cast away const or volatile (type.3).
-    return const_cast<TextBuffer*>(this)->_getRowByOffsetDirect(gsl::narrow_cast<size_t>(offset) + 1);
+    return const_cast<TextBuffer*>(this)->_getRowByOffsetDirect(_getRowOffset(y));
+}
+
+// Same as _getRow(), but returns nullptr instead of committing the ROW if it hasn't been committed yet.
+// This allows you to inspect ROWs without unnecessarily growing the working set.
+const ROW* TextBuffer::_getRowIfCommitted(til::CoordType y) const noexcept
+{
+    const auto row = _buffer.get() + _bufferRowStride * _getRowOffset(y);
+    return row < _commitWatermark ? reinterpret_cast<const ROW*>(row) : nullptr;
 }
 
 // Returns the "user-visible" index of the last committed row, which can be used
@@ -226,7 +243,11 @@ const ROW& TextBuffer::GetRowByOffset(const til::CoordType index) const
 ROW& TextBuffer::GetMutableRowByOffset(const til::CoordType index)
 {
     _lastMutationId++;
-    return _getRow(index);
+    auto& r = _getRow(index);
+    // All write paths go through this function, which makes it the ideal
+    // place to track the last time a row was (potentially) modified.
+    r.SetMutationId(_lastMutationId);
+    return r;
 }
 
 // Returns a row filled with whitespace and the current attributes, for you to freely use.
@@ -478,6 +499,7 @@ til::point TextBuffer::NavigateCursor(til::point position, til::CoordType distan
 // You can continue calling the function on the same row as long as state.columnEnd < state.columnLimit.
 void TextBuffer::Write(til::CoordType row, const TextAttribute& attributes, RowWriteState& state)
 {
+    PERF_COUNTER_ADD(BufferRowsWritten, 1);
     auto& r = GetMutableRowByOffset(row);
     r.ReplaceText(state);
     r.ReplaceAttributes(state.columnBegin, state.columnEnd, attributes);
@@ -492,6 +514,34 @@ void TextBuffer::FillRect(const til::rect& rect, const std::wstring_view& fill,
         return;
     }
 
+    // Erasing (ED, EL, ECH, etc.) and most DECFRA calls fill with a single printable ASCII or Latin-1
+    // character. In that case every column maps to exactly 1 character and we can fill the rows directly.
+    // Other BMP characters (DECFRA allows 256..65535) may be wide, zero-width or combining marks,
+    // so they take the regular ReplaceText() path below, which measures them.
+    const auto wch = fill.front();
+    if (fill.size() == 1 && ((wch >= 0x20 && wch < 0x7f) || (wch >= 0xa0 && wch <= 0xff && wch != 0xad)))
+    {
+        RowWriteState state{
+            .text = fill,
+            .columnBegin = rect.left,
+            .columnLimit = rect.right,
+        };
+        til::CoordType dirtyBeg = rect.right;
+        til::CoordType dirtyEnd = rect.left;
+
+        for (auto y = rect.top; y < rect.bottom; ++y)
+        {
+            auto& r = GetMutableRowByOffset(y);
+            r.FillText(state);
+            r.ReplaceAttributes(rect.left, rect.right, attributes);
+            dirtyBeg = std::min(dirtyBeg, state.columnBeginDirty);
+            dirtyEnd = std::max(dirtyEnd, state.columnEndDirty);
+        }
+
+        TriggerRedraw(Viewport::FromExclusive({ dirtyBeg, rect.top, dirtyEnd, rect.bottom }));
+        return;
+    }
+
     auto& scratchpad = GetScratchpadRow(attributes);
 
     // The scratchpad row gets reset to whitespace by default, so there's no need to
@@ -539,6 +589,41 @@ void TextBuffer::FillRect(const til::rect& rect, const std::wstring_view& fill,
     }
 }
 
+// Applies the given attributes to all cells within the given spans, which are inclusive on both ends and may
+// extend over multiple rows, like the ones returned by SearchText(). This only touches the attributes of the
+// affected rows and triggers a single redraw for all of them, which makes it suitable for coloring many hits.
+void TextBuffer::ReplaceAttributes(const std::span<const til::point_span>& spans, const TextAttribute& attributes)
+{
+    const til::CoordType width = _width;
+    const til::CoordType height = _height;
+    auto top = height;
+    til::CoordType bottom = 0;
+
+    for (const auto& span : spans)
+    {
+        const auto beg = std::max(span.start.y, 0);
+        const auto end = std::min(span.end.y + 1, height);
+
+        for (auto y = beg; y < end; ++y)
+        {
+            const auto colBeg = y == span.start.y ? span.start.x : 0;
+            const auto colEnd = y == span.end.y ? span.end.x + 1 : width;
+            GetMutableRowByOffset(y).ReplaceAttributes(colBeg, colEnd, attributes);
+        }
+
+        if (beg < end)
+        {
+            top = std::min(top, beg);
+            bottom = std::max(bottom, end);
+        }
+    }
+
+    if (top < bottom)
+    {
+        TriggerRedraw(Viewport::FromExclusive({ 0, top, width, bottom }));
+    }
+}
+
 // Routine Description:
 // - Writes cells to the output buffer. Writes at the cursor.
 // Arguments:
@@ -612,6 +697,7 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
     }
 
     //  Get the row and write the cells
+    PERF_COUNTER_ADD(BufferRowsWritten, 1);
     auto& row = GetMutableRowByOffset(target.y);
     const auto newIt = row.WriteCells(givenIt, target.x, wrap, limitRight);
 
@@ -769,6 +855,8 @@ void TextBuffer::NewlineCursor()
 // - true if we successfully incremented the buffer.
 void TextBuffer::IncrementCircularBuffer(const TextAttribute& fillAttributes)
 {
+    PERF_COUNTER_ADD(BufferCircularIncrements, 1);
+
     // FirstRow is at any given point in time the array index in the circular buffer that corresponds
     // to the logical position 0 in the window (cursor coordinates and all other coordinates).
     if (_isActiveBuffer)
@@ -895,6 +983,7 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size,
     // Since the for() loop uses !=, we must ensure that size is positive.
     // A negative size doesn't make any sense anyways.
     size = std::max(0, size);
+    PERF_COUNTER_ADD(BufferRowsScrolled, size);
 
     til::CoordType y = 0;
     til::CoordType end = 0;
@@ -970,6 +1059,59 @@ uint64_t TextBuffer::GetLastMutationId() const noexcept
     return _lastMutationId;
 }
 
+// Returns the GetLastMutationId() value at the time the given row was last modified.
+// Since every modification gets a unique id, you can use it to tell whether the contents of a
+// specific ROW changed, even if it got moved around by IncrementCircularBuffer() in the meantime.
+uint64_t TextBuffer::GetRowMutationId(const til::CoordType y) const noexcept
+{
+    const auto row = _getRowIfCommitted(y);
+    return row ? row->GetMutationId() : _lastResetMutationId;
+}
+
+// Returns the indices of all rows that were modified after the given GetLastMutationId() value, in ascending order.
+// This allows consumers like the search or pattern detection to only process the rows that actually changed.
+//
+// The returned indices are relative to the current first row, just like GetRowByOffset(). Since
+// IncrementCircularBuffer() moves all rows without modifying them, callers that cache per-row
+// results by index need to account for scrolling themselves, or key their cache by GetRowMutationId().
+//
+// Mutation ids are only comparable within the same TextBuffer instance.
+std::vector<til::CoordType> TextBuffer::GetRowsModifiedSince(const uint64_t mutationId) const
+{
+    return GetRowsModifiedSince(mutationId, 0, _height);
+}
+
+// Same as GetRowsModifiedSince(mutationId), but only considers rows in the range [rowBeg, rowEnd).
+std::vector<til::CoordType> TextBuffer::GetRowsModifiedSince(const uint64_t mutationId, til::CoordType rowBeg, til::CoordType rowEnd) const
+{
+    rowBeg = std::max(0, rowBeg);
+    rowEnd = std::min<til::CoordType>(_height, rowEnd);
+
+    std::vector<til::CoordType> rows;
+    if (rowBeg >= rowEnd)
+    {
+        return rows;
+    }
+
+    // If all rows got discarded since the given mutation id, then all rows are considered modified.
+    if (mutationId < _lastResetMutationId)
+    {
+        rows.resize(gsl::narrow_cast<size_t>(rowEnd - rowBeg));
+        std::iota(rows.begin(), rows.end(), rowBeg);
+        return rows;
+    }
+
+    for (auto y = rowBeg; y < rowEnd; ++y)
+    {
+        if (GetRowMutationId(y) > mutationId)
+        {
+            rows.emplace_back(y);
+        }
+    }
+
+    return rows;
+}
+
 const TextAttribute& TextBuffer::GetCurrentAttributes() const noexcept
 {
     return _currentAttributes;
@@ -1060,6 +1202,8 @@ til::point TextBuffer::BufferToScreenPosition(const til::point position) const
 //   and the default current color attributes
 void TextBuffer::Reset() noexcept
 {
+    _lastMutationId++;
+    _lastResetMutationId = _lastMutationId;
     _decommit();
     _initialAttributes = _currentAttributes;
 }
@@ -1103,6 +1247,12 @@ void TextBuffer::ResizeTraditional(til::size newSize)
     _width = newBuffer._width;
     _height = newBuffer._height;
 
+    // The ROWs we just took over from newBuffer carry its mutation ids. Since newBuffer was created after us,
+    // its ids are guaranteed to be larger than ours. By adopting its counters we ensure that all rows are
+    // considered modified compared to any mutation id that was handed out before the resize.
+    _lastMutationId = newBuffer._lastMutationId;
+    _lastResetMutationId = newBuffer._lastResetMutationId;
+
     _SetFirstRowIndex(0);
 }
 
@@ -2395,6 +2545,8 @@ void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::w
 // - S_OK if we successfully copied the contents to the new buffer, otherwise an appropriate HRESULT.
 void TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer, const Viewport* lastCharacterViewport, PositionInformation* positionInfo)
 {
+    PERF_COUNTER_ADD(BufferReflows, 1);
+
     const auto& oldCursor = oldBuffer.GetCursor();
     auto& newCursor = newBuffer.GetCursor();
 
@@ -2607,6 +2759,8 @@ void TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer, const View
     newCursor.SetPosition(newCursorPos);
 
     newBuffer._marks = oldBuffer._marks;
+    newBuffer._markRowOffset = oldBuffer._markRowOffset;
+    newBuffer._currentPromptMark = oldBuffer._currentPromptMark;
     newBuffer._trimMarksOutsideBuffer();
 }
 
@@ -2757,9 +2911,32 @@ std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& nee
     return results;
 }
 
-const std::vector<ScrollMark>& TextBuffer::GetMarks() const noexcept
+// Returns all marks sorted by their start position, in buffer coordinates.
+ScrollMarkRange TextBuffer::GetMarks() const noexcept
 {
-    return _marks;
+    return { _marks, -_markRowOffset };
+}
+
+// Returns the mark that represents the current prompt, in buffer coordinates, if there is one.
+// Since the marks are sorted by their position, that's not necessarily the last one. Marks added
+// via AddMark() (by the UI or the user) are never considered to be the current prompt.
+std::optional<ScrollMark> TextBuffer::GetCurrentPromptMark() const
+{
+    if (!_currentPromptMark)
+    {
+        return std::nullopt;
+    }
+    return _marks[*_currentPromptMark].Shifted(-_markRowOffset);
+}
+
+bool TextBuffer::HasMarks() const noexcept
+{
+    return !_marks.empty();
+}
+
+bool TextBuffer::HasCurrentPromptMark() const noexcept
+{
+    return _currentPromptMark.has_value();
 }
 
 // Remove all marks between `start` & `end`, inclusive.
@@ -2767,115 +2944,190 @@ void TextBuffer::ClearMarksInRange(
     const til::point start,
     const til::point end)
 {
-    auto inRange = [&start, &end](const ScrollMark& m) {
-        return (m.start >= start && m.start <= end) ||
-               (m.end >= start && m.end <= end);
-    };
+    const til::point first{ start.x, start.y + _markRowOffset };
+    const til::point last{ end.x, end.y + _markRowOffset };
+
+    const auto startsBefore = [](const ScrollMark& m, const til::point& pos) { return m.start < pos; };
+    const auto startsAfter = [](const til::point& pos, const ScrollMark& m) { return pos < m.start; };
+
+    // The marks that start within the range form a contiguous block [beg, fin), since they're sorted.
+    // Marks that start after the range are assumed to end after it as well and are kept.
+    const auto beg = gsl::narrow_cast<size_t>(std::lower_bound(_marks.begin(), _marks.end(), first, startsBefore) - _marks.begin());
+    const auto fin = gsl::narrow_cast<size_t>(std::upper_bound(_marks.begin() + beg, _marks.end(), last, startsAfter) - _marks.begin());
+
+    // Marks that start before the range are removed if their prompt ends within it.
+    // Their ends aren't sorted, so we have to check them one by one.
+    size_t out = 0;
+    std::optional<size_t> currentPromptMark;
+    for (size_t in = 0; in < beg; ++in)
+    {
+        const auto& m = _marks[in];
+        if (m.end >= first && m.end <= last)
+        {
+            continue;
+        }
+        if (_currentPromptMark == in)
+        {
+            currentPromptMark = out;
+        }
+        if (out != in)
+        {
+            _marks[out] = m;
+        }
+        ++out;
+    }
+
+    if (_currentPromptMark >= fin)
+    {
+        currentPromptMark = *_currentPromptMark - (fin - out);
+    }
 
-    _marks.erase(std::remove_if(_marks.begin(),
-                                _marks.end(),
-                                inRange),
-                 _marks.end());
+    _marks.erase(_marks.begin() + out, _marks.begin() + fin);
+    _currentPromptMark = currentPromptMark;
 }
+
 void TextBuffer::ClearAllMarks() noexcept
 {
     _marks.clear();
+    _markRowOffset = 0;
+    _currentPromptMark.reset();
 }
 
 // Adjust all the marks in the y-direction by `delta`. Positive values move the
 // marks down (the positive y direction). Negative values move up. This will
-// trim marks that are no longer have a start in the bounds of the buffer
+// trim marks that are no longer have a start in the bounds of the buffer.
+// Since the marks are stored relative to _markRowOffset, this doesn't need to touch any of them.
 void TextBuffer::ScrollMarks(const int delta)
 {
-    for (auto& mark : _marks)
-    {
-        mark.start.y += delta;
-
-        // If the mark had sub-regions, then move those pointers too
-        if (mark.commandEnd.has_value())
-        {
-            (*mark.commandEnd).y += delta;
-        }
-        if (mark.outputEnd.has_value())
-        {
-            (*mark.outputEnd).y += delta;
-        }
-    }
+    _markRowOffset -= delta;
     _trimMarksOutsideBuffer();
 }
 
 // Method Description:
 // - Add a mark to our list of marks, and treat it as the active "prompt". For
 //   the sake of shell integration, we need to know which mark represents the
-//   current prompt/command/output. Internally, we'll always treat the _last_
-//   mark in the list as the current prompt.
+//   current prompt/command/output. Internally, we'll always treat the mark
+//   most recently added via this method as the current prompt.
 // Arguments:
 // - m: the mark to add.
 void TextBuffer::StartPromptMark(const ScrollMark& m)
 {
-    _marks.push_back(m);
+    _currentPromptMark = _insertMark(m);
 }
 // Method Description:
 // - Add a mark to our list of marks. Don't treat this as the active prompt.
 //   This should be used for marks created by the UI or from other user input.
-//   By inserting at the start of the list, we can separate out marks that were
-//   generated by client programs vs ones created by the user.
 // Arguments:
 // - m: the mark to add.
 void TextBuffer::AddMark(const ScrollMark& m)
 {
-    _marks.insert(_marks.begin(), m);
+    _insertMark(m);
 }
 
-void TextBuffer::_trimMarksOutsideBuffer()
+// Inserts the given mark (in buffer coordinates) into _marks, while keeping them sorted.
+// Returns the index of the new mark.
+size_t TextBuffer::_insertMark(const ScrollMark& m)
 {
-    const til::CoordType height = _height;
-    std::erase_if(_marks, [height](const auto& m) {
-        return (m.start.y < 0) || (m.start.y >= height);
+    const auto mark = m.Shifted(_markRowOffset);
+    const auto it = std::upper_bound(_marks.begin(), _marks.end(), mark.start, [](const til::point& pos, const ScrollMark& other) {
+        return pos < other.start;
     });
+    const auto idx = gsl::narrow_cast<size_t>(it - _marks.begin());
+
+    _marks.insert(it, mark);
+
+    if (_currentPromptMark >= idx)
+    {
+        ++*_currentPromptMark;
+    }
+
+    return idx;
+}
+
+void TextBuffer::_trimMarksOutsideBuffer()
+{
+    const auto top = _markRowOffset;
+    const auto bottom = _markRowOffset + _height;
+
+    while (!_marks.empty() && _marks.front().start.y < top)
+    {
+        _marks.pop_front();
+        if (_currentPromptMark == 0u)
+        {
+            _currentPromptMark.reset();
+        }
+        else if (_currentPromptMark.has_value())
+        {
+            --*_currentPromptMark;
+        }
+    }
+
+    while (!_marks.empty() && _marks.back().start.y >= bottom)
+    {
+        _marks.pop_back();
+        if (_currentPromptMark == _marks.size())
+        {
+            _currentPromptMark.reset();
+        }
+    }
+
+    // Rebase the marks every now and then, so that _markRowOffset can't overflow.
+    // It's free when there aren't any marks and otherwise only happens once every 2^30 rows.
+    if (_marks.empty())
+    {
+        _markRowOffset = 0;
+    }
+    else if (_markRowOffset < -(1 << 30) || _markRowOffset > (1 << 30))
+    {
+        for (auto& m : _marks)
+        {
+            m = m.Shifted(-_markRowOffset);
+        }
+        _markRowOffset = 0;
+    }
 }
 
 std::wstring_view TextBuffer::CurrentCommand() const
 {
-    if (_marks.size() == 0)
+    if (!_currentPromptMark)
     {
         return L"";
     }
 
-    const auto& curr{ _marks.back() };
+    const auto& curr{ _marks[*_currentPromptMark] };
     const auto& start{ curr.end };
     const auto& end{ GetCursor().GetPosition() };
 
-    const auto line = start.y;
+    const auto line = start.y - _markRowOffset;
     const auto& row = GetRowByOffset(line);
     return row.GetText(start.x, end.x);
 }
 
 void TextBuffer::SetCurrentPromptEnd(const til::point pos) noexcept
 {
-    if (_marks.empty())
+    if (!_currentPromptMark)
     {
         return;
     }
-    auto& curr{ _marks.back() };
-    curr.end = pos;
+    auto& curr{ _marks[*_currentPromptMark] };
+    curr.end = til::point{ pos.x, pos.y + _markRowOffset };
 }
 void TextBuffer::SetCurrentCommandEnd(const til::point pos) noexcept
 {
-    if (_marks.empty())
+    if (!_currentPromptMark)
     {
         return;
     }
-    auto& curr{ _marks.back() };
-    curr.commandEnd = pos;
+    auto& curr{ _marks[*_currentPromptMark] };
+    curr.commandEnd = til::point{ pos.x, pos.y + _markRowOffset };
 }
 void TextBuffer::SetCurrentOutputEnd(const til::point pos, ::MarkCategory category) noexcept
 {
-    if (_marks.empty())
+    if (!_currentPromptMark)
     {
         return;
     }
-    auto& curr{ _marks.back() };
-    curr.outputEnd = pos;
+    auto& curr{ _marks[*_currentPromptMark] };
+    curr.outputEnd = til::point{ pos.x, pos.y + _markRowOffset };
     curr.category = category;
 }
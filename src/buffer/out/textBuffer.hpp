@@ -49,6 +49,7 @@ filling in the last row, and updating the screen.
 
 #pragma once
 
+#include <deque>
 #include <vector>
 
 #include "cursor.h"
@@ -99,6 +100,109 @@ struct ScrollMark
         til::point realEnd{ til::coalesce_value(outputEnd, commandEnd, end) };
         return std::make_pair(til::point{ start }, realEnd);
     }
+    // Returns a copy of the mark with all of its coordinates moved down by `dy` rows.
+    ScrollMark Shifted(const til::CoordType dy) const
+    {
+        auto mark = *this;
+        mark.start.y += dy;
+        mark.end.y += dy;
+        if (mark.commandEnd.has_value())
+        {
+            mark.commandEnd->y += dy;
+        }
+        if (mark.outputEnd.has_value())
+        {
+            mark.outputEnd->y += dy;
+        }
+        return mark;
+    }
+};
+
+// The marks of a TextBuffer, sorted by their start position. TextBuffer stores them relative to a row
+// offset, which this view applies as they're accessed. Unlike a copy of the marks, it doesn't allocate.
+// It's only valid until the TextBuffer is modified, so it must be used under the same lock.
+class ScrollMarkRange
+{
+public:
+    class iterator
+    {
+    public:
+        // The marks are shifted as they're dereferenced, so this yields values, not references.
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ScrollMark;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = ScrollMark;
+
+        iterator() = default;
+        iterator(std::deque<ScrollMark>::const_iterator it, til::CoordType dy) noexcept :
+            _it{ it },
+            _dy{ dy }
+        {
+        }
+
+        ScrollMark operator*() const
+        {
+            return _it->Shifted(_dy);
+        }
+
+        iterator& operator++() noexcept
+        {
+            ++_it;
+            return *this;
+        }
+
+        iterator operator++(int) noexcept
+        {
+            auto copy = *this;
+            ++_it;
+            return copy;
+        }
+
+        bool operator==(const iterator& other) const noexcept
+        {
+            return _it == other._it;
+        }
+
+    private:
+        std::deque<ScrollMark>::const_iterator _it;
+        til::CoordType _dy = 0;
+    };
+
+    ScrollMarkRange(const std::deque<ScrollMark>& marks, til::CoordType dy) noexcept :
+        _marks{ &marks },
+        _dy{ dy }
+    {
+    }
+
+    iterator begin() const noexcept
+    {
+        return { _marks->begin(), _dy };
+    }
+
+    iterator end() const noexcept
+    {
+        return { _marks->end(), _dy };
+    }
+
+    size_t size() const noexcept
+    {
+        return _marks->size();
+    }
+
+    bool empty() const noexcept
+    {
+        return _marks->empty();
+    }
+
+    ScrollMark operator[](size_t index) const
+    {
+        return _marks->at(index).Shifted(_dy);
+    }
+
+private:
+    const std::deque<ScrollMark>* _marks;
+    til::CoordType _dy;
 };
 
 class TextBuffer final
@@ -143,6 +247,7 @@ public:
     // Text insertion functions
     void Write(til::CoordType row, const TextAttribute& attributes, RowWriteState& state);
     void FillRect(const til::rect& rect, const std::wstring_view& fill, const TextAttribute& attributes);
+    void ReplaceAttributes(const std::span<const til::point_span>& spans, const TextAttribute& attributes);
 
     OutputCellIterator Write(const OutputCellIterator givenIt);
 
@@ -169,6 +274,9 @@ public:
     const Cursor& GetCursor() const noexcept;
 
     uint64_t GetLastMutationId() const noexcept;
+    uint64_t GetRowMutationId(til::CoordType y) const noexcept;
+    std::vector<til::CoordType> GetRowsModifiedSince(uint64_t mutationId) const;
+    std::vector<til::CoordType> GetRowsModifiedSince(uint64_t mutationId, til::CoordType rowBeg, til::CoordType rowEnd) const;
     const til::CoordType GetFirstRowIndex() const noexcept;
 
     const Microsoft::Console::Types::Viewport GetSize() const noexcept;
@@ -267,7 +375,10 @@ public:
     std::vector<til::point_span> SearchText(const std::wstring_view& needle, bool caseInsensitive) const;
     std::vector<til::point_span> SearchText(const std::wstring_view& needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd) const;
 
-    const std::vector<ScrollMark>& GetMarks() const noexcept;
+    ScrollMarkRange GetMarks() const noexcept;
+    std::optional<ScrollMark> GetCurrentPromptMark() const;
+    bool HasMarks() const noexcept;
+    bool HasCurrentPromptMark() const noexcept;
     void ClearMarksInRange(const til::point start, const til::point end);
     void ClearAllMarks() noexcept;
     void ScrollMarks(const int delta);
@@ -285,7 +396,9 @@ private:
     void _construct(const std::byte* until) noexcept;
     void _destroy() const noexcept;
     ROW& _getRowByOffsetDirect(size_t offset);
+    size_t _getRowOffset(til::CoordType y) const noexcept;
     ROW& _getRow(til::CoordType y) const;
+    const ROW* _getRowIfCommitted(til::CoordType y) const noexcept;
     til::CoordType _estimateOffsetOfLastCommittedRow() const noexcept;
 
     void _SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept;
@@ -302,6 +415,7 @@ private:
     til::point _GetWordEndForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
     void _PruneHyperlinks();
     void _trimMarksOutsideBuffer();
+    size_t _insertMark(const ScrollMark& m);
 
     static void _AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text);
 
@@ -371,9 +485,18 @@ private:
     TextAttribute _currentAttributes;
     til::CoordType _firstRow = 0; // indexes top row (not necessarily 0)
     uint64_t _lastMutationId = 0;
+    // The value of _lastMutationId at the last time all rows were discarded at once (construction, Reset(), resize).
+    // ROWs that haven't been committed yet, or were committed after that point, implicitly have this mutation id.
+    uint64_t _lastResetMutationId = 0;
 
     Cursor _cursor;
-    std::vector<ScrollMark> _marks;
+    // Marks are sorted by their start position and their coordinates are stored relative to
+    // _markRowOffset. This way scrolling the marks only needs to adjust _markRowOffset and
+    // marks that scroll out of the buffer can be popped off the front (or back) of the deque.
+    std::deque<ScrollMark> _marks;
+    til::CoordType _markRowOffset = 0;
+    // The index of the mark in _marks that was most recently started via StartPromptMark().
+    std::optional<size_t> _currentPromptMark;
     bool _isActiveBuffer = false;
 
 #ifdef UNIT_TESTING
@@ -126,6 +126,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         auto pfnCompletionsChanged = [=](auto&& menuJson, auto&& replaceLength) { _terminalCompletionsChanged(menuJson, replaceLength); };
         _terminal->CompletionsChangedCallback(pfnCompletionsChanged);
 
+        _updateWriteBudget();
+
         // MSFT 33353327: Initialize the renderer in the ctor instead of Initialize().
         // We need the renderer to be ready to accept new engines before the SwapChainPanel is ready to go.
         // If we wait, a screen reader may try to get the AutomationPeer (aka the UIA Engine), and we won't be able to attach
@@ -143,10 +145,23 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             const auto& renderSettings = _terminal->GetRenderSettings();
             _renderer = std::make_unique<::Microsoft::Console::Render::Renderer>(renderSettings, _terminal.get(), nullptr, 0, std::move(renderThread));
 
+            // Optionally let the render thread paint without holding the terminal lock, so that it
+            // doesn't stall the connection output. In turn we need to hold LockEngines() whenever we
+            // use the _renderEngine directly, which is what the `engineLock`s below are for.
+            // It can't be turned off again once the renderer is running, so UpdateSettings() ignores it.
+            if (_settings->SnapshotPainting())
+            {
+                _renderer->EnableSnapshotPainting();
+            }
+
             _renderer->SetBackgroundColorChangedCallback([this]() { _rendererBackgroundColorChanged(); });
             _renderer->SetFrameColorChangedCallback([this]() { _rendererTabColorChanged(); });
             _renderer->SetRendererEnteredErrorStateCallback([this]() { _RendererEnteredErrorStateHandlers(nullptr, nullptr); });
 
+            // Don't repaint intermediate frames during `cat hugefile.txt` that no one can read anyway.
+            // The NotifyOutput/NotifyUserInput calls below tell it when that's the case.
+            localPointerToThread->EnableBulkOutputThrottling();
+
             THROW_IF_FAILED(localPointerToThread->Initialize(_renderer.get()));
         }
 
@@ -167,6 +182,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _dispatcher = controller.DispatcherQueue();
         }
 
+        _scheduleInputFlush = [this]() { _flushPendingInputAsync(); };
+
         // A few different events should be throttled, so they don't fire absolutely all the time:
         // * _tsfTryRedrawCanvas: When the cursor position moves, we need to
         //   inform TSF, so it can move the canvas for the composition. We
@@ -272,6 +289,12 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _connectionOutputEventRevoker.revoke();
         _connectionStateChangedRevoker.revoke();
 
+        // Input that was meant for the old connection shouldn't end up in the new one.
+        if (_connection)
+        {
+            _flushPendingInput(*_pendingInput.lock());
+        }
+
         _connection = newConnection;
         if (_connection)
         {
@@ -365,6 +388,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             const auto vp = _renderEngine->GetViewportInCharacters(viewInPixels);
             const auto width = vp.Width();
             const auto height = vp.Height();
+            _startVtRecording({ width, height });
             _connection.Resize(height, width);
 
             if (_owningHwnd != 0)
@@ -446,10 +470,61 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (_isReadOnly)
         {
             _raiseReadOnlyWarning();
+            return;
         }
-        else
+
+        if (_batchInput)
+        {
+            bool schedule;
+            {
+                auto pending = _pendingInput.lock();
+                pending->text.append(wstr);
+                schedule = !std::exchange(pending->flushQueued, true);
+            }
+            if (schedule)
+            {
+                _scheduleInputFlush();
+            }
+            return;
+        }
+
+        // Anything that isn't batched must not overtake the pending key input.
+        auto pending = _pendingInput.lock();
+        _flushPendingInput(*pending);
+        _connection.WriteInput(wstr);
+    }
+
+    void ControlCore::_flushPendingInput(PendingInput& pending)
+    {
+        if (!pending.text.empty())
         {
-            _connection.WriteInput(wstr);
+            _connection.WriteInput(pending.text);
+            pending.text.clear();
+        }
+    }
+
+    // Method Description:
+    // - Writes the input that was collected by _sendInputToConnection to the connection.
+    void ControlCore::_flushQueuedInput()
+    {
+        auto pending = _pendingInput.lock();
+        pending->flushQueued = false;
+        _flushPendingInput(*pending);
+    }
+
+    // Method Description:
+    // - The default _scheduleInputFlush. It runs _flushQueuedInput at normal priority, which lets
+    //   the window messages that are already queued up (for instance a burst of WM_KEYDOWN) add
+    //   their input first, without waiting for the dispatcher to go idle like Low priority would.
+    winrt::fire_and_forget ControlCore::_flushPendingInputAsync()
+    {
+        const auto weakThis{ get_weak() };
+
+        co_await wil::resume_foreground(_dispatcher, winrt::Windows::System::DispatcherQueuePriority::Normal);
+
+        if (auto core{ weakThis.get() })
+        {
+            core->_flushQueuedInput();
         }
     }
 
@@ -492,7 +567,13 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _handleControlC();
         }
 
+        _renderer->NotifyUserInput();
+
         const auto lock = _terminal->LockForWriting();
+        // Ctrl+C is written right away (together with anything pending), so that it
+        // interrupts the application as soon as possible.
+        _batchInput = ch != L'\x3';
+        const auto resetBatchInput = wil::scope_exit([&]() noexcept { _batchInput = false; });
         return _terminal->SendCharEvent(ch, scanCode, modifiers);
     }
 
@@ -603,7 +684,13 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                       const ControlKeyStates modifiers,
                                       const bool keyDown)
     {
+        _renderer->NotifyUserInput();
+
         const auto lock = _terminal->LockForWriting();
+        // Just like in SendCharEvent, Ctrl+C and Ctrl+Break aren't batched. In win32-input-mode they
+        // arrive here instead, because they're encoded as key events and not as a ^C character.
+        _batchInput = !(keyDown && (vkey == VK_CANCEL || (vkey == 'C' && modifiers.IsCtrlPressed())));
+        const auto resetBatchInput = wil::scope_exit([&]() noexcept { _batchInput = false; });
 
         // Update the selection, if it's present
         // GH#8522, GH#3758 - Only modify the selection on key _down_. If we
@@ -651,12 +738,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                      const short wheelDelta,
                                      const TerminalInput::MouseButtonState state)
     {
+        _renderer->NotifyUserInput();
+
         const auto lock = _terminal->LockForWriting();
         return _terminal->SendMouseEvent(viewportPos, uiButton, states, wheelDelta, state);
     }
 
     void ControlCore::UserScrollViewport(const int viewTop)
     {
+        _renderer->NotifyUserInput();
+
         {
             // This is a scroll event that wasn't initiated by the terminal
             //      itself - it was initiated by the mouse wheel, or the scrollbar.
@@ -714,6 +805,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (_renderEngine)
         {
             const auto lock = _terminal->LockForWriting();
+            const auto engineLock = _renderer->LockEngines();
             _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
             _renderer->NotifyPaintFrame();
         }
@@ -726,6 +818,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         const auto path = _settings->PixelShaderPath();
         const auto lock = _terminal->LockForWriting();
+        const auto engineLock = _renderer->LockEngines();
         // Originally, this action could be used to enable the retro effects
         // even when they're set to `false` in the settings. If the user didn't
         // specify a custom pixel shader, manually enable the legacy retro
@@ -824,6 +917,19 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return _lastHoveredCell.has_value() ? Windows::Foundation::IReference<Core::Point>{ _lastHoveredCell.value().to_core_point() } : nullptr;
     }
 
+    // Method Description:
+    // - Applies the OutputLatencyBudget and OutputSliceSize settings.
+    //   OutputLatencyBudget is the longest time (in ms) a single connection output chunk
+    //   may hold the terminal lock before briefly yielding it to the renderer and input handling.
+    //   OutputSliceSize is the number of code units parsed between checks of that budget.
+    // - The terminal lock must be held.
+    void ControlCore::_updateWriteBudget()
+    {
+        const auto latency = std::max(0, _settings->OutputLatencyBudget());
+        const auto sliceSize = std::max(1024, _settings->OutputSliceSize());
+        _terminal->SetWriteBudget({ .sliceSize = gsl::narrow_cast<size_t>(sliceSize), .latency = std::chrono::milliseconds(latency) });
+    }
+
     // Method Description:
     // - Updates the settings of the current terminal.
     // - INVARIANT: This method can only be called if the caller DOES NOT HAVE writing lock on the terminal.
@@ -845,6 +951,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         // Update the terminal core with its new Core settings
         _terminal->UpdateSettings(*_settings);
+        _updateWriteBudget();
 
         if (!_initializedTerminal.load(std::memory_order_relaxed))
         {
@@ -853,6 +960,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
+        const auto engineLock = _renderer->LockEngines();
         _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
         _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
         // Inform the renderer of our opacity
@@ -883,6 +991,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (_renderEngine)
         {
             // Update DxEngine settings under the lock
+            const auto engineLock = _renderer->LockEngines();
             _renderEngine->SetSelectionBackground(til::color{ newAppearance->SelectionBackground() });
             _renderEngine->SetRetroTerminalEffect(newAppearance->RetroTerminalEffect());
             _renderEngine->SetPixelShaderPath(newAppearance->PixelShaderPath());
@@ -975,6 +1084,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             // TODO: MSFT:20895307 If the font doesn't exist, this doesn't
             //      actually fail. We need a way to gracefully fallback.
+            const auto engineLock = _renderer->LockEngines();
             LOG_IF_FAILED(_renderEngine->UpdateDpi(newDpi));
             LOG_IF_FAILED(_renderEngine->UpdateFont(_desiredFont, _actualFont, featureMap, axesMap));
         }
@@ -1077,6 +1187,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         // Convert our new dimensions to characters
         const auto viewInPixels = Viewport::FromDimensions({ 0, 0 }, { cx, cy });
+        const auto engineLock = _renderer->LockEngines();
         const auto vp = _renderEngine->GetViewportInCharacters(viewInPixels);
 
         _terminal->ClearSelection();
@@ -1092,6 +1203,12 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         const auto hr = _terminal->UserResize({ vp.Width(), vp.Height() });
         if (SUCCEEDED(hr) && hr != S_FALSE)
         {
+            if (_vtRecorder)
+            {
+                LOG_IF_FAILED(wil::ResultFromException([&]() {
+                    _vtRecorder->RecordResize({ vp.Width(), vp.Height() });
+                }));
+            }
             _connection.Resize(vp.Height(), vp.Width());
         }
     }
@@ -1325,6 +1442,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     //   before sending it over the terminal's connection.
     void ControlCore::PasteText(const winrt::hstring& hstr)
     {
+        _renderer->NotifyUserInput();
+
         const auto lock = _terminal->LockForWriting();
         _terminal->WritePastedText(hstr);
         _terminal->ClearSelection();
@@ -1857,11 +1976,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             const auto cursorPos{ _terminal->GetCursorPosition() };
 
             // Does the current buffer line have a mark on it?
-            const auto& marks{ _terminal->GetScrollMarks() };
-            if (!marks.empty())
+            // The marks are sorted by position, so the prompt isn't necessarily the last one.
+            if (const auto prompt{ _terminal->GetCurrentPromptMark() })
             {
-                const auto& last{ marks.back() };
-                const auto [start, end] = last.GetExtent();
+                const auto [start, end] = prompt->GetExtent();
                 const auto lastNonSpace = _terminal->GetTextBuffer().GetLastNonSpaceCharacter();
 
                 // If the user clicked off to the right side of the prompt, we
@@ -1955,6 +2073,42 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         auto noticeArgs = winrt::make<NoticeEventArgs>(NoticeLevel::Info, RS_(L"TermControlReadOnly"));
         _RaiseNoticeHandlers(*this, std::move(noticeArgs));
     }
+    // Method Description:
+    // - Starts recording the connection's output into a new file in the
+    //   directory given by experimental.vtRecordingDirectory, if any.
+    //   Failing to do so only disables the recording.
+    // Arguments:
+    // - size: the initial size of the terminal in cells
+    void ControlCore::_startVtRecording(const til::size size)
+    {
+        const auto directory = _settings->VtRecordingDirectory();
+        if (directory.empty())
+        {
+            return;
+        }
+
+        try
+        {
+            static std::atomic<uint32_t> sessionCounter{ 0 };
+            const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            const auto name = fmt::format(FMT_COMPILE(L"vt-{}-{}-{}.cast"), timestamp, GetCurrentProcessId(), sessionCounter.fetch_add(1, std::memory_order_relaxed));
+            const std::filesystem::path path{ std::wstring_view{ directory } };
+
+            std::filesystem::create_directories(path);
+            _vtRecorder = std::make_unique<::Microsoft::Console::Utils::VtRecorder>(path / name, size);
+
+            // The output is recorded right before the terminal parses it, under the same lock as resizes.
+            // This way they're recorded in the order in which they're applied, even when Write()
+            // briefly releases the lock, and the recording is complete, even if parsing throws.
+            _terminal->SetOutputParsingCallback([this](std::wstring_view str) {
+                LOG_IF_FAILED(wil::ResultFromException([&]() {
+                    _vtRecorder->RecordOutput(str);
+                }));
+            });
+        }
+        CATCH_LOG();
+    }
+
     void ControlCore::_connectionOutputHandler(const hstring& hstr)
     {
         try
@@ -1964,6 +2118,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 _terminal->Write(hstr);
             }
 
+            _renderer->NotifyOutput(hstr.size());
+
             // Start the throttled update of where our hyperlinks are.
             const auto shared = _shared.lock_shared();
             if (shared->updatePatternLocations)
@@ -2182,6 +2338,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         const auto lock = _terminal->LockForWriting();
         _terminal->ApplyScheme(scheme);
+        const auto engineLock = _renderer->LockEngines();
         _renderEngine->SetSelectionBackground(til::color{ _settings->SelectionBackground() });
         _renderer->TriggerRedrawAll(true);
     }
@@ -21,6 +21,7 @@
 #include "ControlSettings.h"
 #include "../../audio/midi/MidiAudio.hpp"
 #include "../../renderer/base/Renderer.hpp"
+#include "../../types/inc/VtRecording.hpp"
 #include "../../cascadia/TerminalCore/Terminal.hpp"
 #include "../buffer/out/search.h"
 #include "../buffer/out/TextColor.h"
@@ -308,6 +309,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         std::unique_ptr<::Microsoft::Console::Render::IRenderEngine> _renderEngine{ nullptr };
         std::unique_ptr<::Microsoft::Console::Render::Renderer> _renderer{ nullptr };
 
+        // Records the connection's output if experimental.vtRecordingDirectory is set.
+        // It's created in Initialize(), before the connection is started. Protected by the terminal lock.
+        std::unique_ptr<::Microsoft::Console::Utils::VtRecorder> _vtRecorder;
+
         ::Search _searcher;
 
         winrt::handle _lastSwapChainHandle{ nullptr };
@@ -340,6 +345,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         winrt::Windows::System::DispatcherQueue _dispatcher{ nullptr };
         til::shared_mutex<SharedState> _shared;
 
+        // The input generated by key events is collected here and written to the connection
+        // once the dispatcher is done processing the current burst of window messages.
+        // This turns key repeats and injected input (like win32-input-mode sequences) into a single write.
+        struct PendingInput
+        {
+            std::wstring text;
+            bool flushQueued = false;
+        };
+        til::shared_mutex<PendingInput> _pendingInput;
+        // Protected by the terminal lock.
+        bool _batchInput{ false };
+        // Called once per batch, outside of the _pendingInput lock, to have _flushQueuedInput() run later.
+        // By default it posts to the dispatcher. The unit tests replace it to decide when the flush runs.
+        std::function<void()> _scheduleInputFlush;
+
         til::point _contextMenuBufferPosition{ 0, 0 };
 
         Windows::Foundation::Collections::IVector<int32_t> _cachedSearchResultRows{ nullptr };
@@ -354,6 +374,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         void _handleControlC();
         void _sendInputToConnection(std::wstring_view wstr);
+        void _updateWriteBudget();
+        void _flushPendingInput(PendingInput& pending);
+        void _flushQueuedInput();
+        winrt::fire_and_forget _flushPendingInputAsync();
 
 #pragma region TerminalCoreCallbacks
         void _terminalCopyToClipboard(std::wstring_view wstr);
@@ -385,6 +409,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         void _raiseReadOnlyWarning();
         void _updateAntiAliasingMode();
+        void _startVtRecording(const til::size size);
         void _connectionOutputHandler(const hstring& hstr);
         void _updateHoveredCell(const std::optional<til::point> terminalPosition);
         void _setOpacity(const double opacity, const bool focused = true);
@@ -5,6 +5,7 @@
 #include "Terminal.hpp"
 #include "../../terminal/adapter/adaptDispatch.hpp"
 #include "../../terminal/parser/OutputStateMachineEngine.hpp"
+#include "../../inc/PerfCounters.hpp"
 #include "../../inc/unicode.hpp"
 #include "../../types/inc/utils.hpp"
 #include "../../types/inc/colorTable.hpp"
@@ -12,6 +13,7 @@
 #include "../../buffer/out/UTextAdapter.h"
 
 #include <til/hash.h>
+#include <til/unicode.h>
 #include <winrt/Microsoft.Terminal.Core.h>
 
 using namespace winrt::Microsoft::Terminal::Core;
@@ -410,12 +412,20 @@ CATCH_RETURN()
 
 void Terminal::Write(std::wstring_view stringView)
 {
-    const auto& cursor = _activeBuffer().GetCursor();
-    const til::point cursorPosBefore{ cursor.GetPosition() };
+    // NOTE: Don't hold onto a reference to the cursor here. _writeSliced() may release
+    // the lock, during which the buffer can be resized and the cursor be replaced.
+    const til::point cursorPosBefore{ _activeBuffer().GetCursor().GetPosition() };
 
-    _stateMachine->ProcessString(stringView);
+    if (_writeBudget.latency > std::chrono::microseconds::zero() && stringView.size() > _writeBudget.sliceSize)
+    {
+        _writeSliced(stringView);
+    }
+    else
+    {
+        _processOutput(stringView);
+    }
 
-    const til::point cursorPosAfter{ cursor.GetPosition() };
+    const til::point cursorPosAfter{ _activeBuffer().GetCursor().GetPosition() };
 
     // Firing the CursorPositionChanged event is very expensive so we try not to
     // do that when the cursor does not need to be redrawn.
@@ -425,6 +435,58 @@ void Terminal::Write(std::wstring_view stringView)
     }
 }
 
+// Parses a large chunk of output in slices of _writeBudget.sliceSize code units and
+// whenever _writeBudget.latency has passed, briefly releases the lock so that a 4MB write
+// doesn't starve the renderer and input handling. The parser retains its state between
+// ProcessString() calls, so sequences that straddle two slices are unaffected by this.
+void Terminal::_writeSliced(std::wstring_view stringView)
+{
+    // At least 2 code units, so that we always make progress, even when
+    // we have to shorten a slice to avoid splitting a surrogate pair.
+    const auto sliceSize = std::max<size_t>(_writeBudget.sliceSize, 2);
+    auto deadline = std::chrono::steady_clock::now() + _writeBudget.latency;
+
+    while (!stringView.empty())
+    {
+        auto len = std::min(sliceSize, stringView.size());
+        // The print path would turn each half of a split surrogate pair into U+FFFD.
+        if (len < stringView.size() && til::is_leading_surrogate(til::at(stringView, len - 1)))
+        {
+            len--;
+        }
+
+        _processOutput(stringView.substr(0, len));
+        stringView = stringView.substr(len);
+
+        if (!stringView.empty() && std::chrono::steady_clock::now() >= deadline)
+        {
+            // The suspension reacquires the lock as soon as it's destroyed. Since the
+            // ticket lock is fair, threads that queued up in the meantime get to go first.
+            {
+                const auto suspension = _readWriteLock.suspend();
+            }
+            deadline = std::chrono::steady_clock::now() + _writeBudget.latency;
+        }
+    }
+}
+
+// Parses the given output. It's first given to the output parsing callback while
+// we're still holding the lock, so that it sees it in the same order as all
+// other changes, even if _writeSliced() releases the lock between slices.
+void Terminal::_processOutput(std::wstring_view stringView)
+{
+    if (_pfnOutputParsing)
+    {
+        _pfnOutputParsing(stringView);
+    }
+    _stateMachine->ProcessString(stringView);
+}
+
+void Terminal::SetWriteBudget(const WriteBudget& budget) noexcept
+{
+    _writeBudget = budget;
+}
+
 void Terminal::WritePastedText(std::wstring_view stringView)
 {
     const auto option = ::Microsoft::Console::Utils::FilterOption::CarriageReturnNewline |
@@ -776,6 +838,21 @@ void Terminal::_InvalidatePatternTree()
     });
 }
 
+// Method Description:
+// - Same as _InvalidatePatternTree, but for the given list of intervals
+// Arguments:
+// - The intervals that need to be invalidated, relative to the visible viewport
+void Terminal::_InvalidatePatternIntervals(const PointTree::interval_vector& intervals)
+{
+    const auto vis = _VisibleStartIndex();
+    for (const auto& interval : intervals)
+    {
+        const til::point startCoord{ interval.start.x, interval.start.y + vis };
+        const til::point endCoord{ interval.stop.x, interval.stop.y + vis };
+        _InvalidateFromCoords(startCoord, endCoord);
+    }
+}
+
 // Method Description:
 // - Given start and end coords, invalidates all the regions between them
 // Arguments:
@@ -950,6 +1027,7 @@ void Terminal::_assertLocked() const noexcept
 //      will release this lock when it's destructed.
 [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> Terminal::LockForReading() const noexcept
 {
+    PERF_HISTOGRAM_SCOPED_DURATION(TerminalLockWait);
 #pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'recursive_ticket_lock>()' which may throw exceptions (f.6).
 #pragma warning(suppress : 26492) // Don't use const_cast to cast away const or volatile
     return std::unique_lock{ const_cast<til::recursive_ticket_lock&>(_readWriteLock) };
@@ -962,6 +1040,7 @@ void Terminal::_assertLocked() const noexcept
 //      will release this lock when it's destructed.
 [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> Terminal::LockForWriting() noexcept
 {
+    PERF_HISTOGRAM_SCOPED_DURATION(TerminalLockWait);
 #pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'recursive_ticket_lock>()' which may throw exceptions (f.6).
     return std::unique_lock{ _readWriteLock };
 }
@@ -969,7 +1048,7 @@ void Terminal::_assertLocked() const noexcept
 // Method Description:
 // - Get a reference to the terminal's read/write lock.
 // Return Value:
-// - a ticket_lock which can be used to manually lock or unlock the terminal.
+// - a suspension, which reacquires the lock when it's destroyed.
 til::recursive_ticket_lock_suspension Terminal::SuspendLock() noexcept
 {
     return _readWriteLock.suspend();
@@ -1120,6 +1199,11 @@ void Terminal::SetWriteInputCallback(std::function<void(std::wstring_view)> pfn)
     _pfnWriteInput.swap(pfn);
 }
 
+void Terminal::SetOutputParsingCallback(std::function<void(std::wstring_view)> pfn) noexcept
+{
+    _pfnOutputParsing.swap(pfn);
+}
+
 void Terminal::SetWarningBellCallback(std::function<void()> pfn) noexcept
 {
     _pfnWarningBell.swap(pfn);
@@ -1205,9 +1289,102 @@ void Terminal::SetCursorOn(const bool isOn) noexcept
 // - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
 void Terminal::UpdatePatternsUnderLock()
 {
-    _InvalidatePatternTree();
-    _patternIntervalTree = _getPatterns(_VisibleStartIndex(), _VisibleEndIndex());
-    _InvalidatePatternTree();
+    const auto& buffer = _activeBuffer();
+    const auto beg = _VisibleStartIndex();
+    const auto end = _VisibleEndIndex();
+
+    // Every modification of a row results in a new, unique mutation id. If all visible rows still have the same
+    // mutation ids as during the last call, the visible text is identical and so are the pattern matches.
+    // This is by far the most common case, because this function is called periodically even if nothing changed.
+    std::vector<uint64_t> mutationIds;
+    mutationIds.reserve(gsl::narrow_cast<size_t>(end - beg + 1));
+    for (auto y = beg; y <= end; ++y)
+    {
+        mutationIds.emplace_back(buffer.GetRowMutationId(y));
+    }
+    if (mutationIds == _patternRowMutationIds)
+    {
+        return;
+    }
+
+    PointTree::interval_vector intervals;
+    decltype(_patternCache) cache;
+    std::wstring key;
+
+    for (auto y = beg; y <= end;)
+    {
+        // Our patterns can't match whitespace. As such, a row that ends in whitespace (or is empty)
+        // ends a segment, because no match can span from it into the next row. We can then cache the
+        // matches of each segment by its text, which is a lot cheaper to compare than it is to search.
+        key.clear();
+        auto segmentEnd = y;
+        for (;;)
+        {
+            const auto text = buffer.GetRowByOffset(segmentEnd).GetText();
+            // The length of each row is part of the key, because it affects the coordinates of the matches.
+            // It's stored as 2 code units in front of the text, which makes the key unambiguous.
+            const auto length = gsl::narrow_cast<uint32_t>(text.size());
+            key.push_back(static_cast<wchar_t>(length & 0xffff));
+            key.push_back(static_cast<wchar_t>(length >> 16));
+            key.append(text);
+            ++segmentEnd;
+
+            if (segmentEnd > end || text.empty() || text.back() <= L' ')
+            {
+                break;
+            }
+        }
+
+        auto it = cache.find(key);
+
+        if (it == cache.end())
+        {
+            auto node = _patternCache.extract(key);
+            if (node.empty())
+            {
+                it = cache.emplace(key, _getPatternIntervals(y, segmentEnd - 1)).first;
+            }
+            else
+            {
+                it = cache.insert(std::move(node)).position;
+            }
+        }
+
+        // The cached intervals are relative to the segment start, whereas
+        // _patternIntervalTree is relative to the start of the viewport.
+        const auto offset = y - beg;
+        for (auto interval : it->second)
+        {
+            interval.start.y += offset;
+            interval.stop.y += offset;
+            intervals.emplace_back(std::move(interval));
+        }
+
+        y = segmentEnd;
+    }
+
+    std::sort(intervals.begin(), intervals.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.start, a.stop, a.value) < std::tie(b.start, b.stop, b.value);
+    });
+
+    // Only invalidate the matches that appeared or disappeared. Unchanged ones don't need to be redrawn.
+    PointTree::interval_vector changed;
+    std::set_symmetric_difference(
+        _patternIntervals.begin(),
+        _patternIntervals.end(),
+        intervals.begin(),
+        intervals.end(),
+        std::back_inserter(changed),
+        [](const auto& a, const auto& b) {
+            return std::tie(a.start, a.stop, a.value) < std::tie(b.start, b.stop, b.value);
+        });
+    _InvalidatePatternIntervals(changed);
+
+    // Segments that aren't visible anymore are dropped from the cache. This keeps its size bounded by the viewport.
+    _patternCache = std::move(cache);
+    _patternIntervalTree = PointTree{ PointTree::interval_vector{ intervals } };
+    _patternIntervals = std::move(intervals);
+    _patternRowMutationIds = std::move(mutationIds);
 }
 
 // Method Description:
@@ -1220,8 +1397,20 @@ void Terminal::_clearPatternTree()
     if (!_patternIntervalTree.empty())
     {
         _InvalidatePatternTree();
-        _patternIntervalTree = {};
     }
+    _resetPatternTree();
+}
+
+// Method Description:
+// - Clears the interval pattern tree without invalidating it, for when
+//   the locations of the patterns have already been invalidated otherwise.
+// - This also ensures that the next call to UpdatePatternsUnderLock()
+//   doesn't skip the update, even if the visible rows didn't change.
+void Terminal::_resetPatternTree() noexcept
+{
+    _patternIntervalTree = {};
+    _patternIntervals.clear();
+    _patternRowMutationIds.clear();
 }
 
 // Method Description:
@@ -1345,6 +1534,7 @@ void Terminal::_updateUrlDetection()
     else
     {
         _clearPatternTree();
+        _patternCache.clear();
     }
 }
 
@@ -1417,6 +1607,13 @@ static URegularExpressionInterner uregexInterner;
 
 PointTree Terminal::_getPatterns(til::CoordType beg, til::CoordType end) const
 {
+    return PointTree{ _getPatternIntervals(beg, end) };
+}
+
+// Returns the pattern matches in the rows [beg,end] with coordinates relative to `beg`.
+PointTree::interval_vector Terminal::_getPatternIntervals(til::CoordType beg, til::CoordType end) const
+{
+    // NOTE: UpdatePatternsUnderLock() assumes that none of these patterns can match whitespace.
     static constexpr std::array<std::wstring_view, 1> patterns{
         LR"(\b(?:https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])",
     };
@@ -1444,7 +1641,7 @@ PointTree Terminal::_getPatterns(til::CoordType beg, til::CoordType end) const
         }
     }
 
-    return PointTree{ std::move(intervals) };
+    return intervals;
 }
 
 // NOTE: This is the version of AddMark that comes from the UI. The VT api call into this too.
@@ -1508,15 +1705,21 @@ void Terminal::ClearAllMarks()
     _NotifyScrollEvent();
 }
 
-const std::vector<ScrollMark>& Terminal::GetScrollMarks() const noexcept
+// The returned range refers to the buffer's marks, so it's only valid while the terminal is locked.
+ScrollMarkRange Terminal::GetScrollMarks() const noexcept
 {
     // TODO: GH#11000 - when the marks are stored per-buffer, get rid of this.
     // We want to return _no_ marks when we're in the alt buffer, to effectively
-    // hide them. We need to return a reference, so we can't just ctor an empty
-    // list here just for when we're in the alt buffer.
+    // hide them. The alt buffer never has any marks, so we don't need to
+    // special case it here.
     return _activeBuffer().GetMarks();
 }
 
+std::optional<ScrollMark> Terminal::GetCurrentPromptMark() const
+{
+    return _activeBuffer().GetCurrentPromptMark();
+}
+
 til::color Terminal::GetColorForMark(const ScrollMark& mark) const
 {
     if (mark.color.has_value())
@@ -1564,24 +1767,19 @@ std::wstring_view Terminal::CurrentCommand() const
 
 void Terminal::ColorSelection(const TextAttribute& attr, winrt::Microsoft::Terminal::Core::MatchMode matchMode)
 {
-    const auto colorSelection = [this](const til::point coordStart, const til::point coordEnd, const TextAttribute& attr) {
-        auto& textBuffer = _activeBuffer();
-        const auto spanLength = textBuffer.SpanLength(coordStart, coordEnd);
-        textBuffer.Write(OutputCellIterator(attr, spanLength), coordStart);
-    };
+    auto& textBuffer = _activeBuffer();
 
-    for (const auto [start, end] : _GetSelectionSpans())
+    for (const auto& span : _GetSelectionSpans())
     {
         try
         {
             if (matchMode == winrt::Microsoft::Terminal::Core::MatchMode::None)
             {
-                colorSelection(start, end, attr);
+                textBuffer.ReplaceAttributes({ &span, 1 }, attr);
             }
             else if (matchMode == winrt::Microsoft::Terminal::Core::MatchMode::All)
             {
-                const auto& textBuffer = _activeBuffer();
-                const auto text = textBuffer.GetPlainText(start, end);
+                const auto text = textBuffer.GetPlainText(span.start, span.end);
                 std::wstring_view textView{ text };
 
                 if (IsBlockSelection())
@@ -1592,10 +1790,7 @@ void Terminal::ColorSelection(const TextAttribute& attr, winrt::Microsoft::Termi
                 if (!textView.empty())
                 {
                     const auto hits = textBuffer.SearchText(textView, true);
-                    for (const auto& s : hits)
-                    {
-                        colorSelection(s.start, s.end, attr);
-                    }
+                    textBuffer.ReplaceAttributes(hits, attr);
                 }
             }
         }
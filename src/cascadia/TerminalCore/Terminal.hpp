@@ -98,6 +98,17 @@ public:
     // Write comes from the PTY and goes to our parser to be stored in the output buffer
     void Write(std::wstring_view stringView);
 
+    // Limits how long a single Write() may hold the lock. See SetWriteBudget().
+    struct WriteBudget
+    {
+        // Write() checks the elapsed time after every slice of this many code units.
+        size_t sliceSize = 16 * 1024;
+        // Once Write() held the lock for this long, it releases it for a moment
+        // so that the renderer and input handling can get through. 0 disables it.
+        std::chrono::microseconds latency{};
+    };
+    void SetWriteBudget(const WriteBudget& budget) noexcept;
+
     // WritePastedText comes from our input and goes back to the PTY's input channel
     void WritePastedText(std::wstring_view stringView);
 
@@ -113,7 +124,8 @@ public:
     RenderSettings& GetRenderSettings() noexcept;
     const RenderSettings& GetRenderSettings() const noexcept;
 
-    const std::vector<ScrollMark>& GetScrollMarks() const noexcept;
+    ScrollMarkRange GetScrollMarks() const noexcept;
+    std::optional<ScrollMark> GetCurrentPromptMark() const;
     void AddMark(const ScrollMark& mark,
                  const til::point& start,
                  const til::point& end,
@@ -209,6 +221,7 @@ public:
     const std::wstring GetHyperlinkUri(uint16_t id) const override;
     const std::wstring GetHyperlinkCustomId(uint16_t id) const override;
     const std::vector<size_t> GetPatternId(const til::point location) const override;
+    std::span<const interval_tree::IntervalTree<til::point, size_t>::interval> GetPatternIntervalsInRow(const til::CoordType row) const override;
 
     std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept override;
     std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override;
@@ -225,6 +238,7 @@ public:
 #pragma endregion
 
     void SetWriteInputCallback(std::function<void(std::wstring_view)> pfn) noexcept;
+    void SetOutputParsingCallback(std::function<void(std::wstring_view)> pfn) noexcept;
     void SetWarningBellCallback(std::function<void()> pfn) noexcept;
     void SetTitleChangedCallback(std::function<void(std::wstring_view)> pfn) noexcept;
     void SetCopyToClipboardCallback(std::function<void(std::wstring_view)> pfn) noexcept;
@@ -313,6 +327,7 @@ public:
 
 private:
     std::function<void(std::wstring_view)> _pfnWriteInput;
+    std::function<void(std::wstring_view)> _pfnOutputParsing;
     std::function<void()> _pfnWarningBell;
     std::function<void(std::wstring_view)> _pfnTitleChanged;
     std::function<void(std::wstring_view)> _pfnCopyToClipboard;
@@ -334,6 +349,7 @@ private:
 
     RenderSettings _renderSettings;
     std::unique_ptr<::Microsoft::Console::VirtualTerminal::StateMachine> _stateMachine;
+    WriteBudget _writeBudget;
     ::Microsoft::Console::VirtualTerminal::TerminalInput _terminalInput;
 
     std::optional<std::wstring> _title;
@@ -408,8 +424,20 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+    // UpdatePatternsUnderLock() splits the visible rows into segments that no pattern can span across and caches
+    // the matches of each segment keyed by its text. That way only the rows that changed or scrolled
+    // into view since the last call need to be searched again. The matches are stored relative to the first row
+    // of their segment. _patternIntervals is a sorted copy of the contents of _patternIntervalTree, which allows
+    // us to invalidate only the matches that actually changed and lets the renderer walk a row's matches in order
+    // (the matches of a single pattern never overlap, so neither do these intervals), and _patternRowMutationIds stores the
+    // TextBuffer::GetRowMutationId() of each visible row, which allows us to skip the update entirely.
+    std::unordered_map<std::wstring, interval_tree::IntervalTree<til::point, size_t>::interval_vector> _patternCache;
+    interval_tree::IntervalTree<til::point, size_t>::interval_vector _patternIntervals;
+    std::vector<uint64_t> _patternRowMutationIds;
     void _clearPatternTree();
+    void _resetPatternTree() noexcept;
     void _InvalidatePatternTree();
+    void _InvalidatePatternIntervals(const interval_tree::IntervalTree<til::point, size_t>::interval_vector& intervals);
     void _InvalidateFromCoords(const til::point start, const til::point end);
 
     // Since virtual keys are non-zero, you assume that this field is empty/invalid if it is.
@@ -454,10 +482,14 @@ private:
 
     void _NotifyTerminalCursorPositionChanged() noexcept;
 
+    void _writeSliced(std::wstring_view stringView);
+    void _processOutput(std::wstring_view stringView);
+
     bool _inAltBuffer() const noexcept;
     TextBuffer& _activeBuffer() const noexcept;
     void _updateUrlDetection();
     interval_tree::IntervalTree<til::point, size_t> _getPatterns(til::CoordType beg, til::CoordType end) const;
+    interval_tree::IntervalTree<til::point, size_t>::interval_vector _getPatternIntervals(til::CoordType beg, til::CoordType end) const;
 
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
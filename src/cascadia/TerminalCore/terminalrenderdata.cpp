@@ -127,6 +127,27 @@ const std::vector<size_t> Terminal::GetPatternId(const til::point location) cons
     return {};
 }
 
+// Method Description:
+// - Gets all regex pattern intervals that intersect the given row.
+// Arguments:
+// - The viewport-relative row
+// Return value:
+// - The intervals sorted by their start. The span is only valid until the next call to UpdatePatternsUnderLock().
+std::span<const interval_tree::IntervalTree<til::point, size_t>::interval> Terminal::GetPatternIntervalsInRow(const til::CoordType row) const
+{
+    _assertLocked();
+
+    // _patternIntervals is sorted and its intervals don't overlap,
+    // which means that their stops are sorted just like their starts.
+    const auto beg = std::partition_point(_patternIntervals.begin(), _patternIntervals.end(), [&](const auto& interval) {
+        return interval.stop <= til::point{ 0, row };
+    });
+    const auto end = std::partition_point(beg, _patternIntervals.end(), [&](const auto& interval) {
+        return interval.start < til::point{ 0, row + 1 };
+    });
+    return { beg, end };
+}
+
 std::pair<COLORREF, COLORREF> Terminal::GetAttributeColors(const TextAttribute& attr) const noexcept
 {
     return GetRenderSettings().GetAttributeColors(attr);
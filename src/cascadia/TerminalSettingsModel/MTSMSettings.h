@@ -98,6 +98,10 @@ Author(s):
     X(bool, AutoMarkPrompts, "experimental.autoMarkPrompts", false)                                                                                            \
     X(bool, ShowMarks, "experimental.showMarksOnScrollbar", false)                                                                                             \
     X(bool, RepositionCursorWithMouse, "experimental.repositionCursorWithMouse", false)                                                                        \
+    X(hstring, VtRecordingDirectory, "experimental.vtRecordingDirectory", L"")                                                                                 \
+    X(int32_t, OutputLatencyBudget, "experimental.output.latencyBudget", 8)                                                                                    \
+    X(int32_t, OutputSliceSize, "experimental.output.sliceSize", 16 * 1024)                                                                                    \
+    X(bool, SnapshotPainting, "experimental.rendering.snapshotPainting", false)                                                                                \
     X(bool, ReloadEnvironmentVariables, "compatibility.reloadEnvironmentVariables", true)
 
 // Intentionally omitted Profile settings:
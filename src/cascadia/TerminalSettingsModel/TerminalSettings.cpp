@@ -340,6 +340,15 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
 
         _RepositionCursorWithMouse = profile.RepositionCursorWithMouse();
 
+        if (const auto vtRecordingDirectory = profile.VtRecordingDirectory(); !vtRecordingDirectory.empty())
+        {
+            _VtRecordingDirectory = winrt::hstring{ wil::ExpandEnvironmentStringsW<std::wstring>(vtRecordingDirectory.c_str()) };
+        }
+
+        _OutputLatencyBudget = profile.OutputLatencyBudget();
+        _OutputSliceSize = profile.OutputSliceSize();
+        _SnapshotPainting = profile.SnapshotPainting();
+
         _ReloadEnvironmentVariables = profile.ReloadEnvironmentVariables();
     }
 
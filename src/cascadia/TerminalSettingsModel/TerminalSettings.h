@@ -166,6 +166,10 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         INHERITABLE_SETTING(Model::TerminalSettings, bool, ShowMarks, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, RightClickContextMenu, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, RepositionCursorWithMouse, false);
+        INHERITABLE_SETTING(Model::TerminalSettings, hstring, VtRecordingDirectory);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, OutputLatencyBudget, 8);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, OutputSliceSize, 16 * 1024);
+        INHERITABLE_SETTING(Model::TerminalSettings, bool, SnapshotPainting, false);
 
         INHERITABLE_SETTING(Model::TerminalSettings, bool, ReloadEnvironmentVariables, true);
 
@@ -43,6 +43,8 @@ namespace ControlUnitTests
 
         TEST_METHOD(TestSimpleClickSelection);
 
+        TEST_METHOD(TestKeyInputIsBatched);
+
         TEST_CLASS_SETUP(ModuleSetup)
         {
             winrt::init_apartment(winrt::apartment_type::single_threaded);
@@ -75,6 +77,8 @@ namespace ControlUnitTests
 
             auto core = winrt::make_self<Control::implementation::ControlCore>(settings, settings, conn);
             core->_inUnitTests = true;
+            // Flush batched key input right away, instead of on the dispatcher's thread.
+            core->_scheduleInputFlush = [self = core.get()]() { self->_flushQueuedInput(); };
             return core;
         }
 
@@ -565,4 +569,44 @@ namespace ControlUnitTests
         }
         VERIFY_IS_TRUE(gotSelectionUpdate);
     }
+
+    void ControlCoreTests::TestKeyInputIsBatched()
+    {
+        auto [settings, conn] = _createSettingsAndConnection();
+        Log::Comment(L"Create ControlCore object");
+        auto core = createCore(*settings, *conn);
+        VERIFY_IS_NOT_NULL(core);
+        _standardInit(core);
+
+        // Hold on to the flushes, just like the dispatcher would while it's busy with key events.
+        auto scheduledFlushes = 0;
+        core->_scheduleInputFlush = [&]() { ++scheduledFlushes; };
+
+        Log::Comment(L"Key input is collected and the flush is only scheduled once");
+        core->SendCharEvent(L'a', 0, {});
+        core->SendCharEvent(L'b', 0, {});
+        core->SendCharEvent(L'c', 0, {});
+        VERIFY_ARE_EQUAL(1, scheduledFlushes);
+        VERIFY_ARE_EQUAL(L"abc", core->_pendingInput.lock()->text);
+
+        Log::Comment(L"The scheduled flush writes all of it to the connection at once");
+        core->_flushQueuedInput();
+        VERIFY_IS_TRUE(core->_pendingInput.lock()->text.empty());
+        VERIFY_ARE_EQUAL(L"abc\r\n", core->ReadEntireBuffer());
+
+        Log::Comment(L"Input that isn't batched doesn't overtake pending key input");
+        core->SendCharEvent(L'd', 0, {});
+        VERIFY_ARE_EQUAL(2, scheduledFlushes);
+        core->SendInput(L"e");
+        VERIFY_IS_TRUE(core->_pendingInput.lock()->text.empty());
+        VERIFY_ARE_EQUAL(L"abcde\r\n", core->ReadEntireBuffer());
+
+        Log::Comment(L"Ctrl+C is written right away, together with the pending key input");
+        core->_flushQueuedInput();
+        core->SendCharEvent(L'f', 0, {});
+        core->SendCharEvent(L'\x3', 0, {});
+        VERIFY_ARE_EQUAL(3, scheduledFlushes);
+        VERIFY_IS_TRUE(core->_pendingInput.lock()->text.empty());
+        VERIFY_ARE_EQUAL(L"abcdef\r\n", core->ReadEntireBuffer());
+    }
 }
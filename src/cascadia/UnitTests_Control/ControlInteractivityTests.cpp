@@ -80,6 +80,8 @@ namespace ControlUnitTests
             VERIFY_IS_NOT_NULL(interactivity);
             auto core = interactivity->_core;
             core->_inUnitTests = true;
+            // Flush batched key input right away, instead of on the dispatcher's thread.
+            core->_scheduleInputFlush = [self = core.get()]() { self->_flushQueuedInput(); };
             VERIFY_IS_NOT_NULL(core);
 
             return { core, interactivity };
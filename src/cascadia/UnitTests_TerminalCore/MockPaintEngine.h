@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../renderer/inc/RenderEngineBase.hpp"
+
+using namespace Microsoft::Console::Render;
+
+namespace TerminalCoreUnitTests
+{
+    // A render engine that repaints the whole viewport whenever it was invalidated
+    // and remembers the text it painted. paintCost simulates the time a real
+    // engine spends in EndPaint() (shaping, drawing, etc.) on every frame.
+    class MockPaintEngine final : public RenderEngineBase
+    {
+    public:
+        size_t invalidations = 0;
+        size_t frames = 0;
+        std::chrono::microseconds paintCost{};
+        std::vector<std::wstring> rows;
+
+        HRESULT StartPaint() noexcept
+        {
+            if (!_invalid)
+            {
+                return S_FALSE;
+            }
+            _invalid = false;
+            frames++;
+            return S_OK;
+        }
+        HRESULT EndPaint() noexcept
+        {
+            const auto end = std::chrono::steady_clock::now() + paintCost;
+            while (std::chrono::steady_clock::now() < end)
+            {
+            }
+            return S_OK;
+        }
+        HRESULT Present() noexcept { return S_OK; }
+        HRESULT PrepareForTeardown(_Out_ bool* /*pForcePaint*/) noexcept { return S_OK; }
+        HRESULT ScrollFrame() noexcept { return S_OK; }
+        HRESULT Invalidate(const til::rect* /*psrRegion*/) noexcept { return _invalidate(); }
+        HRESULT InvalidateCursor(const til::rect* /*psrRegion*/) noexcept { return _invalidate(); }
+        HRESULT InvalidateSystem(const til::rect* /*prcDirtyClient*/) noexcept { return _invalidate(); }
+        HRESULT InvalidateSelection(const std::vector<til::rect>& /*rectangles*/) noexcept { return _invalidate(); }
+        HRESULT InvalidateScroll(const til::point* /*pcoordDelta*/) noexcept { return _invalidate(); }
+        HRESULT InvalidateAll() noexcept { return _invalidate(); }
+        HRESULT PaintBackground() noexcept { return S_OK; }
+        HRESULT PaintBufferLine(std::span<const Cluster> clusters, til::point coord, bool /*fTrimLeft*/, bool /*lineWrapped*/) noexcept
+        try
+        {
+            auto& row = rows.at(coord.y);
+            auto x = gsl::narrow_cast<size_t>(coord.x);
+            for (const auto& cluster : clusters)
+            {
+                const auto text = cluster.GetText();
+                row.replace(x, text.size(), text);
+                x += cluster.GetColumns();
+            }
+            return S_OK;
+        }
+        CATCH_RETURN()
+        HRESULT PaintBufferGridLines(GridLineSet /*lines*/, COLORREF /*color*/, size_t /*cchLine*/, til::point /*coordTarget*/) noexcept { return S_OK; }
+        HRESULT PaintSelection(const til::rect& /*rect*/) noexcept { return S_OK; }
+        HRESULT PaintSelections(const std::vector<til::rect>& /*rects*/) noexcept { return S_OK; }
+        HRESULT PaintCursor(const CursorOptions& /*options*/) noexcept { return S_OK; }
+        HRESULT UpdateDrawingBrushes(const TextAttribute& /*textAttributes*/, const RenderSettings& /*renderSettings*/, gsl::not_null<IRenderData*> /*pData*/, bool /*usingSoftFont*/, bool /*isSettingDefaultBrushes*/) noexcept { return S_OK; }
+        HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/) noexcept { return S_OK; }
+        HRESULT UpdateDpi(int /*iDpi*/) noexcept { return S_OK; }
+        HRESULT UpdateViewport(const til::inclusive_rect& srNewViewport) noexcept
+        try
+        {
+            _dirty = til::rect{ til::point{}, til::rect{ srNewViewport }.size() };
+            rows.assign(gsl::narrow_cast<size_t>(_dirty.height()), std::wstring(gsl::narrow_cast<size_t>(_dirty.width()), L' '));
+            return _invalidate();
+        }
+        CATCH_RETURN()
+        HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/, int /*iDpi*/) noexcept { return S_OK; }
+        HRESULT GetDirtyArea(std::span<const til::rect>& area) noexcept
+        {
+            area = { &_dirty, 1 };
+            return S_OK;
+        }
+        HRESULT GetFontSize(_Out_ til::size* /*pFontSize*/) noexcept { return S_OK; }
+        HRESULT IsGlyphWideByFont(std::wstring_view /*glyph*/, _Out_ bool* /*pResult*/) noexcept { return S_OK; }
+
+    protected:
+        HRESULT _DoUpdateTitle(const std::wstring_view /*newTitle*/) noexcept { return S_OK; }
+
+    private:
+        HRESULT _invalidate() noexcept
+        {
+            invalidations++;
+            _invalid = true;
+            return S_OK;
+        }
+
+        til::rect _dirty;
+        bool _invalid = false;
+    };
+}
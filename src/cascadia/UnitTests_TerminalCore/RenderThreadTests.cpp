@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include <WexTestClass.h>
+
+#include "../renderer/base/renderer.hpp"
+
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "MockPaintEngine.h"
+#include "consoletaeftemplates.hpp"
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace std::string_view_literals;
+using namespace TerminalCoreUnitTests;
+
+namespace
+{
+    // Unlike DummyRenderer this one comes with an actual RenderThread,
+    // which paints into the MockPaintEngine in the background.
+    struct ThreadedTerminal
+    {
+        ThreadedTerminal(const bool throttling)
+        {
+            auto thread = std::make_unique<RenderThread>();
+            auto* const localPointerToThread = thread.get();
+            if (throttling)
+            {
+                thread->EnableBulkOutputThrottling();
+            }
+
+            renderer = std::make_unique<Renderer>(term.GetRenderSettings(), &term, nullptr, 0, std::move(thread));
+            renderer->AddRenderEngine(&engine);
+            THROW_IF_FAILED(localPointerToThread->Initialize(renderer.get()));
+
+            term.Create({ 80, 32 }, 9001, *renderer);
+            renderer->EnablePainting();
+        }
+
+        // Writes the given chunk until the duration has passed, just like ControlCore's output handler.
+        // Returns the number of bytes written.
+        size_t WriteFor(const std::wstring_view chunk, const std::chrono::steady_clock::duration duration)
+        {
+            size_t bytes = 0;
+            const auto end = std::chrono::steady_clock::now() + duration;
+            while (std::chrono::steady_clock::now() < end)
+            {
+                {
+                    const auto lock = term.LockForWriting();
+                    term.Write(chunk);
+                }
+                renderer->NotifyOutput(chunk.size());
+                bytes += chunk.size() * sizeof(wchar_t);
+            }
+            return bytes;
+        }
+
+        // The engine mustn't be accessed while the render thread is painting.
+        void StopPainting()
+        {
+            renderer->WaitForPaintCompletionAndDisable(INFINITE);
+        }
+
+        Terminal term;
+        MockPaintEngine engine;
+        std::unique_ptr<Renderer> renderer;
+    };
+
+    std::wstring bulkOutputChunk()
+    {
+        std::wstring chunk;
+        for (auto i = 0; i < 128; ++i)
+        {
+            fmt::format_to(std::back_inserter(chunk), L"\x1b[3{}m{:075}\x1b[m\r\n", i % 8, i);
+        }
+        return chunk;
+    }
+}
+
+namespace TerminalCoreUnitTests
+{
+    class RenderThreadTests final
+    {
+        TEST_CLASS(RenderThreadTests);
+
+        TEST_METHOD(BulkOutputSkipsFramesButPaintsFinalState);
+        TEST_METHOD(ThrottlingOnlyAppliesToBulkOutput);
+        TEST_METHOD(BulkOutputThroughput);
+    };
+}
+
+void RenderThreadTests::BulkOutputSkipsFramesButPaintsFinalState()
+{
+    ThreadedTerminal t{ true };
+    const auto chunk = bulkOutputChunk();
+
+    t.WriteFor(chunk, std::chrono::milliseconds(500));
+    {
+        const auto lock = t.term.LockForWriting();
+        t.term.Write(L"done");
+    }
+    t.renderer->NotifyOutput(4);
+
+    // Once the output came to a rest, the final state must be painted without waiting for more output.
+    Sleep(250);
+    t.StopPainting();
+
+    const auto metrics = t.renderer->GetMetrics();
+    Log::Comment(NoThrowString().Format(L"painted: %llu, skipped: %llu", metrics.framesPainted, metrics.framesSkipped));
+    VERIFY_IS_GREATER_THAN(metrics.framesSkipped, 0ull);
+    VERIFY_IS_GREATER_THAN(metrics.outputCodeUnits, 0ull);
+    VERIFY_ARE_EQUAL(L"done"sv, std::wstring_view{ t.engine.rows.back() }.substr(0, 4));
+}
+
+void RenderThreadTests::ThrottlingOnlyAppliesToBulkOutput()
+{
+    ThreadedTerminal t{ true };
+
+    // A line every 50ms is something you can still read. It shouldn't be throttled.
+    for (auto i = 0; i < 10; ++i)
+    {
+        const auto line = fmt::format(L"line {}\r\n", i);
+        {
+            const auto lock = t.term.LockForWriting();
+            t.term.Write(line);
+        }
+        t.renderer->NotifyOutput(line.size());
+        Sleep(50);
+    }
+
+    t.StopPainting();
+
+    const auto metrics = t.renderer->GetMetrics();
+    VERIFY_ARE_EQUAL(0ull, metrics.framesSkipped);
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(metrics.framesPainted, 10ull);
+}
+
+void RenderThreadTests::BulkOutputThroughput()
+{
+    // Streams output for a while with and without bulk output throttling
+    // and reports the frame counts as well as the parse throughput.
+
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const auto chunk = bulkOutputChunk();
+
+    for (const auto throttling : { false, true })
+    {
+        using namespace std::chrono;
+
+        ThreadedTerminal t{ throttling };
+        t.engine.paintCost = 2ms;
+
+        const auto beg = steady_clock::now();
+        const auto bytes = t.WriteFor(chunk, 1s);
+        const auto seconds = duration<double>(steady_clock::now() - beg).count();
+        t.StopPainting();
+
+        const auto metrics = t.renderer->GetMetrics();
+        Log::Comment(NoThrowString().Format(
+            L"%s: %llu frames painted, %llu frames skipped, %llu lines scrolled, %.1f MB/s",
+            throttling ? L"Throttled" : L"Unthrottled",
+            metrics.framesPainted,
+            metrics.framesSkipped,
+            metrics.scrolledLines,
+            bytes / seconds / 1024 / 1024));
+    }
+}
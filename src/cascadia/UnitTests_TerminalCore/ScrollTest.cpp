@@ -105,6 +105,9 @@ class TerminalCoreUnitTests::ScrollTest final
     TEST_CLASS(ScrollTest);
 
     TEST_METHOD(TestNotifyScrolling);
+    TEST_METHOD(TestIncrementalPatternDetection);
+    TEST_METHOD(TestPatternIntervalsInRow);
+    TEST_METHOD(PatternDetectionScrollPerformance);
 
     TEST_METHOD_SETUP(MethodSetup)
     {
@@ -133,6 +136,9 @@ class TerminalCoreUnitTests::ScrollTest final
     }
 
 private:
+    void _writeLinesWithUrls(const til::CoordType count);
+    void _verifyPatternsMatchFullScan();
+
     std::unique_ptr<Terminal> _term;
     std::unique_ptr<MockScrollRenderEngine> _renderEngine;
     std::unique_ptr<DummyRenderer> _renderer;
@@ -245,3 +251,175 @@ void ScrollTest::TestNotifyScrolling()
         }
     }
 }
+
+// Writes `count` lines that contain URLs in various positions,
+// including some that are wrapped across two rows.
+void ScrollTest::_writeLinesWithUrls(const til::CoordType count)
+{
+    auto& termSm = *_term->_stateMachine;
+
+    for (til::CoordType i = 0; i < count; ++i)
+    {
+        std::wstring line;
+        switch (i % 4)
+        {
+        case 0:
+            line = fmt::format(FMT_COMPILE(L"line {} https://example.com/{}"), i, i);
+            break;
+        case 1:
+            line = fmt::format(FMT_COMPILE(L"no url on line {}"), i);
+            break;
+        case 2:
+            // This URL begins close to the right edge and wraps onto the next row.
+            line = fmt::format(FMT_COMPILE(L"{:>70} http://example.com/wrapped/{}"), i, i);
+            break;
+        default:
+            line = fmt::format(FMT_COMPILE(L"ftp://a.example/{} and file://b.example/{}"), i, i);
+            break;
+        }
+        line.append(L"\r\n");
+        termSm.ProcessString(line);
+    }
+}
+
+// Verifies that the incrementally maintained pattern tree is identical to a full rescan of the viewport.
+void ScrollTest::_verifyPatternsMatchFullScan()
+{
+    _term->UpdatePatternsUnderLock();
+
+    auto expected = _term->_getPatternIntervals(_term->_VisibleStartIndex(), _term->_VisibleEndIndex());
+    std::sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.start, a.stop) < std::tie(b.start, b.stop);
+    });
+
+    const auto& actual = _term->_patternIntervals;
+    VERIFY_ARE_EQUAL(expected.size(), actual.size());
+    for (size_t i = 0; i < std::min(expected.size(), actual.size()); ++i)
+    {
+        VERIFY_ARE_EQUAL(expected[i].start, actual[i].start);
+        VERIFY_ARE_EQUAL(expected[i].stop, actual[i].stop);
+    }
+}
+
+void ScrollTest::TestIncrementalPatternDetection()
+{
+    auto lock = _term->LockForWriting();
+    auto& termSm = *_term->_stateMachine;
+
+    WEX::TestExecution::SetVerifyOutput settings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+
+    Log::Comment(L"Patterns should be found as text gets written and scrolls into the viewport.");
+    for (auto i = 0; i < 20; ++i)
+    {
+        _writeLinesWithUrls(5);
+        _verifyPatternsMatchFullScan();
+    }
+
+    Log::Comment(L"Overwriting a URL should remove it, without affecting the other ones.");
+    termSm.ProcessString(L"\x1b[5;1H\x1b[2K\x1b[10;1Hhttps://example.com/new");
+    _verifyPatternsMatchFullScan();
+
+    Log::Comment(L"Calling it again without any changes should keep the existing results.");
+    const auto cachedSegments = _term->_patternCache.size();
+    _verifyPatternsMatchFullScan();
+    VERIFY_ARE_EQUAL(cachedSegments, _term->_patternCache.size());
+
+    Log::Comment(L"Scrolling the viewport up and down should produce identical results to a full scan.");
+    const auto top = _term->GetScrollOffset();
+    for (auto delta = 1; delta <= 30; delta += 7)
+    {
+        _term->UserScrollViewport(top - delta);
+        _verifyPatternsMatchFullScan();
+    }
+    _term->UserScrollViewport(top);
+    _verifyPatternsMatchFullScan();
+}
+
+void ScrollTest::TestPatternIntervalsInRow()
+{
+    auto lock = _term->LockForWriting();
+
+    WEX::TestExecution::SetVerifyOutput settings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+
+    _writeLinesWithUrls(50);
+    _term->UpdatePatternsUnderLock();
+
+    Log::Comment(L"The intervals of each row should agree with the pattern ids of each of its cells.");
+    for (til::CoordType y = 0; y < TerminalViewHeight; ++y)
+    {
+        const auto intervals = _term->GetPatternIntervalsInRow(y);
+
+        for (size_t i = 0; i < intervals.size(); ++i)
+        {
+            // Each interval must intersect the row and they must be sorted.
+            VERIFY_IS_LESS_THAN(intervals[i].start, (til::point{ 0, y + 1 }));
+            VERIFY_IS_GREATER_THAN(intervals[i].stop, (til::point{ 0, y }));
+            if (i != 0)
+            {
+                VERIFY_IS_LESS_THAN_OR_EQUAL(intervals[i - 1].stop, intervals[i].start);
+            }
+        }
+
+        for (til::CoordType x = 0; x < TerminalViewWidth; ++x)
+        {
+            const til::point pos{ x, y };
+            const auto inInterval = std::any_of(intervals.begin(), intervals.end(), [&](const auto& interval) {
+                return interval.start <= pos && pos < interval.stop;
+            });
+            VERIFY_ARE_EQUAL(!_term->GetPatternId(pos).empty(), inInterval);
+        }
+    }
+}
+
+void ScrollTest::PatternDetectionScrollPerformance()
+{
+    // Measures how long UpdatePatternsUnderLock() holds the terminal lock while the user scrolls through a buffer
+    // full of URLs one row at a time, compared to a full rescan of the viewport (which is what it used to do).
+
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    auto lock = _term->LockForWriting();
+
+    _writeLinesWithUrls(TerminalHistoryLength);
+
+    const auto measure = [&](auto&& func) {
+        using namespace std::chrono;
+
+        const auto top = _term->GetScrollOffset();
+        nanoseconds total{};
+        nanoseconds maximum{};
+
+        for (auto y = top; y >= 0; --y)
+        {
+            _term->UserScrollViewport(y);
+
+            const auto beg = steady_clock::now();
+            func();
+            const auto elapsed = steady_clock::now() - beg;
+
+            total += elapsed;
+            maximum = std::max<nanoseconds>(maximum, elapsed);
+        }
+
+        _term->UserScrollViewport(top);
+
+        const auto count = top + 1;
+        return std::tuple{ count, duration_cast<microseconds>(total).count(), duration_cast<microseconds>(total / count).count(), duration_cast<microseconds>(maximum).count() };
+    };
+
+    {
+        const auto [count, total, avg, maximum] = measure([&]() {
+            _term->_patternIntervalTree = _term->_getPatterns(_term->_VisibleStartIndex(), _term->_VisibleEndIndex());
+        });
+        Log::Comment(NoThrowString().Format(L"Full rescan: %d updates took %lld us. Avg %lld us, max %lld us per update", count, total, avg, maximum));
+    }
+
+    {
+        const auto [count, total, avg, maximum] = measure([&]() {
+            _term->UpdatePatternsUnderLock();
+        });
+        Log::Comment(NoThrowString().Format(L"Incremental: %d updates took %lld us. Avg %lld us, max %lld us per update", count, total, avg, maximum));
+    }
+}
@@ -0,0 +1,252 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include <WexTestClass.h>
+
+#include "../renderer/inc/DummyRenderer.hpp"
+
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "MockPaintEngine.h"
+#include "consoletaeftemplates.hpp"
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+using namespace ::Microsoft::Console::Types;
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace std::string_view_literals;
+using namespace TerminalCoreUnitTests;
+
+namespace
+{
+    struct TestTerminal
+    {
+        TestTerminal(const bool snapshotPainting)
+        {
+            renderer.AddRenderEngine(&engine);
+            if (snapshotPainting)
+            {
+                renderer.EnableSnapshotPainting();
+            }
+            term.Create({ 80, 32 }, 9001, renderer);
+            renderer.EnablePainting();
+        }
+
+        Terminal term;
+        DummyRenderer renderer{ &term };
+        MockPaintEngine engine;
+    };
+}
+
+namespace TerminalCoreUnitTests
+{
+    class SnapshotPaintingTests final
+    {
+        TEST_CLASS(SnapshotPaintingTests);
+
+        TEST_METHOD(InvalidationsAreAppliedOnTheNextFrame);
+        TEST_METHOD(SnapshotPaintsCurrentText);
+        TEST_METHOD(FrameTemporariesReachSteadyState);
+        TEST_METHOD(ResizeAndSelectionRaceWithPainting);
+        TEST_METHOD(ConcurrentOutputAndPaintingPerformance);
+    };
+}
+
+void SnapshotPaintingTests::InvalidationsAreAppliedOnTheNextFrame()
+{
+    TestTerminal t{ true };
+    VERIFY_SUCCEEDED(t.renderer.PaintFrame());
+
+    const auto invalidations = t.engine.invalidations;
+    {
+        const auto lock = t.term.LockForWriting();
+        t.term.Write(L"Hello\r\nWorld");
+    }
+
+    Log::Comment(L"The engine mustn't be touched while the render thread might be painting without the terminal lock.");
+    VERIFY_ARE_EQUAL(invalidations, t.engine.invalidations);
+
+    VERIFY_SUCCEEDED(t.renderer.PaintFrame());
+    VERIFY_IS_GREATER_THAN(t.engine.invalidations, invalidations);
+}
+
+void SnapshotPaintingTests::SnapshotPaintsCurrentText()
+{
+    TestTerminal direct{ false };
+    TestTerminal snapshot{ true };
+
+    for (auto t : { &direct, &snapshot })
+    {
+        const auto lock = t->term.LockForWriting();
+        // Enough lines to scroll the viewport, some of which are colored.
+        for (auto i = 0; i < 50; ++i)
+        {
+            t->term.Write(fmt::format(L"\x1b[3{}mline {}\x1b[m\r\n", i % 8, i));
+        }
+        t->term.Write(L"last");
+    }
+
+    VERIFY_SUCCEEDED(direct.renderer.PaintFrame());
+    VERIFY_SUCCEEDED(snapshot.renderer.PaintFrame());
+
+    VERIFY_ARE_EQUAL(direct.engine.rows.size(), snapshot.engine.rows.size());
+    for (size_t y = 0; y < direct.engine.rows.size(); ++y)
+    {
+        VERIFY_ARE_EQUAL(std::wstring_view{ direct.engine.rows[y] }, std::wstring_view{ snapshot.engine.rows[y] });
+    }
+    VERIFY_ARE_EQUAL(L"last"sv, std::wstring_view{ snapshot.engine.rows.back() }.substr(0, 4));
+}
+
+void SnapshotPaintingTests::FrameTemporariesReachSteadyState()
+{
+    for (const auto snapshotPainting : { false, true })
+    {
+        TestTerminal t{ snapshotPainting };
+        {
+            const auto lock = t.term.LockForWriting();
+            t.term.SelectNewRegion({ 2, 0 }, { 10, 5 });
+        }
+
+        for (auto frame = 0; frame < 8; ++frame)
+        {
+            {
+                const auto lock = t.term.LockForWriting();
+                t.term.Write(fmt::format(L"\x1b[3{}mframe {}\x1b[m\r\n", frame % 8, frame));
+            }
+            VERIFY_SUCCEEDED(t.renderer.PaintFrame());
+
+            // The first frame allocates the arena's initial block and the second one at most a single,
+            // larger block that replaces all the others. Every frame after that reuses the same memory.
+            if (frame == 0)
+            {
+                VERIFY_IS_GREATER_THAN(t.renderer.GetFrameArenaAllocations(), 0u);
+            }
+            else if (frame >= 2)
+            {
+                VERIFY_ARE_EQUAL(0u, t.renderer.GetFrameArenaAllocations());
+            }
+        }
+
+        VERIFY_ARE_EQUAL(8u, t.engine.frames);
+    }
+}
+
+void SnapshotPaintingTests::ResizeAndSelectionRaceWithPainting()
+{
+    // Resizes the terminal and changes the selection under the terminal lock, while another thread
+    // keeps painting frames from snapshots without it, just like the render thread does.
+    // Every frame must succeed and once the terminal is idle, the next frame must show the same
+    // text as one that was painted under the lock.
+    TestTerminal direct{ false };
+    TestTerminal snapshot{ true };
+
+    std::atomic<bool> stop{ false };
+    std::atomic<size_t> failedFrames{ 0 };
+    std::thread painter{ [&]() {
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            if (FAILED(snapshot.renderer.PaintFrame()))
+            {
+                failedFrames.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    } };
+
+    const auto mutate = [](TestTerminal& t, const int i) {
+        const auto lock = t.term.LockForWriting();
+        LOG_IF_FAILED(t.term.UserResize({ 40 + i % 5 * 10, 10 + i % 3 * 11 }));
+        t.renderer.TriggerRedrawAll();
+        if (i % 4 == 3)
+        {
+            t.term.ClearSelection();
+        }
+        else
+        {
+            t.term.SelectNewRegion({ i % 7, 0 }, { 20, i % 9 });
+        }
+        t.term.Write(fmt::format(L"\x1b[3{}mline {}\x1b[m\r\n", i % 8, i));
+    };
+
+    for (auto i = 0; i < 500; ++i)
+    {
+        mutate(direct, i);
+        mutate(snapshot, i);
+        std::this_thread::yield();
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    painter.join();
+
+    VERIFY_ARE_EQUAL(0u, failedFrames.load());
+    VERIFY_IS_GREATER_THAN(snapshot.engine.frames, 0u);
+
+    VERIFY_SUCCEEDED(direct.renderer.PaintFrame());
+    VERIFY_SUCCEEDED(snapshot.renderer.PaintFrame());
+
+    VERIFY_ARE_EQUAL(direct.engine.rows.size(), snapshot.engine.rows.size());
+    for (size_t y = 0; y < direct.engine.rows.size(); ++y)
+    {
+        VERIFY_ARE_EQUAL(std::wstring_view{ direct.engine.rows[y] }, std::wstring_view{ snapshot.engine.rows[y] });
+    }
+}
+
+void SnapshotPaintingTests::ConcurrentOutputAndPaintingPerformance()
+{
+    // Writes output on one thread while painting frames on another, just like ControlCore
+    // and the render thread do, and reports how many frames and bytes made it through.
+
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    std::wstring chunk;
+    for (auto i = 0; i < 512; ++i)
+    {
+        fmt::format_to(std::back_inserter(chunk), L"\x1b[3{}m{:075}\x1b[m\r\n", i % 8, i);
+    }
+
+    const auto measure = [&](const bool snapshotPainting) {
+        using namespace std::chrono;
+
+        TestTerminal t{ snapshotPainting };
+        t.engine.paintCost = 2ms;
+
+        std::atomic<bool> stop{ false };
+        size_t bytes = 0;
+
+        std::thread writer{ [&]() {
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                const auto lock = t.term.LockForWriting();
+                t.term.Write(chunk);
+                bytes += chunk.size() * sizeof(wchar_t);
+            }
+        } };
+
+        const auto beg = steady_clock::now();
+        const auto end = beg + 1s;
+        while (steady_clock::now() < end)
+        {
+            LOG_IF_FAILED(t.renderer.PaintFrame());
+        }
+
+        stop.store(true, std::memory_order_relaxed);
+        writer.join();
+
+        const auto seconds = duration<double>(steady_clock::now() - beg).count();
+        return std::pair{ t.engine.frames / seconds, bytes / seconds / 1024 / 1024 };
+    };
+
+    {
+        const auto [fps, mbps] = measure(false);
+        Log::Comment(NoThrowString().Format(L"Painting under the lock: %.1f frames/s, %.1f MB/s", fps, mbps));
+    }
+
+    {
+        const auto [fps, mbps] = measure(true);
+        Log::Comment(NoThrowString().Format(L"Painting from snapshots: %.1f frames/s, %.1f MB/s", fps, mbps));
+    }
+}
@@ -12,6 +12,7 @@
 using namespace winrt::Microsoft::Terminal::Core;
 using namespace Microsoft::Terminal::Core;
 
+using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
 
@@ -41,6 +42,9 @@ namespace TerminalCoreUnitTests
 
         TEST_METHOD(SetTaskbarProgress);
         TEST_METHOD(SetWorkingDirectory);
+
+        TEST_METHOD(SlicedWritePreservesSequences);
+        TEST_METHOD(LockForWritingIsNotStarvedByOutput);
     };
 };
 
@@ -476,3 +480,113 @@ void TerminalCoreUnitTests::TerminalApiTest::SetWorkingDirectory()
     stateMachine.ProcessString(L"\x1b]9;9;D:\\中文\x1b\\");
     VERIFY_ARE_EQUAL(term.GetWorkingDirectory(), L"D:\\中文");
 }
+
+void TerminalApiTest::SlicedWritePreservesSequences()
+{
+    // Terminal::Write() parses large writes in slices and releases the lock in between.
+    // Sequences and surrogate pairs that straddle two slices must come out the same.
+    std::wstring text;
+    for (auto i = 0; i < 8; ++i)
+    {
+        text.append(L"\x1b]0;title\x07");
+        text.append(L"\x1b[38;2;12;34;56;1mbold\x1b[m 𐐌𐐜𐐬 ");
+        text.append(L"\x1b]8;;https://example.com\x1b\\link\x1b]8;;\x1b\\");
+        text.append(L"\x1b[5Gx\x1b[4m\u00e9\u0301\x1b[24m\r\n");
+    }
+
+    struct Output
+    {
+        Terminal term;
+        DummyRenderer renderer{ &term };
+    };
+
+    const auto write = [&](Output& output, const size_t sliceSize) {
+        output.term.Create({ 40, 20 }, 0, output.renderer);
+        if (sliceSize)
+        {
+            // A budget of 1us makes Write() yield after pretty much every slice.
+            output.term.SetWriteBudget({ .sliceSize = sliceSize, .latency = std::chrono::microseconds{ 1 } });
+        }
+
+        const auto lock = output.term.LockForWriting();
+        output.term.Write(text);
+    };
+
+    Output expected;
+    write(expected, 0);
+    const auto& expectedBuffer = *expected.term._mainBuffer;
+
+    for (size_t sliceSize = 1; sliceSize < 20; ++sliceSize)
+    {
+        Log::Comment(NoThrowString().Format(L"slice size: %zu", sliceSize));
+
+        Output actual;
+        write(actual, sliceSize);
+        const auto& actualBuffer = *actual.term._mainBuffer;
+
+        VERIFY_ARE_EQUAL(expected.term.GetConsoleTitle(), actual.term.GetConsoleTitle());
+        VERIFY_ARE_EQUAL(expectedBuffer.GetCursor().GetPosition(), actualBuffer.GetCursor().GetPosition());
+
+        for (til::CoordType y = 0; y < 20; ++y)
+        {
+            const auto& expectedRow = expectedBuffer.GetRowByOffset(y);
+            const auto& actualRow = actualBuffer.GetRowByOffset(y);
+            VERIFY_ARE_EQUAL(expectedRow.GetText(), actualRow.GetText());
+
+            for (til::CoordType x = 0; x < 40; ++x)
+            {
+                VERIFY_IS_TRUE(expectedRow.GetAttrByColumn(x) == actualRow.GetAttrByColumn(x));
+            }
+        }
+    }
+
+    void TerminalApiTest::LockForWritingIsNotStarvedByOutput()
+    {
+        // A parser thread keeps writing large chunks of output, like ControlCore does during `cat hugefile.txt`,
+        // while the UI thread calls LockForWriting() every couple of milliseconds, like it does for key events.
+        // Write() releases the lock whenever the latency budget has passed and the lock is fair,
+        // so the UI thread must get the lock within a few budgets and not only once a chunk is done.
+        Terminal term;
+        DummyRenderer renderer{ &term };
+        term.Create({ 80, 32 }, 9001, renderer);
+        term.SetWriteBudget({ .sliceSize = 1024, .latency = std::chrono::milliseconds{ 2 } });
+
+        // About 4M characters. Parsing them takes far longer than the bound below, so without the
+        // latency budget the UI thread would have to wait for most of a chunk.
+        std::wstring chunk;
+        for (auto i = 0; i < 50000; ++i)
+        {
+            fmt::format_to(std::back_inserter(chunk), L"\x1b[3{}m{:075}\x1b[m\r\n", i % 8, i);
+        }
+
+        std::atomic<bool> done{ false };
+        std::atomic<size_t> chunks{ 0 };
+        std::thread parser{ [&]() {
+            while (!done.load(std::memory_order_relaxed))
+            {
+                const auto lock = term.LockForWriting();
+                term.Write(chunk);
+                chunks.fetch_add(1, std::memory_order_relaxed);
+            }
+        } };
+
+        std::chrono::steady_clock::duration maxWait{};
+        for (auto i = 0; i < 50; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+            const auto beg = std::chrono::steady_clock::now();
+            {
+                const auto lock = term.LockForWriting();
+                maxWait = std::max(maxWait, std::chrono::steady_clock::now() - beg);
+            }
+        }
+
+        const auto chunksDuringTest = chunks.load(std::memory_order_relaxed);
+        done.store(true, std::memory_order_relaxed);
+        parser.join();
+
+        const auto maxWaitUs = std::chrono::duration_cast<std::chrono::microseconds>(maxWait).count();
+        Log::Comment(NoThrowString().Format(L"max wait: %lld us, chunks parsed: %zu", maxWaitUs, chunksDuringTest));
+        VERIFY_IS_LESS_THAN(maxWaitUs, 50000ll);
+    }
+}
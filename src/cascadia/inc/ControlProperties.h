@@ -75,4 +75,8 @@
     X(bool, UseAtlasEngine, false)                                                                                                                       \
     X(bool, UseBackgroundImageForWindow, false)                                                                                                          \
     X(bool, ShowMarks, false)                                                                                                                            \
-    X(bool, RightClickContextMenu, false)
+    X(bool, RightClickContextMenu, false)                                                                                                                \
+    X(winrt::hstring, VtRecordingDirectory)                                                                                                              \
+    X(int32_t, OutputLatencyBudget, 8)                                                                                                                   \
+    X(int32_t, OutputSliceSize, 16 * 1024)                                                                                                               \
+    X(bool, SnapshotPainting, false)
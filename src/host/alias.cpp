@@ -21,7 +21,9 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 
 struct case_insensitive_hash
 {
-    std::size_t operator()(const std::wstring& key) const
+    using is_transparent = void;
+
+    std::size_t operator()(const std::wstring_view& key) const
     {
         til::hasher h;
         for (const auto& ch : key)
@@ -34,15 +36,17 @@ struct case_insensitive_hash
 
 struct case_insensitive_equality
 {
-    bool operator()(const std::wstring& lhs, const std::wstring& rhs) const
+    using is_transparent = void;
+
+    bool operator()(const std::wstring_view& lhs, const std::wstring_view& rhs) const
     {
-        return 0 == _wcsicmp(lhs.data(), rhs.data());
+        return lhs.size() == rhs.size() && 0 == _wcsnicmp(lhs.data(), rhs.data(), lhs.size());
     }
 };
 
 std::unordered_map<std::wstring,
                    std::unordered_map<std::wstring,
-                                      std::wstring,
+                                      Alias::Target,
                                       case_insensitive_hash,
                                       case_insensitive_equality>,
                    case_insensitive_hash,
@@ -114,7 +118,7 @@ std::unordered_map<std::wstring,
         else
         {
             // Map will auto-create each level as necessary
-            g_aliasData[exeNameString][sourceString] = targetString;
+            g_aliasData[exeNameString][sourceString] = Alias::s_CompileTarget(std::move(targetString));
         }
     }
     CATCH_RETURN();
@@ -156,10 +160,10 @@ std::unordered_map<std::wstring,
     // We use .find for the iterators then dereference to search without creating entries.
     const auto exeIter = g_aliasData.find(exeNameString);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), exeIter == g_aliasData.end());
-    const auto exeData = exeIter->second;
+    const auto& exeData = exeIter->second;
     const auto sourceIter = exeData.find(sourceString);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), sourceIter == exeData.end());
-    const auto targetString = sourceIter->second;
+    const auto& targetString = sourceIter->second.text;
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), targetString.size() == 0);
 
     // TargetLength is a byte count, convert to characters.
@@ -333,18 +337,18 @@ static std::wstring aliasesSeparator(L"=");
         auto exeIter = g_aliasData.find(exeNameString);
         if (exeIter != g_aliasData.end())
         {
-            auto list = exeIter->second;
+            const auto& list = exeIter->second;
             for (auto& pair : list)
             {
                 // Alias stores lengths in bytes.
                 auto cchSource = pair.first.size();
-                auto cchTarget = pair.second.size();
+                auto cchTarget = pair.second.text.size();
 
                 // If we're counting how much multibyte space will be needed, trial convert the source and target strings before we add.
                 if (!countInUnicode)
                 {
                     cchSource = GetALengthFromW(codepage, pair.first);
-                    cchTarget = GetALengthFromW(codepage, pair.second);
+                    cchTarget = GetALengthFromW(codepage, pair.second.text);
                 }
 
                 // Accumulate all sizes to the final string count.
@@ -464,12 +468,12 @@ void Alias::s_ClearCmdExeAliases()
     auto exeIter = g_aliasData.find(exeNameString);
     if (exeIter != g_aliasData.end())
     {
-        auto list = exeIter->second;
+        const auto& list = exeIter->second;
         for (auto& pair : list)
         {
             // Alias stores lengths in bytes.
             const auto cchSource = pair.first.size();
-            const auto cchTarget = pair.second.size();
+            const auto cchTarget = pair.second.text.size();
 
             // Add up how many characters we will need for the full alias data.
             size_t cchNeeded = 0;
@@ -499,7 +503,7 @@ void Alias::s_ClearCmdExeAliases()
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, aliasesSeparator.size(), &cchAliasBufferRemaining));
                 AliasesBufferPtrW += aliasesSeparator.size();
 
-                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.data(), cchTarget));
+                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.text.data(), cchTarget));
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, cchTarget, &cchAliasBufferRemaining));
                 AliasesBufferPtrW += cchTarget;
 
@@ -822,10 +826,10 @@ void Alias::s_ClearCmdExeAliases()
 // Arguments:
 // - str - String to tokenize
 // Return Value:
-// - Collection of tokenized strings
-std::deque<std::wstring> Alias::s_Tokenize(const std::wstring_view str)
+// - Collection of views into the given string, one per token
+Alias::Tokens Alias::s_Tokenize(const std::wstring_view str)
 {
-    std::deque<std::wstring> result;
+    Tokens result;
 
     size_t prevIndex = 0;
     auto spaceIndex = str.find(L' ');
@@ -854,74 +858,15 @@ std::deque<std::wstring> Alias::s_Tokenize(const std::wstring_view str)
 // - str - String to split into just args
 // Return Value:
 // - Only the arguments part of the string or empty if there are no arguments.
-std::wstring Alias::s_GetArgString(const std::wstring_view str)
+std::wstring_view Alias::s_GetArgString(const std::wstring_view str) noexcept
 {
-    std::wstring result;
-    auto firstSpace = str.find_first_of(L' ');
+    const auto firstSpace = str.find_first_of(L' ');
     if (std::wstring_view::npos != firstSpace)
     {
-        firstSpace++;
-        if (firstSpace < str.size())
-        {
-            result = str.substr(firstSpace);
-        }
+        return str.substr(firstSpace + 1);
     }
 
-    return result;
-}
-
-// Routine Description:
-// - Checks the given character to see if it is a numbered arg replacement macro
-//   and replaces it with the counted argument if there is a match
-// Arguments:
-// - ch - Character to test as a macro
-// - appendToStr - Append the macro result here if it matched
-// - tokens - Tokens of the original command string. 0 is alias. 1-N are arguments.
-// Return Value:
-// - True if we found the macro and appended to the string.
-// - False if the given character doesn't match this macro.
-bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
-                                         std::wstring& appendToStr,
-                                         const std::deque<std::wstring>& tokens)
-{
-    if (ch >= L'1' && ch <= L'9')
-    {
-        // Numerical macros substitute that numbered argument
-        const size_t index = ch - L'0';
-
-        if (index < tokens.size() && index > 0)
-        {
-            appendToStr.append(tokens[index]);
-        }
-
-        return true;
-    }
-
-    return false;
-}
-
-// Routine Description:
-// - Checks the given character to see if it is a wildcard arg replacement macro
-//   and replaces it with the entire argument string if there is a match
-// Arguments:
-// - ch - Character to test as a macro
-// - appendToStr - Append the macro result here if it matched
-// - fullArgString - All of the arguments as one big string.
-// Return Value:
-// - True if we found the macro and appended to the string.
-// - False if the given character doesn't match this macro.
-bool Alias::s_TryReplaceWildcardArgMacro(const wchar_t ch,
-                                         std::wstring& appendToStr,
-                                         const std::wstring fullArgString)
-{
-    if (L'*' == ch)
-    {
-        // Wildcard substitutes all arguments
-        appendToStr.append(fullArgString);
-        return true;
-    }
-
-    return false;
+    return {};
 }
 
 // Routine Description:
@@ -1024,58 +969,60 @@ void Alias::s_AppendCrLf(std::wstring& appendToStr,
 }
 
 // Routine Description:
-// - Searches through the given string for macros and replaces them
-//   with the matching action
+// - Searches through the given alias target for macros and compiles it into
+//   literal text (with the redirection and next command macros already applied)
+//   and argument slots, which are filled in by s_MatchAndCopyAlias.
 // Arguments:
-// - str - On input, the string to search. On output, the string is replaced.
-// - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
-// - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - text - The alias target to compile.
 // Return Value:
-// - The number of commands in the final string (line feeds, CRLFs)
-size_t Alias::s_ReplaceMacros(std::wstring& str,
-                              const std::deque<std::wstring>& tokens,
-                              const std::wstring& fullArgString)
+// - The compiled target.
+Alias::Target Alias::s_CompileTarget(std::wstring text)
 {
-    size_t lineCount = 0;
-    std::wstring finalText;
+    Target target;
+    size_t literalStart = 0;
+
+    const auto appendSegment = [&](const Target::SegmentType type, const size_t offset, const size_t length) {
+        target.segments.emplace_back(Target::Segment{ type, offset, length });
+    };
+    const auto flushLiteral = [&]() {
+        if (target.literals.size() > literalStart)
+        {
+            appendSegment(Target::SegmentType::Literal, literalStart, target.literals.size() - literalStart);
+            literalStart = target.literals.size();
+        }
+    };
 
     // The target text may contain substitution macros indicated by $.
     // Walk through and substitute them as appropriate.
-    for (auto ch = str.cbegin(); ch < str.cend(); ch++)
+    for (auto ch = text.cbegin(); ch < text.cend(); ch++)
     {
         if (L'$' == *ch)
         {
             // Attempt to read ahead by one character.
             const auto chNext = ch + 1;
 
-            if (chNext < str.cend())
+            if (chNext < text.cend())
             {
-                auto isProcessed = s_TryReplaceNumberedArgMacro(*chNext, finalText, tokens);
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceWildcardArgMacro(*chNext, finalText, fullArgString);
-                }
-                if (!isProcessed)
+                if (*chNext >= L'1' && *chNext <= L'9')
                 {
-                    isProcessed = s_TryReplaceInputRedirMacro(*chNext, finalText);
+                    // Numerical macros substitute that numbered argument
+                    flushLiteral();
+                    appendSegment(Target::SegmentType::Argument, gsl::narrow_cast<size_t>(*chNext - L'0'), 0);
                 }
-                if (!isProcessed)
+                else if (L'*' == *chNext)
                 {
-                    isProcessed = s_TryReplaceOutputRedirMacro(*chNext, finalText);
+                    // Wildcard substitutes all arguments
+                    flushLiteral();
+                    appendSegment(Target::SegmentType::Argument, 0, 0);
                 }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplacePipeRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceNextCommandMacro(*chNext, finalText, lineCount);
-                }
-                if (!isProcessed)
+                else if (!s_TryReplaceInputRedirMacro(*chNext, target.literals) &&
+                         !s_TryReplaceOutputRedirMacro(*chNext, target.literals) &&
+                         !s_TryReplacePipeRedirMacro(*chNext, target.literals) &&
+                         !s_TryReplaceNextCommandMacro(*chNext, target.literals, target.lineCount))
                 {
                     // If nothing matches, just push these two characters in.
-                    finalText.push_back(*ch);
-                    finalText.push_back(*chNext);
+                    target.literals.push_back(*ch);
+                    target.literals.push_back(*chNext);
                 }
 
                 // Since we read ahead and used that character,
@@ -1085,22 +1032,22 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
             else
             {
                 // If no read-ahead, just push this character and be done.
-                finalText.push_back(*ch);
+                target.literals.push_back(*ch);
             }
         }
         else
         {
             // If it didn't match the macro specifier $, push the character.
-            finalText.push_back(*ch);
+            target.literals.push_back(*ch);
         }
     }
 
     // We always terminate with a CRLF to symbolize end of command.
-    s_AppendCrLf(finalText, lineCount);
+    s_AppendCrLf(target.literals, target.lineCount);
+    flushLiteral();
 
-    // Give back the final text and count.
-    str.swap(finalText);
-    return lineCount;
+    target.text = std::move(text);
+    return target;
 }
 
 // Routine Description:
@@ -1116,14 +1063,14 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
 std::wstring Alias::s_MatchAndCopyAlias(std::wstring_view sourceText, const std::wstring& exeName, size_t& lineCount)
 {
     // Check if we have an EXE in the list that matches the request first.
-    auto exeIter = g_aliasData.find(exeName);
+    const auto exeIter = g_aliasData.find(exeName);
     if (exeIter == g_aliasData.end())
     {
         // We found no data for this exe. Give back an empty string.
         return std::wstring();
     }
 
-    auto exeList = exeIter->second;
+    const auto& exeList = exeIter->second;
     if (exeList.size() == 0)
     {
         // If there's no match, give back an empty string.
@@ -1140,8 +1087,7 @@ std::wstring Alias::s_MatchAndCopyAlias(std::wstring_view sourceText, const std:
     }
 
     // Find alias. If there isn't one, return an empty string
-    const auto alias = tokens.front();
-    const auto aliasIter = exeList.find(alias);
+    const auto aliasIter = exeList.find(tokens.front());
     if (aliasIter == exeList.end())
     {
         // We found no alias pair with this name. Give back an empty string.
@@ -1149,7 +1095,7 @@ std::wstring Alias::s_MatchAndCopyAlias(std::wstring_view sourceText, const std:
     }
 
     const auto& target = aliasIter->second;
-    if (target.size() == 0)
+    if (target.text.size() == 0)
     {
         return std::wstring();
     }
@@ -1157,10 +1103,34 @@ std::wstring Alias::s_MatchAndCopyAlias(std::wstring_view sourceText, const std:
     // Get the string of all parameters as a shorthand for $* later.
     const auto allParams = s_GetArgString(sourceText);
 
-    // The final text will be the target but with macros replaced.
-    auto finalText = target;
-    lineCount = s_ReplaceMacros(finalText, tokens, allParams);
+    const auto resolve = [&](const Target::Segment& segment) noexcept -> std::wstring_view {
+        if (segment.type == Target::SegmentType::Literal)
+        {
+            return { target.literals.data() + segment.offset, segment.length };
+        }
+        if (segment.offset == 0)
+        {
+            return allParams;
+        }
+        // Arguments that weren't given are substituted with nothing.
+        return segment.offset < tokens.size() ? tokens[segment.offset] : std::wstring_view{};
+    };
+
+    // The final text will be the target but with the arguments filled in.
+    size_t finalSize = 0;
+    for (const auto& segment : target.segments)
+    {
+        finalSize += resolve(segment).size();
+    }
+
+    std::wstring finalText;
+    finalText.reserve(finalSize);
+    for (const auto& segment : target.segments)
+    {
+        finalText.append(resolve(segment));
+    }
 
+    lineCount = target.lineCount;
     return finalText;
 }
 
@@ -1169,7 +1139,7 @@ void Alias::s_TestAddAlias(std::wstring& exe,
                            std::wstring& alias,
                            std::wstring& target)
 {
-    g_aliasData[exe][alias] = target;
+    g_aliasData[exe][alias] = s_CompileTarget(target);
 }
 
 void Alias::s_TestClearAliases()
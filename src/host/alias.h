@@ -11,26 +11,45 @@ Abstract:
 --*/
 #pragma once
 
+#include <til/small_vector.h>
+
 class Alias
 {
 public:
+    // An alias target, compiled into literal text and argument slots when it gets added.
+    // This allows s_MatchAndCopyAlias to expand it in a single pass without rescanning it for macros.
+    struct Target
+    {
+        enum class SegmentType : uint8_t
+        {
+            Literal, // [offset, offset + length) is a range in literals
+            Argument, // offset is the argument number, with 0 being all arguments ($*)
+        };
+
+        struct Segment
+        {
+            SegmentType type;
+            size_t offset;
+            size_t length;
+        };
+
+        std::wstring text; // the target as it was given to us
+        std::wstring literals;
+        std::vector<Segment> segments;
+        size_t lineCount = 0;
+    };
+
+    using Tokens = til::small_vector<std::wstring_view, 10>;
+
     static void s_ClearCmdExeAliases();
 
     static std::wstring s_MatchAndCopyAlias(std::wstring_view sourceText, const std::wstring& exeName, size_t& lineCount);
 
 private:
-    static std::deque<std::wstring> s_Tokenize(const std::wstring_view str);
-    static std::wstring s_GetArgString(const std::wstring_view str);
-    static size_t s_ReplaceMacros(std::wstring& str,
-                                  const std::deque<std::wstring>& tokens,
-                                  const std::wstring& fullArgString);
+    static Target s_CompileTarget(std::wstring text);
 
-    static bool s_TryReplaceNumberedArgMacro(const wchar_t ch,
-                                             std::wstring& appendToStr,
-                                             const std::deque<std::wstring>& tokens);
-    static bool s_TryReplaceWildcardArgMacro(const wchar_t ch,
-                                             std::wstring& appendToStr,
-                                             const std::wstring fullArgString);
+    static Tokens s_Tokenize(const std::wstring_view str);
+    static std::wstring_view s_GetArgString(const std::wstring_view str) noexcept;
 
     static bool s_TryReplaceInputRedirMacro(const wchar_t ch,
                                             std::wstring& appendToStr);
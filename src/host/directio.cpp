@@ -109,6 +109,9 @@ using Microsoft::Console::Interactivity::ServiceLocator;
     {
         written = 0;
 
+        // This event type represents text that was written via InputBuffer::WriteString.
+        RETURN_HR_IF(E_INVALIDARG, std::any_of(events.begin(), events.end(), [](const auto& event) { return event.EventType == InputBuffer::TextSpanEventType; }));
+
         // add to InputBuffer
         if (append)
         {
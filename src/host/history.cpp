@@ -120,6 +120,7 @@ void CommandHistory::_Reset()
             // find free record.  if all records are used, free the lru one.
             if (GetNumberOfCommands() == _maxCommands)
             {
+                _IndexErase(0);
                 _commands.erase(_commands.cbegin());
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
@@ -135,6 +136,7 @@ void CommandHistory::_Reset()
             {
                 _commands.emplace_back(newCommand);
             }
+            _IndexInsert(GetNumberOfCommands() - 1);
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -211,6 +213,7 @@ std::wstring_view CommandHistory::GetLastCommand() const
 void CommandHistory::Empty()
 {
     _commands.clear();
+    _prefixIndex.clear();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
 }
@@ -244,6 +247,8 @@ void CommandHistory::Realloc(const Index commands)
     }
 
     _commands.resize(std::min(_commands.size(), gsl::narrow_cast<size_t>(std::max(0, commands))));
+    // Dropping the entries of the removed commands keeps the remaining ones sorted.
+    std::erase_if(_prefixIndex, [size = GetNumberOfCommands()](const Index index) { return index >= size; });
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = GetNumberOfCommands() - 1;
@@ -349,6 +354,7 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         if (!SameApp)
         {
             BestCandidate->_commands.clear();
+            BestCandidate->_prefixIndex.clear();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
         }
@@ -412,6 +418,7 @@ std::wstring CommandHistory::Remove(const Index iDel)
         return {};
     }
 
+    _IndexErase(iDel);
     const auto str = std::move(_commands.at(iDel));
     _commands.erase(_commands.begin() + iDel);
 
@@ -455,25 +462,82 @@ std::wstring CommandHistory::Remove(const Index iDel)
         return true;
     }
 
-    try
+    if (indexFound < 0 || indexFound >= GetNumberOfCommands())
     {
-        for (size_t i = 0; i < _commands.size(); i++)
+        return false;
+    }
+
+    // All commands starting with givenCommand (or equal to it) form a contiguous range in _prefixIndex.
+    const auto exactMatch = WI_IsFlagSet(options, MatchOptions::ExactMatch);
+    const auto beg = std::lower_bound(_prefixIndex.begin(), _prefixIndex.end(), givenCommand, [&](const Index index, const std::wstring_view& command) {
+        return std::wstring_view{ _commands[index] } < command;
+    });
+    const auto end = std::partition_point(beg, _prefixIndex.end(), [&](const Index index) {
+        const auto& storedCommand = _commands[index];
+        return exactMatch ? storedCommand == givenCommand : til::starts_with(storedCommand, givenCommand);
+    });
+
+    if (beg == end)
+    {
+        return false;
+    }
+
+    // We're looking for the most recent match at or before indexFound, wrapping around to the most recent one overall.
+    Index before = -1;
+    Index overall = -1;
+    for (auto it = beg; it != end; ++it)
+    {
+        const auto index = *it;
+        overall = std::max(overall, index);
+        if (index <= indexFound)
         {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
-            {
-                if (til::starts_with(storedCommand, givenCommand))
-                {
-                    return true;
-                }
-            }
+            before = std::max(before, index);
+        }
+    }
 
-            _Prev(indexFound);
+    indexFound = before >= 0 ? before : overall;
+    return true;
+}
+
+// Returns true if the command at index `a` is sorted before the one at `b` in _prefixIndex.
+bool CommandHistory::_IndexLess(const Index a, const Index b) const
+{
+    const auto& commandA = _commands.at(a);
+    const auto& commandB = _commands.at(b);
+    return commandA < commandB || (commandA == commandB && a < b);
+}
+
+// Adds the command at `index` to _prefixIndex. It must be the most recent one.
+void CommandHistory::_IndexInsert(const Index index)
+{
+    const auto it = std::lower_bound(_prefixIndex.begin(), _prefixIndex.end(), index, [this](const Index a, const Index b) { return _IndexLess(a, b); });
+    _prefixIndex.insert(it, index);
+}
+
+// Removes the command at `index` from _prefixIndex and adjusts the indices of
+// the ones after it. Must be called before it's removed from _commands.
+void CommandHistory::_IndexErase(const Index index)
+{
+    const auto it = std::lower_bound(_prefixIndex.begin(), _prefixIndex.end(), index, [this](const Index a, const Index b) { return _IndexLess(a, b); });
+    if (it != _prefixIndex.end() && *it == index)
+    {
+        _prefixIndex.erase(it);
+    }
+
+    for (auto& i : _prefixIndex)
+    {
+        if (i > index)
+        {
+            --i;
         }
     }
-    CATCH_LOG();
+}
 
-    return false;
+void CommandHistory::_IndexRebuild()
+{
+    _prefixIndex.resize(_commands.size());
+    std::iota(_prefixIndex.begin(), _prefixIndex.end(), 0);
+    std::sort(_prefixIndex.begin(), _prefixIndex.end(), [this](const Index a, const Index b) { return _IndexLess(a, b); });
 }
 
 #ifdef UNIT_TESTING
@@ -496,6 +560,7 @@ void CommandHistory::Swap(const Index indexA, const Index indexB)
         indexB >= 0 && indexB < num)
     {
         std::swap(_commands.at(indexA), _commands.at(indexB));
+        _IndexRebuild();
     }
 }
 
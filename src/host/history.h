@@ -73,10 +73,19 @@ private:
     void _Dec(Index& ind) const;
     void _Inc(Index& ind) const;
 
+    bool _IndexLess(Index a, Index b) const;
+    void _IndexInsert(Index index);
+    void _IndexErase(Index index);
+    void _IndexRebuild();
+
     // NOTE: In conhost v1 this used to be a circular buffer because removal at the
     // start is a very common operation. It seems this was lost in the C++ refactor.
     std::vector<std::wstring> _commands;
     Index _maxCommands = 0;
+    // Indices into _commands, sorted by the command text first and by their index second.
+    // Commands with a common prefix form a contiguous range in it, which allows
+    // FindMatchingCommand to binary search instead of comparing every command.
+    std::vector<Index> _prefixIndex;
 
     std::wstring _appName;
     HANDLE _processHandle = nullptr;
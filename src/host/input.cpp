@@ -170,6 +170,39 @@ void HandleGenericKeyEvent(INPUT_RECORD event, const bool generateBreak)
     }
 }
 
+// Routine Description:
+// - handles a batch of key events, like HandleGenericKeyEvent, but writes
+//   consecutive keys without modifiers to the input buffer in a single call.
+//   Repeated keys are coalesced, just like they are when written one at a time.
+void HandleGenericKeyEvents(const std::span<const INPUT_RECORD>& events)
+{
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    size_t runBeg = 0;
+
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const auto& keyEvent = til::at(events, i).Event.KeyEvent;
+
+        // Only key presses with Ctrl or Alt can trigger the special handling in
+        // HandleGenericKeyEvent (Ctrl+C, Ctrl+Break, ...). To preserve the order
+        // of events, we need to write out all the keys before such a key first.
+        if (keyEvent.bKeyDown && WI_IsAnyFlagSet(keyEvent.dwControlKeyState, CTRL_PRESSED | ALT_PRESSED))
+        {
+            if (i > runBeg)
+            {
+                gci.pInputBuffer->Write(events.subspan(runBeg, i - runBeg), true);
+            }
+            HandleGenericKeyEvent(til::at(events, i), false);
+            runBeg = i + 1;
+        }
+    }
+
+    if (events.size() > runBeg)
+    {
+        gci.pInputBuffer->Write(events.subspan(runBeg), true);
+    }
+}
+
 #ifdef DBG
 // set to true with a debugger to temporarily disable focus events getting written to the InputBuffer
 volatile bool DisableFocusEvents = false;
@@ -10,10 +10,12 @@
 #include <til/bytes.h>
 
 #include "misc.h"
+#include "../interactivity/inc/EventSynthesis.hpp"
 #include "../interactivity/inc/ServiceLocator.hpp"
 
 #define INPUT_BUFFER_DEFAULT_INPUT_MODE (ENABLE_LINE_INPUT | ENABLE_PROCESSED_INPUT | ENABLE_ECHO_INPUT | ENABLE_MOUSE_INPUT)
 
+using Microsoft::Console::Interactivity::CharToKeyEvents;
 using Microsoft::Console::Interactivity::ServiceLocator;
 using Microsoft::Console::VirtualTerminal::TerminalInput;
 using namespace Microsoft::Console;
@@ -151,6 +153,107 @@ void InputBuffer::Cache(std::wstring_view source)
     _cachedTextReaderW = std::wstring_view{ _cachedTextW }.substr(off);
 }
 
+// If the next item in the input buffer is text written via WriteString(), this
+// transfers as much of it into `target` as possible, similar to `Consume`.
+// Returns false if the next item isn't text, in which case `target` is left untouched.
+bool InputBuffer::ConsumeText(bool isUnicode, std::span<char>& target)
+{
+    if (!_isFrontTextSpan())
+    {
+        return false;
+    }
+
+    const auto& span = _textSpans.front();
+    auto source = std::wstring_view{ span.text }.substr(span.offset);
+    const auto length = source.size();
+
+    Consume(isUnicode, source, target);
+    _advanceText(length - source.size());
+    return true;
+}
+
+// Same as `ConsumeText`, but for a single UTF-16 character, as used by GetChar().
+// If given, keyState receives the modifier state of the key event that
+// GetChar() would have returned the character from (for instance SHIFT_PRESSED).
+bool InputBuffer::ConsumeTextChar(wchar_t& wch, DWORD* keyState)
+{
+    if (!_isFrontTextSpan())
+    {
+        return false;
+    }
+
+    const auto& span = _textSpans.front();
+    wch = span.text[span.offset];
+
+    if (keyState)
+    {
+        *keyState = 0;
+
+        InputEventQueue keyEvents;
+        CharToKeyEvents(wch, span.codepage, keyEvents);
+
+        // That's the key down event of the character, or the Alt key up event for Alt+Numpad input.
+        for (const auto& event : keyEvents)
+        {
+            const auto& key = event.Event.KeyEvent;
+            if (key.uChar.UnicodeChar != 0 && (key.bKeyDown || key.wVirtualKeyCode == VK_MENU))
+            {
+                *keyState = key.dwControlKeyState;
+                break;
+            }
+        }
+    }
+
+    _advanceText(1);
+    return true;
+}
+
+// Text spans can only be consumed as text if no previously
+// expanded key events are still waiting to be read.
+bool InputBuffer::_isFrontTextSpan() const noexcept
+{
+    return !_storage.empty() && _storage.front().EventType == TextSpanEventType && _cachedInputEvents.empty();
+}
+
+// Marks `count` characters of the first text span as read and
+// removes the span from the input buffer once it's exhausted.
+void InputBuffer::_advanceText(size_t count)
+{
+    auto& span = _textSpans.front();
+    if (_textSpanEvents)
+    {
+        *_textSpanEvents -= _countKeyEvents(std::wstring_view{ span.text }.substr(span.offset, count), span.codepage);
+    }
+    span.offset += count;
+
+    if (span.offset >= span.text.size())
+    {
+        _textSpans.pop_front();
+        _storage.pop_front();
+
+        if (_storage.empty())
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+        }
+    }
+}
+
+// Returns the number of key events that CharToKeyEvents() turns `text` into.
+size_t InputBuffer::_countKeyEvents(const std::wstring_view text, const UINT codepage)
+{
+    InputEventQueue keyEvents;
+    size_t count = 0;
+
+    for (const auto wch : text)
+    {
+        keyEvents.clear();
+        CharToKeyEvents(wch, codepage, keyEvents);
+        count += keyEvents.size();
+    }
+
+    return count;
+}
+
 // Moves up to `count`, previously cached events into `target`.
 size_t InputBuffer::ConsumeCached(bool isUnicode, size_t count, InputEventQueue& target)
 {
@@ -274,6 +377,8 @@ void InputBuffer::ReinitializeInputBuffer()
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
     InputMode = INPUT_BUFFER_DEFAULT_INPUT_MODE;
     _storage.clear();
+    _textSpans.clear();
+    _textSpanEvents.reset();
 }
 
 // Routine Description:
@@ -306,9 +411,20 @@ void InputBuffer::TerminateRead(_In_ WaitTerminationReason Flag)
 // - The number of events currently in the input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
+// - Text spans are counted as the key events they expand into when read with ReadConsoleInput.
+size_t InputBuffer::GetNumberOfReadyEvents() const
 {
-    return _storage.size();
+    if (!_textSpanEvents)
+    {
+        size_t count = 0;
+        for (const auto& span : _textSpans)
+        {
+            count += _countKeyEvents(std::wstring_view{ span.text }.substr(span.offset), span.codepage);
+        }
+        _textSpanEvents = count;
+    }
+
+    return _storage.size() - _textSpans.size() + *_textSpanEvents;
 }
 
 // Routine Description:
@@ -322,11 +438,14 @@ size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 void InputBuffer::Flush()
 {
     _storage.clear();
+    _textSpans.clear();
+    _textSpanEvents.reset();
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
 }
 
 // Routine Description:
 // - This routine removes all but the key events from the buffer.
+//   Text spans are kept as well, since they represent key events.
 // Arguments:
 // - None
 // Return Value:
@@ -336,7 +455,7 @@ void InputBuffer::Flush()
 void InputBuffer::FlushAllButKeys()
 {
     auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const INPUT_RECORD& event) {
-        return event.EventType != KEY_EVENT;
+        return event.EventType != KEY_EVENT && event.EventType != TextSpanEventType;
     });
     _storage.erase(newEnd, _storage.end());
 }
@@ -381,9 +500,78 @@ try
 
     auto it = _storage.begin();
     const auto end = _storage.end();
+    size_t textSpanIndex = 0;
+    size_t textSpansConsumed = 0;
 
     while (it != end && OutEvents.size() < AmountToRead)
     {
+        if (it->EventType == TextSpanEventType)
+        {
+            // Text spans are expanded into the same key events that CharToKeyEvents()
+            // would have produced at the time they were written, one character at a time.
+            auto& span = _textSpans.at(textSpanIndex);
+            auto offset = span.offset;
+            size_t expanded = 0;
+            InputEventQueue keyEvents;
+
+            while (offset < span.text.size() && OutEvents.size() < AmountToRead)
+            {
+                keyEvents.clear();
+                CharToKeyEvents(span.text[offset], span.codepage, keyEvents);
+                expanded += keyEvents.size();
+                ++offset;
+
+                for (auto& event : keyEvents)
+                {
+                    if (Unicode)
+                    {
+                        OutEvents.push_back(event);
+                        continue;
+                    }
+
+                    const auto wch = event.Event.KeyEvent.uChar.UnicodeChar;
+
+                    char buffer[8];
+                    const auto length = WideCharToMultiByte(cp, 0, &wch, 1, &buffer[0], sizeof(buffer), nullptr, nullptr);
+                    THROW_LAST_ERROR_IF(length <= 0);
+
+                    for (const auto& ch : std::string_view{ &buffer[0], gsl::narrow_cast<size_t>(length) })
+                    {
+                        event.Event.KeyEvent.uChar.UnicodeChar = til::bit_cast<uint8_t>(ch);
+                        OutEvents.push_back(event);
+                    }
+                }
+            }
+
+            if (Peek)
+            {
+                // Unlike regular reads, peeks must not cache the excess events of the last character.
+                if (OutEvents.size() > AmountToRead)
+                {
+                    OutEvents.resize(AmountToRead);
+                }
+            }
+            else
+            {
+                if (_textSpanEvents)
+                {
+                    *_textSpanEvents -= expanded;
+                }
+                span.offset = offset;
+
+                if (offset < span.text.size())
+                {
+                    break;
+                }
+
+                textSpansConsumed++;
+            }
+
+            textSpanIndex++;
+            ++it;
+            continue;
+        }
+
         if (it->EventType == KEY_EVENT)
         {
             auto event = *it;
@@ -444,6 +632,7 @@ try
     if (!Peek)
     {
         _storage.erase(_storage.begin(), it);
+        _textSpans.erase(_textSpans.begin(), _textSpans.begin() + textSpansConsumed);
     }
 
     Cache(Unicode, OutEvents, AmountToRead);
@@ -500,7 +689,7 @@ size_t InputBuffer::Prepend(const std::span<const INPUT_RECORD>& inEvents)
 
         // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
+        _WriteBuffer(inEvents, false, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
         for (const auto& event : existingStorage)
@@ -551,11 +740,13 @@ size_t InputBuffer::Write(const INPUT_RECORD& inEvent)
 // waiting for additional input events.
 // Arguments:
 // - inEvents - input events to store in the buffer.
+// - coalesce - if true, each event is coalesced with the one before it, if possible.
+//   Clients writing via WriteConsoleInput get their events stored as-is, unless they write a single one.
 // Return Value:
 // - The number of events that were written to input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::Write(const std::span<const INPUT_RECORD>& inEvents)
+size_t InputBuffer::Write(const std::span<const INPUT_RECORD>& inEvents, const bool coalesce)
 {
     try
     {
@@ -570,7 +761,7 @@ size_t InputBuffer::Write(const std::span<const INPUT_RECORD>& inEvents)
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(inEvents, coalesce, EventsWritten, SetWaitEvent);
 
         if (SetWaitEvent)
         {
@@ -588,6 +779,109 @@ size_t InputBuffer::Write(const std::span<const INPUT_RECORD>& inEvents)
     }
 }
 
+// Routine Description:
+// - Writes text to the input buffer as if it had been typed on the keyboard.
+//   Runs of printable characters are stored as text spans, which ReadConsole can read without
+//   any conversion and which ReadConsoleInput expands into key events on demand. This avoids
+//   synthesizing 2 or more INPUT_RECORDs per character up front, for instance when pasting.
+// Arguments:
+// - text - the text to write
+// - codepage - the codepage to use for characters that need to be synthesized via Alt+Numpad
+// Return Value:
+// - <none>
+// Note:
+// - The console lock must be held when calling this routine.
+void InputBuffer::WriteString(const std::wstring_view& text, const UINT codepage)
+try
+{
+    if (text.empty())
+    {
+        return;
+    }
+
+    _vtInputShouldSuppress = true;
+    auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
+
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto initiallyEmptyQueue = _storage.empty();
+    const auto isPlainText = [](const wchar_t wch) {
+        return wch >= L' ' && wch != 0x7f;
+    };
+
+    InputEventQueue keyEvents;
+    size_t eventsWritten;
+    bool unusedWaitStatus;
+    auto it = text.begin();
+    const auto end = text.end();
+
+    while (it != end)
+    {
+        // The key events need to go through _WriteBuffer if it might transform them:
+        // In VT input mode they're turned into VT sequences and if output is
+        // suspended (Ctrl+S) the next key press releases it and gets swallowed.
+        if (IsInVirtualTerminalInputMode() || WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED))
+        {
+            keyEvents.clear();
+            for (; it != end; ++it)
+            {
+                CharToKeyEvents(*it, codepage, keyEvents);
+            }
+            _WriteBuffer(keyEvents, false, eventsWritten, unusedWaitStatus);
+            break;
+        }
+
+        const auto beg = it;
+        for (; it != end && isPlainText(*it); ++it)
+        {
+        }
+
+        if (it != beg)
+        {
+            const std::wstring_view run{ beg, it };
+
+            if (!_storage.empty() && _storage.back().EventType == TextSpanEventType && _textSpans.back().codepage == codepage)
+            {
+                _textSpans.back().text.append(run);
+            }
+            else
+            {
+                _textSpans.push_back(TextSpan{ std::wstring{ run }, 0, codepage });
+                INPUT_RECORD placeholder{};
+                placeholder.EventType = TextSpanEventType;
+                _storage.push_back(placeholder);
+            }
+
+            if (_textSpanEvents)
+            {
+                *_textSpanEvents += _countKeyEvents(run, codepage);
+            }
+        }
+
+        // Control characters like CR or Ctrl+C retain their regular key events,
+        // since readers and _WriteBuffer treat many of them specially.
+        keyEvents.clear();
+        for (; it != end && !isPlainText(*it); ++it)
+        {
+            CharToKeyEvents(*it, codepage, keyEvents);
+        }
+
+        if (!keyEvents.empty())
+        {
+            _WriteBuffer(keyEvents, false, eventsWritten, unusedWaitStatus);
+        }
+    }
+
+    if (initiallyEmptyQueue && !_storage.empty())
+    {
+        ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
+    }
+    WakeUpReadersWaitingForData();
+}
+catch (...)
+{
+    LOG_HR(wil::ResultFromCaughtException());
+}
+
 // This can be considered a "privileged" variant of Write() which allows FOCUS_EVENTs to generate focus VT sequences.
 // If we didn't do this, someone could write a FOCUS_EVENT_RECORD with WriteConsoleInput, exit without flushing the
 // input buffer and the next application will suddenly get a "\x1b[I" sequence in their input. See GH#13238.
@@ -662,6 +956,7 @@ static bool IsPauseKey(const KEY_EVENT_RECORD& event)
 // - Coalesces input events and transfers them to storage queue.
 // Arguments:
 // - inRecords - The events to store.
+// - coalesce - if true, each event is coalesced with the previous one, if possible.
 // - eventsWritten - The number of events written since this function
 // was called.
 // - setWaitEvent - on exit, true if buffer became non-empty.
@@ -670,16 +965,36 @@ static bool IsPauseKey(const KEY_EVENT_RECORD& event)
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inEvents, _Out_ size_t& eventsWritten, _Out_ bool& setWaitEvent)
+void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inEvents, bool coalesce, _Out_ size_t& eventsWritten, _Out_ bool& setWaitEvent)
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
 
     eventsWritten = 0;
     setWaitEvent = false;
     const auto initiallyEmptyQueue = _storage.empty();
-    const auto initialInEventsSize = inEvents.size();
     const auto vtInputMode = IsInVirtualTerminalInputMode();
 
+    // The VT sequences for all events are accumulated and written to the buffer at once,
+    // instead of waking up readers for every single one of them. Anything that's
+    // written to _storage directly needs to flush them first to preserve the order.
+    TerminalInput::StringType vtOutput;
+    const auto flushVtOutput = [&]() {
+        if (!vtOutput.empty())
+        {
+            _HandleTerminalInputCallback(vtOutput);
+            vtOutput.clear();
+        }
+    };
+
+    // Text span placeholders are internal to the InputBuffer. WriteConsoleInput rejects them already,
+    // but we check again before anything is written, because a stray one would desynchronize _textSpans.
+    THROW_HR_IF(E_INVALIDARG, std::any_of(inEvents.begin(), inEvents.end(), [](const auto& event) { return event.EventType == TextSpanEventType; }));
+
+    // Writing a single record at a time always coalesced, because this is the
+    // original behavior of the input buffer. Changing this behavior for
+    // WriteConsoleInput may break stuff that was depending on it.
+    coalesce |= inEvents.size() == 1;
+
     for (const auto& inEvent : inEvents)
     {
         if (inEvent.EventType == KEY_EVENT && inEvent.Event.KeyEvent.bKeyDown)
@@ -700,33 +1015,32 @@ void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inEvents, _O
 
         // If we're in vt mode, try and handle it with the vt input module.
         // If it was handled, do nothing else for it.
-        // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
+        // If coalescing was requested, try coalescing it with the previous event currently in the buffer.
         // If it's not coalesced, append it to the buffer.
         if (vtInputMode)
         {
             // GH#11682: TerminalInput::HandleKey can handle both KeyEvents and Focus events seamlessly
             if (const auto out = _termInput.HandleKey(inEvent))
             {
-                _HandleTerminalInputCallback(*out);
+                vtOutput.append(*out);
                 eventsWritten++;
                 continue;
             }
         }
 
-        // we only check for possible coalescing when storing one
-        // record at a time because this is the original behavior of
-        // the input buffer. Changing this behavior may break stuff
-        // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty() && _CoalesceEvent(inEvents[0]))
+        flushVtOutput();
+
+        if (coalesce && !_storage.empty() && _CoalesceEvent(inEvent))
         {
             eventsWritten++;
-            return;
+            continue;
         }
 
         // At this point, the event was neither coalesced, nor processed by VT.
         _storage.push_back(inEvent);
         ++eventsWritten;
     }
+    flushVtOutput();
     if (initiallyEmptyQueue && !_storage.empty())
     {
         setWaitEvent = true;
@@ -25,12 +25,18 @@ public:
     ConsoleWaitQueue WaitQueue; // formerly ReadWaitQueue
     bool fInComposition; // specifies if there's an ongoing text composition
 
+    // The event type of the records that represent text spans (see WriteString()) in the
+    // input queue. Clients must not write it, since their records would be mistaken for one.
+    static constexpr WORD TextSpanEventType = 0x8000;
+
     InputBuffer();
 
     // String oriented APIs
     void Consume(bool isUnicode, std::wstring_view& source, std::span<char>& target);
     void ConsumeCached(bool isUnicode, std::span<char>& target);
     void Cache(std::wstring_view source);
+    bool ConsumeText(bool isUnicode, std::span<char>& target);
+    bool ConsumeTextChar(wchar_t& wch, DWORD* keyState);
     // INPUT_RECORD oriented APIs
     size_t ConsumeCached(bool isUnicode, size_t count, InputEventQueue& target);
     size_t PeekCached(bool isUnicode, size_t count, InputEventQueue& target);
@@ -44,7 +50,7 @@ public:
     void ReinitializeInputBuffer();
     void WakeUpReadersWaitingForData();
     void TerminateRead(_In_ WaitTerminationReason Flag);
-    size_t GetNumberOfReadyEvents() const noexcept;
+    size_t GetNumberOfReadyEvents() const;
     void Flush();
     void FlushAllButKeys();
 
@@ -57,7 +63,8 @@ public:
 
     size_t Prepend(const std::span<const INPUT_RECORD>& inEvents);
     size_t Write(const INPUT_RECORD& inEvent);
-    size_t Write(const std::span<const INPUT_RECORD>& inEvents);
+    size_t Write(const std::span<const INPUT_RECORD>& inEvents, bool coalesce = false);
+    void WriteString(const std::wstring_view& text, UINT codepage);
     void WriteFocusEvent(bool focused) noexcept;
     bool WriteMouseEvent(til::point position, unsigned int button, short keyState, short wheelDelta);
 
@@ -80,7 +87,22 @@ private:
     std::deque<INPUT_RECORD> _cachedInputEvents;
     ReadingMode _readingMode = ReadingMode::StringA;
 
+    // Text written via WriteString() is stored in _textSpans and represented in _storage by a single
+    // placeholder record of type TextSpanEventType per span. This allows ReadConsole to copy the text
+    // directly, while ReadConsoleInput expands it into key events only as they're being read.
+    struct TextSpan
+    {
+        std::wstring text;
+        size_t offset = 0;
+        UINT codepage = 0;
+    };
+
     std::deque<INPUT_RECORD> _storage;
+    std::deque<TextSpan> _textSpans;
+    // The number of key events the unread text in _textSpans expands to. Counting them takes a keyboard
+    // layout lookup per character, so it's only done once GetNumberOfReadyEvents() asks for it.
+    // From then on it's kept up to date, until the text spans are flushed.
+    mutable std::optional<size_t> _textSpanEvents;
     INPUT_RECORD _writePartialByteSequence{};
     bool _writePartialByteSequenceAvailable = false;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
@@ -93,7 +115,10 @@ private:
 
     void _switchReadingMode(ReadingMode mode);
     void _switchReadingModeSlowPath(ReadingMode mode);
-    void _WriteBuffer(const std::span<const INPUT_RECORD>& inRecords, _Out_ size_t& eventsWritten, _Out_ bool& setWaitEvent);
+    bool _isFrontTextSpan() const noexcept;
+    void _advanceText(size_t count);
+    static size_t _countKeyEvents(std::wstring_view text, UINT codepage);
+    void _WriteBuffer(const std::span<const INPUT_RECORD>& inRecords, bool coalesce, _Out_ size_t& eventsWritten, _Out_ bool& setWaitEvent);
     bool _CoalesceEvent(const INPUT_RECORD& inEvent) noexcept;
     void _HandleTerminalInputCallback(const Microsoft::Console::VirtualTerminal::TerminalInput::StringType& text);
 
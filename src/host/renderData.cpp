@@ -339,6 +339,11 @@ const std::vector<size_t> RenderData::GetPatternId(const til::point /*location*/
     return {};
 }
 
+std::span<const interval_tree::IntervalTree<til::point, size_t>::interval> RenderData::GetPatternIntervalsInRow(const til::CoordType /*row*/) const
+{
+    return {};
+}
+
 // Routine Description:
 // - Converts a text attribute into the RGB values that should be presented, applying
 //   relevant table translation information and preferences.
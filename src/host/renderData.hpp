@@ -49,6 +49,7 @@ public:
     const std::wstring GetHyperlinkCustomId(uint16_t id) const override;
 
     const std::vector<size_t> GetPatternId(const til::point location) const override;
+    std::span<const interval_tree::IntervalTree<til::point, size_t>::interval> GetPatternIntervalsInRow(const til::CoordType row) const override;
 
     std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept override;
     const bool IsSelectionActive() const override;
@@ -706,12 +706,9 @@ bool Selection::_HandleColorSelection(const INPUT_KEY_INFO* const pInputKeyInfo)
 
                     Telemetry::Instance().LogColorSelectionUsed();
 
-                    const auto& textBuffer = gci.renderData.GetTextBuffer();
+                    auto& textBuffer = screenInfo.GetTextBuffer();
                     const auto hits = textBuffer.SearchText(str, true);
-                    for (const auto& s : hits)
-                    {
-                        ColorSelection(s.start, s.end, selectionAttr);
-                    }
+                    textBuffer.ReplaceAttributes(hits, selectionAttr);
                 }
             }
             CATCH_LOG();
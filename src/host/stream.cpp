@@ -143,6 +143,13 @@ static bool IsCommandLineEditingKey(const KEY_EVENT_RECORD& event)
 
     for (;;)
     {
+        // Text written via InputBuffer::WriteString() consists only of printable characters
+        // and can be returned as is. Popups however need to see the underlying key events.
+        if (!pPopupKeys && pInputBuffer->ConsumeTextChar(*pwchOut, pdwKeyState))
+        {
+            return STATUS_SUCCESS;
+        }
+
         InputEventQueue events;
         const auto Status = pInputBuffer->Read(events, 1, false, Wait, true, true);
         if (FAILED_NTSTATUS(Status))
@@ -422,6 +429,13 @@ try
 
     while (writer.size() >= charSize)
     {
+        // Text written via InputBuffer::WriteString() can be copied over in bulk.
+        if (inputBuffer.ConsumeText(unicode, writer))
+        {
+            noDataReadYet = false;
+            continue;
+        }
+
         wchar_t wch;
         // We don't need to wait for input if `ConsumeCached` read something already, which is
         // indicated by the writer having been advanced (= it's shorter than the original buffer).
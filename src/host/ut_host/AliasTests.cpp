@@ -196,7 +196,7 @@ class AliasTests
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(std::wstring_view{ tokensExpected[i] }, tokensActual[i]);
         }
     }
 
@@ -212,7 +212,7 @@ class AliasTests
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(std::wstring_view{ tokensExpected[i] }, tokensActual[i]);
         }
     }
 
@@ -230,82 +230,51 @@ class AliasTests
         std::wstring expected;
         _RetrieveTargetExpectedPair(target, expected);
 
-        auto actual = Alias::s_GetArgString(target);
+        const auto actual = Alias::s_GetArgString(target);
 
-        VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
+        VERIFY_ARE_EQUAL(std::wstring_view{ expected }, actual);
     }
 
-    TEST_METHOD(NumberedArgMacro)
+    TEST_METHOD(CompileTarget)
     {
-        BEGIN_TEST_METHOD_PROPERTIES()
-            TEST_METHOD_PROPERTY(L"Data:targetExpectedPair",
-                                 L"{"
-                                 L"1=one,"
-                                 L"2=two,"
-                                 L"3=three,"
-                                 L"4=four,"
-                                 L"5=five,"
-                                 L"6=six,"
-                                 L"7=seven,"
-                                 L"8=eight,"
-                                 L"9=nine,"
-                                 L"A=,"
-                                 L"0=,"
-                                 L"}")
-        END_TEST_METHOD_PROPERTIES()
+        using SegmentType = Alias::Target::SegmentType;
 
-        std::wstring target;
-        std::wstring expected;
-        _RetrieveTargetExpectedPair(target, expected);
+        const auto target = Alias::s_CompileTarget(L"a $1$2b$*$tc$G$0$");
 
-        std::deque<std::wstring> tokens;
-        tokens.emplace_back(L"alias");
-        tokens.emplace_back(L"one");
-        tokens.emplace_back(L"two");
-        tokens.emplace_back(L"three");
-        tokens.emplace_back(L"four");
-        tokens.emplace_back(L"five");
-        tokens.emplace_back(L"six");
-        tokens.emplace_back(L"seven");
-        tokens.emplace_back(L"eight");
-        tokens.emplace_back(L"nine");
-        tokens.emplace_back(L"ten");
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"a $1$2b$*$tc$G$0$" }, std::wstring_view{ target.text });
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"a b\r\nc>$0$\r\n" }, std::wstring_view{ target.literals });
+        VERIFY_ARE_EQUAL(2u, target.lineCount);
 
-        // if we expect non-empty results, then we should get a bool back saying it was processed
-        const auto returnExpected = !expected.empty();
-
-        std::wstring actual;
-        const auto returnActual = Alias::s_TryReplaceNumberedArgMacro(target[0], actual, tokens);
+        const std::array<Alias::Target::Segment, 6> expected{ {
+            { SegmentType::Literal, 0, 2 },
+            { SegmentType::Argument, 1, 0 },
+            { SegmentType::Argument, 2, 0 },
+            { SegmentType::Literal, 2, 1 },
+            { SegmentType::Argument, 0, 0 },
+            { SegmentType::Literal, 3, 9 },
+        } };
+        VERIFY_ARE_EQUAL(expected.size(), target.segments.size());
 
-        VERIFY_ARE_EQUAL(returnExpected, returnActual);
-        VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            VERIFY_IS_TRUE(expected[i].type == target.segments[i].type);
+            VERIFY_ARE_EQUAL(expected[i].offset, target.segments[i].offset);
+            VERIFY_ARE_EQUAL(expected[i].length, target.segments[i].length);
+        }
     }
 
-    TEST_METHOD(WildcardArgMacro)
+    TEST_METHOD(MatchAndCopyMissingArguments)
     {
-        BEGIN_TEST_METHOD_PROPERTIES()
-            TEST_METHOD_PROPERTY(L"Data:targetExpectedPair",
-                                 L"{"
-                                 L"*=one two three,"
-                                 L"A=,"
-                                 L"0=,"
-                                 L"}")
-        END_TEST_METHOD_PROPERTIES()
-
-        std::wstring target;
-        std::wstring expected;
-        _RetrieveTargetExpectedPair(target, expected);
-
-        std::wstring fullArgString(L"one two three");
-
-        // if we expect non-empty results, then we should get a bool back saying it was processed
-        const auto returnExpected = !expected.empty();
+        std::wstring exe(L"test.exe");
+        std::wstring alias(L"foo");
+        std::wstring target(L"bar $1,$2,$3 ($*)");
+        Alias::s_TestAddAlias(exe, alias, target);
 
-        std::wstring actual;
-        const auto returnActual = Alias::s_TryReplaceWildcardArgMacro(target[0], actual, fullArgString);
+        size_t lineCount = 0;
+        const auto actual = Alias::s_MatchAndCopyAlias(L"FOO one", exe, lineCount);
 
-        VERIFY_ARE_EQUAL(returnExpected, returnActual);
-        VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"bar one,, (one)\r\n" }, std::wstring_view{ actual });
+        VERIFY_ARE_EQUAL(1u, lineCount);
     }
 
     TEST_METHOD(InputRedirMacro)
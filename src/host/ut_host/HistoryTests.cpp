@@ -242,7 +242,103 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(FindMatchingCommandMatchesLinearSearch)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+        history->Realloc(64);
+
+        const auto verifyAll = [&]() {
+            const auto count = history->GetNumberOfCommands();
+            for (const auto& item : _manyHistoryItems)
+            {
+                for (const auto options : { CommandHistory::MatchOptions::JustLooking, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch })
+                {
+                    for (size_t length = 1; length <= item.size(); length++)
+                    {
+                        const std::wstring_view given{ item.data(), length };
+                        for (CommandHistory::Index start = 0; start <= count; start++)
+                        {
+                            const auto expected = _linearFindMatchingCommand(*history, given, start, options);
+                            CommandHistory::Index actual;
+                            const auto found = history->FindMatchingCommand(given, start, actual, options);
+                            VERIFY_ARE_EQUAL(expected.has_value(), found);
+                            if (found)
+                            {
+                                VERIFY_ARE_EQUAL(*expected, actual);
+                            }
+                        }
+                    }
+                }
+            }
+        };
+
+        Log::Comment(L"Fill the history with many (duplicate) commands.");
+        for (size_t i = 0; i < 40; i++)
+        {
+            VERIFY_SUCCEEDED(history->Add(_manyHistoryItems[(i * 7) % _manyHistoryItems.size()], false));
+        }
+        verifyAll();
+
+        Log::Comment(L"Add more than fit, dropping the oldest ones.");
+        for (size_t i = 0; i < 40; i++)
+        {
+            VERIFY_SUCCEEDED(history->Add(_manyHistoryItems[(i * 5) % _manyHistoryItems.size()], (i % 3) == 0));
+        }
+        verifyAll();
+
+        Log::Comment(L"Remove and swap a few commands.");
+        std::ignore = history->Remove(0);
+        std::ignore = history->Remove(10);
+        std::ignore = history->Remove(history->GetNumberOfCommands() - 1);
+        history->Swap(3, 17);
+        verifyAll();
+
+        Log::Comment(L"Shrink the history.");
+        history->Realloc(20);
+        verifyAll();
+
+        Log::Comment(L"Empty the history.");
+        history->Empty();
+        verifyAll();
+    }
+
 private:
+    // This is how FindMatchingCommand used to work before it used a sorted index.
+    static std::optional<CommandHistory::Index> _linearFindMatchingCommand(const CommandHistory& history, const std::wstring_view given, CommandHistory::Index index, const CommandHistory::MatchOptions options)
+    {
+        const auto count = history.GetNumberOfCommands();
+        if (count == 0)
+        {
+            return std::nullopt;
+        }
+
+        const auto prev = [&]() {
+            index = index <= 0 ? count - 1 : index - 1;
+        };
+
+        prev();
+        if (index < 0 || index >= count)
+        {
+            return std::nullopt;
+        }
+
+        for (CommandHistory::Index i = 0; i < count; i++)
+        {
+            const auto stored = history.GetNth(index);
+            if ((WI_IsFlagClear(options, CommandHistory::MatchOptions::ExactMatch) && given.size() <= stored.size()) || given.size() == stored.size())
+            {
+                if (til::starts_with(stored, given))
+                {
+                    return index;
+                }
+            }
+            prev();
+        }
+
+        return std::nullopt;
+    }
+
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
         L"bar.exe",
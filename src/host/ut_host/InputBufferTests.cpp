@@ -6,10 +6,14 @@
 #include "../../inc/consoletaeftemplates.hpp"
 #include "CommonState.hpp"
 
+#include "../interactivity/inc/EventSynthesis.hpp"
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/IInputEvent.hpp"
+#include "stream.h"
 
+using namespace WEX::Common;
 using namespace WEX::Logging;
+using Microsoft::Console::Interactivity::CharToKeyEvents;
 using Microsoft::Console::Interactivity::ServiceLocator;
 
 class InputBufferTests
@@ -219,6 +223,39 @@ class InputBufferTests
         }
     }
 
+    TEST_METHOD(InputBufferCoalescesBulkEventsIfRequested)
+    {
+        Log::Comment(L"The input buffer should coalesce each event of a bulk write if asked to");
+
+        InputBuffer inputBuffer;
+        InputEventQueue events;
+
+        const auto keyRecord = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
+        INPUT_RECORD mouseRecord{};
+        mouseRecord.EventType = MOUSE_EVENT;
+        mouseRecord.Event.MouseEvent.dwEventFlags = MOUSE_MOVED;
+
+        for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            events.push_back(keyRecord);
+        }
+        for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            mouseRecord.Event.MouseEvent.dwMousePosition.X = static_cast<SHORT>(i + 1);
+            events.push_back(mouseRecord);
+        }
+
+        inputBuffer.Flush();
+        // send one key event to coalesce into
+        VERIFY_IS_GREATER_THAN(inputBuffer.Write(keyRecord), 0u);
+        VERIFY_ARE_EQUAL(inputBuffer.Write(events, true), 2 * RECORD_INSERT_COUNT);
+
+        // the keys and mouse moves should have been coalesced into one event each
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 2u);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[0].Event.KeyEvent.wRepeatCount, RECORD_INSERT_COUNT + 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[1].Event.MouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+    }
+
     TEST_METHOD(InputBufferDoesNotCoalesceFullWidthChars)
     {
         InputBuffer inputBuffer;
@@ -642,4 +679,308 @@ class InputBufferTests
         VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(outEvents.front().Event.KeyEvent.wRepeatCount, 1u);
     }
+
+    // Returns the key events that WriteString() is expected to be equivalent to.
+    static InputEventQueue MakeKeyEvents(const std::wstring_view& text)
+    {
+        InputEventQueue keyEvents;
+        for (const auto& wch : text)
+        {
+            CharToKeyEvents(wch, CP_UTF8, keyEvents);
+        }
+        return keyEvents;
+    }
+
+    TEST_METHOD(WriteStringReadsAsKeyEvents)
+    {
+        static constexpr std::wstring_view text{ L"Hello,\r\n\tWorld! \u00e4\u304b\x7f." };
+        const auto expected = MakeKeyEvents(text);
+
+        for (const size_t amount : { 1, 3, 1000 })
+        {
+            Log::Comment(NoThrowString().Format(L"reading %zu events at a time", amount));
+
+            InputBuffer inputBuffer;
+            inputBuffer.WriteString(text, CP_UTF8);
+            VERIFY_IS_GREATER_THAN(inputBuffer.GetNumberOfReadyEvents(), 0u);
+
+            InputEventQueue actual;
+            for (;;)
+            {
+                InputEventQueue outEvents;
+                VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, amount, false, false, true, false));
+                if (outEvents.empty())
+                {
+                    break;
+                }
+                VERIFY_IS_LESS_THAN_OR_EQUAL(outEvents.size(), amount);
+                actual.insert(actual.end(), outEvents.begin(), outEvents.end());
+            }
+
+            VERIFY_ARE_EQUAL(expected.size(), actual.size());
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                VERIFY_ARE_EQUAL(expected[i], actual[i]);
+            }
+            VERIFY_ARE_EQUAL(0u, inputBuffer.GetNumberOfReadyEvents());
+            VERIFY_ARE_EQUAL(0u, inputBuffer._textSpans.size());
+        }
+    }
+
+    TEST_METHOD(WriteStringPeeksAsKeyEvents)
+    {
+        static constexpr std::wstring_view text{ L"abc\rdef" };
+        const auto expected = MakeKeyEvents(text);
+
+        InputBuffer inputBuffer;
+        inputBuffer.WriteString(text, CP_UTF8);
+
+        for (const size_t amount : { 1, 3, 1000 })
+        {
+            InputEventQueue outEvents;
+            VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, amount, true, false, true, false));
+            VERIFY_ARE_EQUAL(std::min<size_t>(amount, expected.size()), outEvents.size());
+            for (size_t i = 0; i < outEvents.size(); ++i)
+            {
+                VERIFY_ARE_EQUAL(expected[i], outEvents[i]);
+            }
+        }
+
+        // Peeking must not have consumed anything.
+        std::wstring buffer(16, L'\0');
+        std::span<char> target{ reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(wchar_t) };
+        VERIFY_IS_TRUE(inputBuffer.ConsumeText(true, target));
+        VERIFY_ARE_EQUAL(L"abc", std::wstring_view{ buffer }.substr(0, 3));
+    }
+
+    TEST_METHOD(WriteStringConsumesAsText)
+    {
+        InputBuffer inputBuffer;
+        inputBuffer.WriteString(L"abc", CP_UTF8);
+        inputBuffer.WriteString(L"def\rghi", CP_UTF8);
+
+        // Consecutive writes get merged into a single span.
+        VERIFY_ARE_EQUAL(4u, inputBuffer._storage.size());
+        VERIFY_ARE_EQUAL(2u, inputBuffer._textSpans.size());
+
+        std::wstring buffer(4, L'\0');
+        std::span<char> target{ reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(wchar_t) };
+        VERIFY_IS_TRUE(inputBuffer.ConsumeText(true, target));
+        VERIFY_ARE_EQUAL(0u, target.size());
+        VERIFY_ARE_EQUAL(L"abcd", std::wstring_view{ buffer });
+
+        wchar_t wch = 0;
+        VERIFY_IS_TRUE(inputBuffer.ConsumeTextChar(wch, nullptr));
+        VERIFY_ARE_EQUAL(L'e', wch);
+
+        // A partially read span is expanded into key events if it's read as such.
+        InputEventQueue outEvents;
+        VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, 1, false, false, true, true));
+        VERIFY_ARE_EQUAL(MakeKeyEvents(L"f").front(), outEvents.front());
+
+        // GetChar() skips over the remaining events of "f", returns the CR and then
+        // continues with the text. ReadCharacterInput() for instance works this way.
+        VERIFY_NT_SUCCESS(GetChar(&inputBuffer, &wch, false, nullptr, nullptr, nullptr));
+        VERIFY_ARE_EQUAL(L'\r', wch);
+        VERIFY_NT_SUCCESS(GetChar(&inputBuffer, &wch, false, nullptr, nullptr, nullptr));
+        VERIFY_ARE_EQUAL(L'g', wch);
+
+        std::string narrow(4, '\0');
+        std::span<char> narrowTarget{ narrow };
+        VERIFY_IS_TRUE(inputBuffer.ConsumeText(false, narrowTarget));
+        VERIFY_ARE_EQUAL(2u, narrowTarget.size());
+        VERIFY_ARE_EQUAL("hi", std::string_view{ narrow }.substr(0, 2));
+
+        VERIFY_IS_FALSE(inputBuffer.ConsumeText(false, narrowTarget));
+        VERIFY_ARE_EQUAL(0u, inputBuffer._storage.size());
+        VERIFY_ARE_EQUAL(0u, inputBuffer._textSpans.size());
+        VERIFY_ARE_EQUAL(0u, inputBuffer.GetNumberOfReadyEvents());
+    }
+
+    TEST_METHOD(WriteStringExpandedEventsComeFirst)
+    {
+        InputBuffer inputBuffer;
+        inputBuffer.WriteString(L"xy", CP_UTF8);
+
+        InputEventQueue outEvents;
+        VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, 1, false, false, true, true));
+        VERIFY_ARE_EQUAL(L'x', outEvents.front().Event.KeyEvent.uChar.UnicodeChar);
+
+        // The key up event of "x" is still cached and must be read before the "y".
+        wchar_t wch = 0;
+        VERIFY_IS_FALSE(inputBuffer.ConsumeTextChar(wch, nullptr));
+        VERIFY_NT_SUCCESS(GetChar(&inputBuffer, &wch, false, nullptr, nullptr, nullptr));
+        VERIFY_ARE_EQUAL(L'y', wch);
+        VERIFY_ARE_EQUAL(0u, inputBuffer.GetNumberOfReadyEvents());
+    }
+
+    TEST_METHOD(WriteStringCountsExpandedEvents)
+    {
+        // Uppercase letters are typed with Shift and characters that aren't on the
+        // keyboard with Alt+Numpad. Both expand into more than 2 key events.
+        static constexpr std::wstring_view text{ L"aB\u00e4\u2500\u304b" };
+
+        InputBuffer inputBuffer;
+        inputBuffer.WriteString(text, CP_UTF8);
+        VERIFY_ARE_EQUAL(MakeKeyEvents(text).size(), inputBuffer.GetNumberOfReadyEvents());
+
+        // Once counted, the count is kept up to date by writes and reads.
+        inputBuffer.WriteString(L"C", CP_UTF8);
+        VERIFY_ARE_EQUAL(MakeKeyEvents(text).size() + MakeKeyEvents(L"C").size(), inputBuffer.GetNumberOfReadyEvents());
+
+        wchar_t wch = 0;
+        VERIFY_IS_TRUE(inputBuffer.ConsumeTextChar(wch, nullptr));
+        VERIFY_ARE_EQUAL(MakeKeyEvents(text.substr(1)).size() + MakeKeyEvents(L"C").size(), inputBuffer.GetNumberOfReadyEvents());
+
+        const auto remaining = MakeKeyEvents(text.substr(1));
+        InputEventQueue outEvents;
+        VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, remaining.size(), false, false, true, false));
+        VERIFY_ARE_EQUAL(remaining.size(), outEvents.size());
+        VERIFY_ARE_EQUAL(MakeKeyEvents(L"C").size(), inputBuffer.GetNumberOfReadyEvents());
+    }
+
+    TEST_METHOD(WriteStringReturnsKeyState)
+    {
+        // GetChar() reports the modifier state of the key down event, for instance SHIFT_PRESSED for "B".
+        for (const auto wch : { L'a', L'B', L'\u00e4' })
+        {
+            DWORD expected = 0;
+            for (const auto& event : MakeKeyEvents({ &wch, 1 }))
+            {
+                const auto& key = event.Event.KeyEvent;
+                if (key.uChar.UnicodeChar != 0 && (key.bKeyDown || key.wVirtualKeyCode == VK_MENU))
+                {
+                    expected = key.dwControlKeyState;
+                    break;
+                }
+            }
+
+            InputBuffer inputBuffer;
+            inputBuffer.WriteString({ &wch, 1 }, CP_UTF8);
+
+            wchar_t actual = 0;
+            DWORD keyState = 0xffffffff;
+            VERIFY_NT_SUCCESS(GetChar(&inputBuffer, &actual, false, nullptr, nullptr, &keyState));
+            VERIFY_ARE_EQUAL(wch, actual);
+            VERIFY_ARE_EQUAL(expected, keyState);
+        }
+    }
+
+    TEST_METHOD(WriteRejectsTextSpanEvents)
+    {
+        InputBuffer inputBuffer;
+        inputBuffer.WriteString(L"abc", CP_UTF8);
+
+        INPUT_RECORD records[2]{};
+        records[0] = MakeKeyEvent(true, 1, L'x', 0, L'x', 0);
+        records[1].EventType = InputBuffer::TextSpanEventType;
+
+        // Nothing of the batch is written, because the record would be mistaken for a text span.
+        VERIFY_ARE_EQUAL(0u, inputBuffer.Write(records));
+        VERIFY_ARE_EQUAL(1u, inputBuffer._storage.size());
+        VERIFY_ARE_EQUAL(1u, inputBuffer._textSpans.size());
+    }
+
+    TEST_METHOD(WriteStringInVtInputMode)
+    {
+        InputBuffer inputBuffer;
+        WI_SetFlag(inputBuffer.InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT);
+        inputBuffer.WriteString(L"abc", CP_UTF8);
+
+        // VT input mode requires the key events to be translated immediately.
+        VERIFY_ARE_EQUAL(0u, inputBuffer._textSpans.size());
+        wchar_t wch = 0;
+        VERIFY_IS_FALSE(inputBuffer.ConsumeTextChar(wch, nullptr));
+    }
+
+    TEST_METHOD(WriteStringFlush)
+    {
+        InputBuffer inputBuffer;
+        inputBuffer.WriteString(L"abc\rdef", CP_UTF8);
+
+        inputBuffer.FlushAllButKeys();
+        VERIFY_ARE_EQUAL(2u, inputBuffer._textSpans.size());
+        VERIFY_ARE_EQUAL(MakeKeyEvents(L"abc\rdef").size(), inputBuffer.GetNumberOfReadyEvents());
+
+        inputBuffer.Flush();
+        VERIFY_ARE_EQUAL(0u, inputBuffer._storage.size());
+        VERIFY_ARE_EQUAL(0u, inputBuffer._textSpans.size());
+        VERIFY_ARE_EQUAL(0u, inputBuffer.GetNumberOfReadyEvents());
+    }
+
+    TEST_METHOD(PastePerformance)
+    {
+        // Simulates pasting 1 MiB of text into a shell that reads it via ReadConsole.
+
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        std::wstring text;
+        text.reserve(1024 * 1024);
+        while (text.size() < 1024 * 1024)
+        {
+            text.append(L"The quick brown fox jumps over the lazy dog. 0123456789 !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~\r");
+        }
+
+        static constexpr auto iterations = 10;
+
+        const auto measure = [&](const wchar_t* name, auto&& write) {
+            using namespace std::chrono;
+
+            nanoseconds total{};
+            std::wstring buffer(4096, L'\0');
+
+            for (auto i = 0; i < iterations; ++i)
+            {
+                InputBuffer inputBuffer;
+
+                const auto beg = steady_clock::now();
+
+                write(inputBuffer);
+
+                // This is equivalent to what ReadCharacterInput() does.
+                size_t read = 0;
+                for (;;)
+                {
+                    std::span<char> target{ reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(wchar_t) };
+                    while (!target.empty())
+                    {
+                        if (inputBuffer.ConsumeText(true, target))
+                        {
+                            continue;
+                        }
+
+                        wchar_t wch;
+                        if (FAILED_NTSTATUS(GetChar(&inputBuffer, &wch, false, nullptr, nullptr, nullptr)))
+                        {
+                            break;
+                        }
+
+                        std::wstring_view wchView{ &wch, 1 };
+                        inputBuffer.Consume(true, wchView, target);
+                    }
+
+                    const auto length = buffer.size() - target.size() / sizeof(wchar_t);
+                    if (length == 0)
+                    {
+                        break;
+                    }
+                    read += length;
+                }
+
+                total += steady_clock::now() - beg;
+                VERIFY_ARE_EQUAL(text.size(), read);
+            }
+
+            Log::Comment(NoThrowString().Format(L"%s: %d pastes took %lld us. Avg %lld us per paste", name, iterations, duration_cast<microseconds>(total).count(), duration_cast<microseconds>(total / iterations).count()));
+        };
+
+        measure(L"key events", [&](InputBuffer& inputBuffer) {
+            inputBuffer.Write(MakeKeyEvents(text));
+        });
+        measure(L"text spans", [&](InputBuffer& inputBuffer) {
+            inputBuffer.WriteString(text, CP_UTF8);
+        });
+    }
 };
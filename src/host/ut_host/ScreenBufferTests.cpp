@@ -259,6 +259,7 @@ class ScreenBufferTests
     TEST_METHOD(TestDeferredMainBufferResize);
 
     TEST_METHOD(RectangularAreaOperations);
+    TEST_METHOD(FillRectangularAreaWithCombiningCharacter);
     TEST_METHOD(CopyDoubleWidthRectangularArea);
 
     TEST_METHOD(DelayedWrapReset);
@@ -8150,6 +8151,61 @@ void ScreenBufferTests::RectangularAreaOperations()
     VERIFY_IS_TRUE(_ValidateLinesContain(targetArea.right, targetArea.top, targetArea.bottom, bufferChar, bufferAttr));
 }
 
+void ScreenBufferTests::FillRectangularAreaWithCombiningCharacter()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    auto& textBuffer = si.GetTextBuffer();
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+
+    // DECFRA only accepts characters beyond Latin-1 if the code page is UTF-8.
+    const auto restoreCodePage = wil::scope_exit([&gci, outputCP = gci.OutputCP]() {
+        gci.OutputCP = outputCP;
+    });
+    gci.OutputCP = CP_UTF8;
+
+    const auto bufferChar = L'Z';
+    const auto bufferAttr = TextAttribute{ FOREGROUND_BLUE | BACKGROUND_GREEN };
+    _FillLines(0, 4, bufferChar, bufferAttr);
+
+    const auto activeAttr = TextAttribute{ FOREGROUND_RED | BACKGROUND_BLUE };
+    si.SetAttributes(activeAttr);
+
+    Log::Comment(L"DECFRA: fill rows 2 to 3 and columns 3 to 12 with U+0301 COMBINING ACUTE ACCENT");
+    stateMachine.ProcessString(L"\033[769;2;3;3;12$x");
+
+    // FillRect() must measure the fill character just like ReplaceText() does.
+    auto& expectedRow = textBuffer.GetScratchpadRow(activeAttr);
+    RowWriteState state{
+        .columnLimit = 12,
+        .columnEnd = 2,
+    };
+    while (state.columnEnd < state.columnLimit)
+    {
+        state.columnBegin = state.columnEnd;
+        state.text = L"\u0301";
+        expectedRow.ReplaceText(state);
+    }
+
+    for (til::CoordType y = 1; y < 3; ++y)
+    {
+        const auto& row = textBuffer.GetRowByOffset(y);
+        for (til::CoordType x = 2; x < 12; ++x)
+        {
+            VERIFY_ARE_EQUAL(expectedRow.GlyphAt(x), row.GlyphAt(x));
+            VERIFY_IS_TRUE(expectedRow.DbcsAttrAt(x) == row.DbcsAttrAt(x));
+            VERIFY_ARE_EQUAL(activeAttr, row.GetAttrByColumn(x));
+        }
+    }
+
+    Log::Comment(L"Everything outside of the target area should remain unchanged");
+    VERIFY_IS_TRUE(_ValidateLineContains(0, bufferChar, bufferAttr));
+    VERIFY_IS_TRUE(_ValidateLinesContain(1, 3, std::wstring(2, bufferChar), bufferAttr));
+    VERIFY_IS_TRUE(_ValidateLinesContain(12, 1, 3, bufferChar, bufferAttr));
+    VERIFY_IS_TRUE(_ValidateLineContains(3, bufferChar, bufferAttr));
+}
+
 void ScreenBufferTests::CopyDoubleWidthRectangularArea()
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -91,6 +91,7 @@ class TextBufferTests
     TEST_METHOD(TestBoundaryMeasuresFullString);
     TEST_METHOD(TestBoundaryMeasuresRegularString);
     TEST_METHOD(TestBoundaryMeasuresFloatingString);
+    TEST_METHOD(TestBoundaryMeasuresEveryPosition);
 
     TEST_METHOD(TestCopyProperties);
 
@@ -148,6 +149,8 @@ class TextBufferTests
     TEST_METHOD(TestBurrito);
     TEST_METHOD(TestOverwriteChars);
     TEST_METHOD(TestRowReplaceText);
+    TEST_METHOD(TestRowReplaceTextAsciiBlocks);
+    TEST_METHOD(TestRowTrivialLayout);
 
     TEST_METHOD(TestAppendRTFText);
 
@@ -161,6 +164,16 @@ class TextBufferTests
 
     TEST_METHOD(HyperlinkTrim);
     TEST_METHOD(NoHyperlinkTrim);
+
+    TEST_METHOD(RowsModifiedSince);
+
+    TEST_METHOD(FillRectFastPath);
+    TEST_METHOD(FillRectPerformance);
+
+    TEST_METHOD(ScrollMarksAreAnchored);
+
+    TEST_METHOD(ReplaceAttributesInSpans);
+    TEST_METHOD(ReplaceAttributesInSpansPerformance);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -359,6 +372,35 @@ void TextBufferTests::TestBoundaryMeasuresFloatingString()
     DoBoundaryTest(pwszOffsets, 14, csBufferWidth, 5, 9);
 }
 
+void TextBufferTests::TestBoundaryMeasuresEveryPosition()
+{
+    WEX::TestExecution::SetVerifyOutput settings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+
+    // MeasureLeft() and MeasureRight() scan the row in blocks of 16 (AVX2) and 8 (SSE2/NEON) characters.
+    // Testing every width up to a couple of blocks with text in every position covers all of their combinations.
+    const TextAttribute attr{ 0x07 };
+    for (til::CoordType width = 1; width <= 40; ++width)
+    {
+        TextBuffer buffer{ { width, 1 }, attr, 12, false, _renderer };
+        auto& row = buffer.GetMutableRowByOffset(0);
+        VERIFY_ARE_EQUAL(width, row.MeasureLeft());
+        VERIFY_ARE_EQUAL(0, row.MeasureRight());
+
+        for (til::CoordType i = 0; i < width; ++i)
+        {
+            for (auto j = i; j < width; ++j)
+            {
+                row.Reset(attr);
+                row.ReplaceCharacters(i, 1, L"x");
+                row.ReplaceCharacters(j, 1, L"y");
+                VERIFY_ARE_EQUAL(i, row.MeasureLeft());
+                VERIFY_ARE_EQUAL(j + 1, row.MeasureRight());
+                VERIFY_IS_TRUE(row.ContainsText());
+            }
+        }
+    }
+}
+
 void TextBufferTests::TestCopyProperties()
 {
     auto& otherTbi = GetTbi();
@@ -2084,6 +2126,121 @@ void TextBufferTests::TestRowReplaceText()
 #undef complex
 }
 
+void TextBufferTests::TestRowReplaceTextAsciiBlocks()
+{
+    // ReplaceText() processes ASCII in blocks of 8 and 16 characters. This test writes strings of various lengths
+    // at various offsets, with a single wide glyph somewhere in them, so that the transition from the ASCII blocks
+    // to the scalar loop and to the Unicode slow path is tested at every position within a block.
+    static constexpr til::size bufferSize{ 64, 1 };
+    static constexpr UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    auto& row = buffer.GetMutableRowByOffset(0);
+
+    for (const auto columnBegin : { 0, 1, 7, 9 })
+    {
+        for (size_t length = 1; length <= 40; ++length)
+        {
+            for (size_t wide = 0; wide <= length; ++wide)
+            {
+                std::wstring text;
+                for (size_t i = 0; i < length; ++i)
+                {
+                    text.push_back(i == wide ? L'\x3042' : gsl::narrow_cast<wchar_t>(L'a' + i % 26));
+                }
+
+                row.Reset(attr);
+                RowWriteState state{
+                    .text = text,
+                    .columnBegin = columnBegin,
+                    .columnLimit = til::CoordTypeMax,
+                };
+                row.ReplaceText(state);
+
+                const auto columnEnd = gsl::narrow_cast<til::CoordType>(columnBegin + length + (wide < length));
+                VERIFY_ARE_EQUAL(std::wstring_view{}, state.text);
+                VERIFY_ARE_EQUAL(columnEnd, state.columnEnd);
+
+                auto column = columnBegin;
+                for (size_t i = 0; i < length; ++i)
+                {
+                    VERIFY_ARE_EQUAL(std::wstring_view{ &text[i], 1 }, row.GlyphAt(column));
+                    column += i == wide ? 2 : 1;
+                }
+                VERIFY_ARE_EQUAL(std::wstring_view{ L" " }, row.GlyphAt(column));
+            }
+        }
+    }
+}
+
+void TextBufferTests::TestRowTrivialLayout()
+{
+    // Rows that only contain narrow, single-wchar_t glyphs don't maintain their char offsets. This test ensures
+    // that the switch to explicit offsets works no matter which write operation triggers it, and that copying
+    // text between rows with and without a trivial layout works in either direction.
+    static constexpr til::size bufferSize{ 10, 3 };
+    static constexpr UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+    auto& trivial = buffer.GetMutableRowByOffset(0);
+    auto& complex = buffer.GetMutableRowByOffset(1);
+
+    const auto write = [](ROW& row, const std::wstring_view& text, til::CoordType columnBegin) {
+        RowWriteState state{
+            .text = text,
+            .columnBegin = columnBegin,
+        };
+        row.ReplaceText(state);
+    };
+    const auto copy = [](ROW& row, const ROW& source, til::CoordType columnBegin, til::CoordType sourceColumnBegin) {
+        RowCopyTextFromState state{
+            .source = source,
+            .columnBegin = columnBegin,
+            .sourceColumnBegin = sourceColumnBegin,
+        };
+        row.CopyTextFrom(state);
+    };
+
+    Log::Comment(L"Narrow non-ASCII glyphs keep the layout trivial");
+    write(trivial, L"ab\x05D0cdefghi", 0);
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"ab\x05D0cdefghi" }, trivial.GetText());
+    VERIFY_ARE_EQUAL(4, trivial.GetLeadingColumnAtCharOffset(4));
+    VERIFY_ARE_EQUAL(3, trivial.NavigateToNext(2));
+
+    Log::Comment(L"A wide glyph in the middle of a write switches to explicit offsets");
+    write(complex, L"ab\x3042cd\U0001F41Bef", 0);
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"ab\x3042cd\U0001F41Bef" }, complex.GetText());
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"\x3042" }, complex.GlyphAt(3));
+    VERIFY_ARE_EQUAL(DbcsAttribute::Trailing, complex.DbcsAttrAt(3));
+    VERIFY_ARE_EQUAL(4, complex.NavigateToNext(2));
+    VERIFY_ARE_EQUAL(6, complex.AdjustToGlyphStart(7));
+    VERIFY_ARE_EQUAL(7, complex.GetTrailingColumnAtCharOffset(5));
+
+    Log::Comment(L"Copying from a trivial into a complex row");
+    copy(complex, trivial, 1, 6);
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"afghid\U0001F41Bef" }, complex.GetText());
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"\U0001F41B" }, complex.GlyphAt(7));
+    VERIFY_ARE_EQUAL(6, complex.GetLeadingColumnAtCharOffset(6));
+
+    Log::Comment(L"Copying from a complex into a trivial row");
+    copy(trivial, complex, 4, 5);
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"ab\x05D0cd\U0001F41Befi" }, trivial.GetText());
+    VERIFY_ARE_EQUAL(DbcsAttribute::Leading, trivial.DbcsAttrAt(5));
+    VERIFY_ARE_EQUAL(7, trivial.NavigateToNext(5));
+
+    Log::Comment(L"Reset() returns to a trivial layout");
+    trivial.Reset(attr);
+    write(trivial, L"0123456789", 0);
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"0123456789" }, trivial.GetText());
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"9" }, trivial.GlyphAt(9));
+
+    Log::Comment(L"ReplaceCharacters() with a wide glyph switches to explicit offsets");
+    trivial.ReplaceCharacters(3, 2, L"\x3042");
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"012\x304256789" }, trivial.GetText());
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"\x3042" }, trivial.GlyphAt(4));
+    VERIFY_ARE_EQUAL(DbcsAttribute::Leading, trivial.DbcsAttrAt(3));
+}
+
 void TextBufferTests::TestAppendRTFText()
 {
     {
@@ -2775,3 +2932,351 @@ void TextBufferTests::NoHyperlinkTrim()
     VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
     VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalCustomId], id);
 }
+
+// This tests that TextBuffer tracks per-row mutation ids across writes,
+// circular buffer rotations and resets of the entire buffer.
+void TextBufferTests::RowsModifiedSince()
+{
+    const til::size bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+    const auto initial = buffer.GetLastMutationId();
+    VERIFY_ARE_EQUAL(std::vector<til::CoordType>{}, buffer.GetRowsModifiedSince(initial));
+
+    buffer.GetMutableRowByOffset(1).ReplaceCharacters(0, 1, L"a");
+    buffer.GetMutableRowByOffset(3).ReplaceCharacters(0, 1, L"b");
+    VERIFY_ARE_EQUAL((std::vector<til::CoordType>{ 1, 3 }), buffer.GetRowsModifiedSince(initial));
+    VERIFY_ARE_EQUAL((std::vector<til::CoordType>{ 3 }), buffer.GetRowsModifiedSince(initial, 2, 5));
+
+    const auto afterWrite = buffer.GetLastMutationId();
+    VERIFY_ARE_EQUAL(std::vector<til::CoordType>{}, buffer.GetRowsModifiedSince(afterWrite));
+
+    // Rotating the buffer only modifies the recycled row (now the last one),
+    // while the mutation id of the other rows moves along with them.
+    const auto row3MutationId = buffer.GetRowMutationId(3);
+    buffer.IncrementCircularBuffer();
+    VERIFY_ARE_EQUAL((std::vector<til::CoordType>{ 4 }), buffer.GetRowsModifiedSince(afterWrite));
+    VERIFY_ARE_EQUAL(row3MutationId, buffer.GetRowMutationId(2));
+
+    // Resetting the buffer invalidates all rows, even those that haven't been committed yet.
+    const auto beforeReset = buffer.GetLastMutationId();
+    buffer.Reset();
+    VERIFY_ARE_EQUAL((std::vector<til::CoordType>{ 0, 1, 2, 3, 4 }), buffer.GetRowsModifiedSince(beforeReset));
+
+    // The same applies to resizing the buffer.
+    const auto beforeResize = buffer.GetLastMutationId();
+    buffer.ResizeTraditional({ 10, 3 });
+    VERIFY_ARE_EQUAL((std::vector<til::CoordType>{ 0, 1, 2 }), buffer.GetRowsModifiedSince(beforeResize));
+    VERIFY_IS_GREATER_THAN(buffer.GetLastMutationId(), beforeResize);
+}
+
+void TextBufferTests::FillRectFastPath()
+{
+    WEX::TestExecution::SetVerifyOutput settings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+
+    const til::size bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute textAttr{ 0x7f };
+    const TextAttribute fillAttr{ 0x1e };
+
+    // Each row contains wide glyphs at a different offset, so that the
+    // edges of the filled area intersect them in all possible ways.
+    const auto initialize = [&](TextBuffer& buffer) {
+        for (til::CoordType y = 0; y < bufferSize.height; ++y)
+        {
+            RowWriteState state{
+                .text = L"a\u304bb\u304cc\u304d",
+                .columnBegin = y,
+            };
+            buffer.Write(y, textAttr, state);
+        }
+    };
+
+    // U+00E9 takes the fast path as well. U+0301 (combining) and U+00AD (soft hyphen) don't,
+    // but must still produce the same result as the reference below.
+    for (const auto fill : { std::wstring_view{ L" " }, std::wstring_view{ L"x" }, std::wstring_view{ L"\u00e9" }, std::wstring_view{ L"\u0301" }, std::wstring_view{ L"\u00ad" } })
+    {
+        for (til::CoordType left = 0; left < bufferSize.width; ++left)
+        {
+            for (til::CoordType right = left + 1; right <= bufferSize.width; ++right)
+            {
+                TextBuffer actual{ bufferSize, textAttr, cursorSize, false, _renderer };
+                TextBuffer expected{ bufferSize, textAttr, cursorSize, false, _renderer };
+                initialize(actual);
+                initialize(expected);
+
+                actual.FillRect({ left, 0, right, bufferSize.height }, fill, fillAttr);
+
+                for (til::CoordType y = 0; y < bufferSize.height; ++y)
+                {
+                    // This is what FillRect() does without the fast path.
+                    auto& expectedRow = expected.GetMutableRowByOffset(y);
+                    RowWriteState state{
+                        .columnLimit = right,
+                        .columnEnd = left,
+                    };
+                    while (state.columnEnd < right)
+                    {
+                        state.columnBegin = state.columnEnd;
+                        state.text = fill;
+                        expectedRow.ReplaceText(state);
+                    }
+                    expectedRow.ReplaceAttributes(left, right, fillAttr);
+
+                    const auto& actualRow = actual.GetRowByOffset(y);
+                    VERIFY_ARE_EQUAL(expectedRow.GetText(), actualRow.GetText());
+                    VERIFY_ARE_EQUAL(expectedRow.WasDoubleBytePadded(), actualRow.WasDoubleBytePadded());
+                    for (til::CoordType x = 0; x < bufferSize.width; ++x)
+                    {
+                        VERIFY_ARE_EQUAL(expectedRow.GlyphAt(x), actualRow.GlyphAt(x));
+                        VERIFY_IS_TRUE(expectedRow.DbcsAttrAt(x) == actualRow.DbcsAttrAt(x));
+                        VERIFY_ARE_EQUAL(expectedRow.GetAttrByColumn(x), actualRow.GetAttrByColumn(x));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void TextBufferTests::FillRectPerformance()
+{
+    // Simulates a TUI that clears the screen (ED) or the right half of each line (EL)
+    // before every frame, on a large 400x120 screen.
+
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 400, 120 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+    const std::wstring line(bufferSize.width, L'#');
+    static constexpr auto iterations = 1000;
+
+    const auto measure = [&](const wchar_t* name, auto&& func) {
+        using namespace std::chrono;
+
+        nanoseconds total{};
+
+        for (auto i = 0; i < iterations; ++i)
+        {
+            // Fill the screen with text so that there's something to erase.
+            for (til::CoordType y = 0; y < bufferSize.height; ++y)
+            {
+                RowWriteState state{ .text = line };
+                buffer.Write(y, attr, state);
+            }
+
+            const auto beg = steady_clock::now();
+            func();
+            total += steady_clock::now() - beg;
+        }
+
+        Log::Comment(NoThrowString().Format(L"%s: %d calls took %lld us. Avg %lld us per call", name, iterations, duration_cast<microseconds>(total).count(), duration_cast<microseconds>(total / iterations).count()));
+    };
+
+    measure(L"ED 2", [&]() {
+        buffer.FillRect({ 0, 0, bufferSize.width, bufferSize.height }, L" ", attr);
+    });
+    measure(L"EL 0", [&]() {
+        for (til::CoordType y = 0; y < bufferSize.height; ++y)
+        {
+            buffer.FillRect({ bufferSize.width / 2, y, bufferSize.width, y + 1 }, L" ", attr);
+        }
+    });
+    measure(L"DECFRA", [&]() {
+        buffer.FillRect({ 10, 10, bufferSize.width - 10, bufferSize.height - 10 }, L"x", attr);
+    });
+}
+
+void TextBufferTests::ScrollMarksAreAnchored()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+    const auto makeMark = [](til::CoordType y) {
+        ScrollMark mark;
+        mark.start = { 0, y };
+        mark.end = { 2, y };
+        return mark;
+    };
+
+    buffer.StartPromptMark(makeMark(2));
+    buffer.AddMark(makeMark(5));
+    buffer.StartPromptMark(makeMark(8));
+    buffer.AddMark(makeMark(1));
+    buffer.SetCurrentCommandEnd({ 4, 8 });
+
+    // Marks are sorted by their start, independent of the order they were added in.
+    auto marks = buffer.GetMarks();
+    VERIFY_ARE_EQUAL(4u, marks.size());
+    VERIFY_ARE_EQUAL(1, marks[0].start.y);
+    VERIFY_ARE_EQUAL(2, marks[1].start.y);
+    VERIFY_ARE_EQUAL(5, marks[2].start.y);
+    VERIFY_ARE_EQUAL(8, marks[3].start.y);
+    VERIFY_ARE_EQUAL((til::point{ 4, 8 }), *marks[3].commandEnd);
+
+    Log::Comment(L"Scrolling moves all the coordinates of a mark and drops the ones that left the buffer.");
+    buffer.ScrollMarks(-3);
+    marks = buffer.GetMarks();
+    VERIFY_ARE_EQUAL(2u, marks.size());
+    VERIFY_ARE_EQUAL((til::point{ 0, 2 }), marks[0].start);
+    VERIFY_ARE_EQUAL((til::point{ 2, 2 }), marks[0].end);
+    VERIFY_ARE_EQUAL((til::point{ 0, 5 }), marks[1].start);
+    VERIFY_ARE_EQUAL((til::point{ 2, 5 }), marks[1].end);
+    VERIFY_ARE_EQUAL((til::point{ 4, 5 }), *marks[1].commandEnd);
+
+    // The current prompt is still the mark that was started last.
+    buffer.SetCurrentOutputEnd({ 0, 6 }, MarkCategory::Success);
+    marks = buffer.GetMarks();
+    VERIFY_ARE_EQUAL((til::point{ 0, 6 }), *marks[1].outputEnd);
+    VERIFY_IS_FALSE(marks[0].outputEnd.has_value());
+
+    Log::Comment(L"Clearing a range removes the marks that start or end within it.");
+    buffer.StartPromptMark(makeMark(7));
+    auto userMark = makeMark(3);
+    userMark.end = { 0, 5 };
+    buffer.AddMark(userMark);
+    buffer.ClearMarksInRange({ 0, 5 }, { 79, 5 });
+    marks = buffer.GetMarks();
+    VERIFY_ARE_EQUAL(2u, marks.size());
+    VERIFY_ARE_EQUAL(2, marks[0].start.y);
+    VERIFY_ARE_EQUAL(7, marks[1].start.y);
+
+    buffer.SetCurrentPromptEnd({ 3, 7 });
+    VERIFY_ARE_EQUAL((til::point{ 3, 7 }), buffer.GetMarks()[1].end);
+
+    Log::Comment(L"Scrolling down drops the marks that moved past the bottom of the buffer.");
+    buffer.ScrollMarks(3);
+    marks = buffer.GetMarks();
+    VERIFY_ARE_EQUAL(1u, marks.size());
+    VERIFY_ARE_EQUAL(5, marks[0].start.y);
+
+    buffer.ScrollMarks(-bufferSize.height);
+    VERIFY_IS_FALSE(buffer.HasMarks());
+    VERIFY_IS_FALSE(buffer.GetCurrentPromptMark().has_value());
+
+    Log::Comment(L"The current prompt is found even if a mark was added below it.");
+    buffer.StartPromptMark(makeMark(3));
+    buffer.AddMark(makeMark(6));
+    VERIFY_ARE_EQUAL(6, buffer.GetMarks()[1].start.y);
+    VERIFY_ARE_EQUAL(3, buffer.GetCurrentPromptMark()->start.y);
+
+    Log::Comment(L"Marks added by the UI never become the current prompt, even if they're the only ones left.");
+    buffer.ClearMarksInRange({ 0, 3 }, { 79, 3 });
+    VERIFY_ARE_EQUAL(1u, buffer.GetMarks().size());
+    VERIFY_IS_FALSE(buffer.HasCurrentPromptMark());
+    VERIFY_IS_FALSE(buffer.GetCurrentPromptMark().has_value());
+    buffer.SetCurrentPromptEnd({ 5, 6 });
+    buffer.SetCurrentCommandEnd({ 6, 6 });
+    buffer.SetCurrentOutputEnd({ 0, 7 }, MarkCategory::Error);
+    marks = buffer.GetMarks();
+    VERIFY_ARE_EQUAL((til::point{ 2, 6 }), marks[0].end);
+    VERIFY_IS_FALSE(marks[0].commandEnd.has_value());
+    VERIFY_IS_FALSE(marks[0].outputEnd.has_value());
+    VERIFY_IS_TRUE(marks[0].category == MarkCategory::Info);
+    VERIFY_IS_TRUE(buffer.CurrentCommand().empty());
+}
+
+void TextBufferTests::ReplaceAttributesInSpans()
+{
+    const til::size bufferSize{ 10, 4 };
+    const UINT cursorSize = 12;
+    const TextAttribute textAttr{ 0x7f };
+    const TextAttribute colorAttr{ 0x1e };
+
+    TextBuffer actual{ bufferSize, textAttr, cursorSize, false, _renderer };
+    TextBuffer expected{ bufferSize, textAttr, cursorSize, false, _renderer };
+
+    // Spans within a row, across the end of a row, across multiple rows and across the end of the buffer.
+    const std::array<til::point_span, 4> spans{ {
+        { { 1, 0 }, { 3, 0 } },
+        { { 8, 0 }, { 1, 1 } },
+        { { 5, 1 }, { 2, 3 } },
+        { { 9, 3 }, { 5, 5 } },
+    } };
+
+    actual.ReplaceAttributes(spans, colorAttr);
+
+    // This is how spans used to be colored.
+    for (const auto& span : spans)
+    {
+        const auto end = std::min(span.end, til::point{ bufferSize.width - 1, bufferSize.height - 1 });
+        expected.Write(OutputCellIterator(colorAttr, expected.SpanLength(span.start, end)), span.start);
+    }
+
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        const auto& expectedRow = expected.GetRowByOffset(y);
+        const auto& actualRow = actual.GetRowByOffset(y);
+        for (til::CoordType x = 0; x < bufferSize.width; ++x)
+        {
+            VERIFY_ARE_EQUAL(expectedRow.GetAttrByColumn(x), actualRow.GetAttrByColumn(x));
+        }
+    }
+}
+
+void TextBufferTests::ReplaceAttributesInSpansPerformance()
+{
+    // Simulates coloring all occurrences of a common token in a large scrollback.
+
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 120, 1000 };
+    const UINT cursorSize = 12;
+    const TextAttribute textAttr{ 0x07 };
+    const TextAttribute colorAttr{ 0x1e };
+    TextBuffer buffer{ bufferSize, textAttr, cursorSize, false, _renderer };
+
+    std::wstring line;
+    while (line.size() < gsl::narrow_cast<size_t>(bufferSize.width))
+    {
+        line.append(L"foo bar ");
+    }
+    line.resize(bufferSize.width);
+
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        RowWriteState state{ .text = line };
+        buffer.Write(y, textAttr, state);
+    }
+
+    auto hits = buffer.SearchText(L"foo", true);
+    hits.resize(std::min<size_t>(hits.size(), 10000));
+    VERIFY_ARE_EQUAL(10000u, hits.size());
+
+    static constexpr auto iterations = 10;
+
+    const auto measure = [&](const wchar_t* name, auto&& func) {
+        using namespace std::chrono;
+
+        nanoseconds total{};
+
+        for (auto i = 0; i < iterations; ++i)
+        {
+            const auto beg = steady_clock::now();
+            func();
+            total += steady_clock::now() - beg;
+        }
+
+        Log::Comment(NoThrowString().Format(L"%s: %d calls took %lld us. Avg %lld us per call", name, iterations, duration_cast<microseconds>(total).count(), duration_cast<microseconds>(total / iterations).count()));
+    };
+
+    measure(L"Write", [&]() {
+        for (const auto& s : hits)
+        {
+            buffer.Write(OutputCellIterator(colorAttr, buffer.SpanLength(s.start, s.end)), s.start);
+        }
+    });
+    measure(L"ReplaceAttributes", [&]() {
+        buffer.ReplaceAttributes(hits, colorAttr);
+    });
+}
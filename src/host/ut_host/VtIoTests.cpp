@@ -392,6 +392,11 @@ public:
     {
         return {};
     }
+
+    std::span<const interval_tree::IntervalTree<til::point, size_t>::interval> GetPatternIntervalsInRow(const til::CoordType /*row*/) const
+    {
+        return {};
+    }
 };
 
 void VtIoTests::RendererDtorAndThread()
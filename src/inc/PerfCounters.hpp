@@ -0,0 +1,357 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- PerfCounters.hpp
+
+Abstract:
+- Counters and histograms for the hot paths of the parser, the text buffer, the renderer
+  and the terminal core. Unlike the ETW providers they're cheap enough to be left on during
+  benchmarks and they're meant to be read by the process itself, for instance by a test.
+- They're compiled out unless CONSOLE_PERF_COUNTERS is 1, which is what
+  msbuild /p:OpenConsoleEnablePerfCounters=true does for the entire solution.
+  The probe macros then expand to nothing and TakeSnapshot() returns zeroes.
+  Each setting has its own inline namespace, so translation units that disagree on it
+  can still be linked into the same binary (like the unit tests). They don't share counters.
+- Every thread increments its own set of counters with plain (relaxed) loads and stores.
+  Only registering a thread and taking a snapshot take a lock.
+- Probes use the names from PERF_COUNTERS and PERF_HISTOGRAMS:
+    PERF_COUNTER_ADD(ParserCodeUnits, string.size());
+    PERF_HISTOGRAM_RECORD(ParserStringLength, string.size());
+    PERF_HISTOGRAM_SCOPED_DURATION(RendererFrameDuration);
+--*/
+
+#pragma once
+
+#include <bit>
+
+#ifndef CONSOLE_PERF_COUNTERS
+#define CONSOLE_PERF_COUNTERS 0
+#endif
+
+// clang-format off
+#define PERF_COUNTERS(X)            \
+    X(ParserStrings)                \
+    X(ParserCodeUnits)              \
+    X(ParserPrintedCodeUnits)       \
+    X(ParserExecutes)               \
+    X(ParserEscDispatches)          \
+    X(ParserCsiDispatches)          \
+    X(ParserOscDispatches)          \
+    X(ParserDcsDispatches)          \
+    X(ParserSs3Dispatches)          \
+    X(ParserVt52Dispatches)         \
+    X(BufferRowsWritten)            \
+    X(BufferRowsScrolled)           \
+    X(BufferCircularIncrements)     \
+    X(BufferReflows)                \
+    X(RendererFrames)               \
+    X(RendererDirtyRows)            \
+    X(RendererClusters)
+
+// Histograms of durations are in nanoseconds. The RendererArena ones are recorded once per frame.
+#define PERF_HISTOGRAMS(X)          \
+    X(ParserStringLength)           \
+    X(RendererFrameDuration)        \
+    X(RendererArenaAllocations)     \
+    X(RendererArenaBytes)           \
+    X(TerminalLockWait)
+// clang-format on
+
+#if CONSOLE_PERF_COUNTERS
+#define PERF_COUNTERS_INLINE_NAMESPACE Instrumented
+#else
+#define PERF_COUNTERS_INLINE_NAMESPACE Uninstrumented
+#endif
+
+namespace Microsoft::Console::PerfCounters::inline PERF_COUNTERS_INLINE_NAMESPACE
+{
+    inline constexpr bool Enabled = CONSOLE_PERF_COUNTERS != 0;
+
+#define PERF_ENUM_ENTRY(name) name,
+    enum class Counter : size_t
+    {
+        PERF_COUNTERS(PERF_ENUM_ENTRY)
+    };
+
+    enum class Histogram : size_t
+    {
+        PERF_HISTOGRAMS(PERF_ENUM_ENTRY)
+    };
+#undef PERF_ENUM_ENTRY
+
+#define PERF_NAME_ENTRY(name) #name,
+    inline constexpr std::string_view CounterNames[]{ PERF_COUNTERS(PERF_NAME_ENTRY) };
+    inline constexpr std::string_view HistogramNames[]{ PERF_HISTOGRAMS(PERF_NAME_ENTRY) };
+#undef PERF_NAME_ENTRY
+
+    inline constexpr size_t CounterCount = std::size(CounterNames);
+    inline constexpr size_t HistogramCount = std::size(HistogramNames);
+    // Bucket i holds the values with a std::bit_width of i, that is [2^(i-1), 2^i).
+    inline constexpr size_t BucketCount = 65;
+
+    struct HistogramSnapshot
+    {
+        std::array<uint64_t, BucketCount> buckets{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+
+        // Returns an upper bound for the given percentile (0 to 1), accurate to a factor of 2.
+        uint64_t Percentile(const double percentile) const noexcept
+        {
+            const auto target = static_cast<uint64_t>(std::ceil(percentile * count));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BucketCount; ++i)
+            {
+                seen += buckets[i];
+                if (seen && seen >= target)
+                {
+                    return i == 0 ? 0 : i == 64 ? UINT64_MAX : (uint64_t{ 1 } << i) - 1;
+                }
+            }
+            return 0;
+        }
+    };
+
+    struct Snapshot
+    {
+        std::array<uint64_t, CounterCount> counters{};
+        std::array<HistogramSnapshot, HistogramCount> histograms{};
+
+        uint64_t operator[](const Counter counter) const noexcept
+        {
+            return til::at(counters, static_cast<size_t>(counter));
+        }
+
+        const HistogramSnapshot& operator[](const Histogram histogram) const noexcept
+        {
+            return til::at(histograms, static_cast<size_t>(histogram));
+        }
+    };
+
+    namespace details
+    {
+        using Cell = std::atomic<uint64_t>;
+
+        // Only the owning thread writes to a cell, so it doesn't need a (slower) atomic read-modify-write.
+        inline void Bump(Cell& cell, const uint64_t value) noexcept
+        {
+            cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        struct HistogramCells
+        {
+            std::array<Cell, BucketCount> buckets{};
+            Cell count{};
+            Cell sum{};
+        };
+
+        struct ThreadCells
+        {
+            std::array<Cell, CounterCount> counters{};
+            std::array<HistogramCells, HistogramCount> histograms{};
+
+            // Adds the current values to the snapshot. Can be called from any thread.
+            void AddTo(Snapshot& snapshot) const noexcept
+            {
+                for (size_t i = 0; i < CounterCount; ++i)
+                {
+                    snapshot.counters[i] += counters[i].load(std::memory_order_relaxed);
+                }
+                for (size_t i = 0; i < HistogramCount; ++i)
+                {
+                    auto& dst = snapshot.histograms[i];
+                    const auto& src = histograms[i];
+                    for (size_t j = 0; j < BucketCount; ++j)
+                    {
+                        dst.buckets[j] += src.buckets[j].load(std::memory_order_relaxed);
+                    }
+                    dst.count += src.count.load(std::memory_order_relaxed);
+                    dst.sum += src.sum.load(std::memory_order_relaxed);
+                }
+            }
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<const ThreadCells*> threads;
+            // The counts of threads that have exited.
+            Snapshot exited;
+            // The counts at the time of the last Reset().
+            Snapshot baseline;
+        };
+
+        // The registry is leaked on purpose, so that threads can still unregister during process shutdown.
+        inline Registry& GetRegistry()
+        {
+#pragma warning(suppress : 26409) // Avoid calling new and delete explicitly, use std::make_unique<T> instead (r.11).
+            static auto& registry = *new Registry;
+            return registry;
+        }
+
+        struct ThreadRegistration
+        {
+            ThreadCells cells;
+
+            // If registering fails, the counts of this thread are only reported once it exits.
+            ThreadRegistration() noexcept
+            {
+                try
+                {
+                    auto& registry = GetRegistry();
+                    const std::lock_guard lock{ registry.mutex };
+                    registry.threads.emplace_back(&cells);
+                }
+                CATCH_LOG();
+            }
+
+            ~ThreadRegistration()
+            {
+                auto& registry = GetRegistry();
+                const std::lock_guard lock{ registry.mutex };
+                cells.AddTo(registry.exited);
+                std::erase(registry.threads, &cells);
+            }
+
+            ThreadRegistration(const ThreadRegistration&) = delete;
+            ThreadRegistration& operator=(const ThreadRegistration&) = delete;
+        };
+
+        inline ThreadCells& GetThreadCells() noexcept
+        {
+            thread_local ThreadRegistration registration;
+            return registration.cells;
+        }
+
+        inline Snapshot SumLocked(Registry& registry) noexcept
+        {
+            auto snapshot = registry.exited;
+            for (const auto cells : registry.threads)
+            {
+                cells->AddTo(snapshot);
+            }
+            return snapshot;
+        }
+    }
+
+    inline void Add(const Counter counter, const uint64_t value) noexcept
+    {
+        details::Bump(til::at(details::GetThreadCells().counters, static_cast<size_t>(counter)), value);
+    }
+
+    inline void Record(const Histogram histogram, const uint64_t value) noexcept
+    {
+        auto& cells = til::at(details::GetThreadCells().histograms, static_cast<size_t>(histogram));
+        details::Bump(til::at(cells.buckets, std::bit_width(value)), 1);
+        details::Bump(cells.count, 1);
+        details::Bump(cells.sum, value);
+    }
+
+    // Records the lifetime of the object into a histogram, in nanoseconds.
+    class ScopedDuration
+    {
+    public:
+        explicit ScopedDuration(const Histogram histogram) noexcept :
+            _histogram{ histogram },
+            _start{ std::chrono::steady_clock::now() }
+        {
+        }
+
+        ~ScopedDuration()
+        {
+            const auto duration = std::chrono::steady_clock::now() - _start;
+            Record(_histogram, gsl::narrow_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+        }
+
+        ScopedDuration(const ScopedDuration&) = delete;
+        ScopedDuration& operator=(const ScopedDuration&) = delete;
+
+    private:
+        Histogram _histogram;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    // Returns the counts of all threads since the last call to Reset().
+    inline Snapshot TakeSnapshot()
+    {
+        Snapshot snapshot;
+        if constexpr (Enabled)
+        {
+            auto& registry = details::GetRegistry();
+            const std::lock_guard lock{ registry.mutex };
+            snapshot = details::SumLocked(registry);
+
+            for (size_t i = 0; i < CounterCount; ++i)
+            {
+                snapshot.counters[i] -= registry.baseline.counters[i];
+            }
+            for (size_t i = 0; i < HistogramCount; ++i)
+            {
+                auto& dst = snapshot.histograms[i];
+                const auto& base = registry.baseline.histograms[i];
+                for (size_t j = 0; j < BucketCount; ++j)
+                {
+                    dst.buckets[j] -= base.buckets[j];
+                }
+                dst.count -= base.count;
+                dst.sum -= base.sum;
+            }
+        }
+        return snapshot;
+    }
+
+    // Counting continues uninterrupted: Reset() only remembers the current counts,
+    // so that TakeSnapshot() can subtract them. This keeps the probes free of locks.
+    inline void Reset()
+    {
+        if constexpr (Enabled)
+        {
+            auto& registry = details::GetRegistry();
+            const std::lock_guard lock{ registry.mutex };
+            registry.baseline = details::SumLocked(registry);
+        }
+    }
+
+    // Formats the snapshot as a table, skipping everything that's zero.
+    inline std::string FormatSnapshot(const Snapshot& snapshot)
+    {
+        std::string out;
+        for (size_t i = 0; i < CounterCount; ++i)
+        {
+            if (const auto value = snapshot.counters[i])
+            {
+                fmt::format_to(std::back_inserter(out), FMT_COMPILE("{:<28} {:>14}\n"), CounterNames[i], value);
+            }
+        }
+        for (size_t i = 0; i < HistogramCount; ++i)
+        {
+            const auto& histogram = snapshot.histograms[i];
+            if (histogram.count)
+            {
+                fmt::format_to(std::back_inserter(out),
+                               FMT_COMPILE("{:<28} {:>14} samples, mean {}, p50 <= {}, p99 <= {}, max <= {}\n"),
+                               HistogramNames[i],
+                               histogram.count,
+                               histogram.sum / histogram.count,
+                               histogram.Percentile(0.5),
+                               histogram.Percentile(0.99),
+                               histogram.Percentile(1.0));
+            }
+        }
+        return out;
+    }
+}
+
+#undef PERF_COUNTERS_INLINE_NAMESPACE
+
+#if CONSOLE_PERF_COUNTERS
+#define PERF_COUNTER_ADD(name, value) ::Microsoft::Console::PerfCounters::Add(::Microsoft::Console::PerfCounters::Counter::name, gsl::narrow_cast<uint64_t>(value))
+#define PERF_HISTOGRAM_RECORD(name, value) ::Microsoft::Console::PerfCounters::Record(::Microsoft::Console::PerfCounters::Histogram::name, gsl::narrow_cast<uint64_t>(value))
+#define PERF_HISTOGRAM_SCOPED_DURATION(name) const ::Microsoft::Console::PerfCounters::ScopedDuration _perfScopedDuration##name{ ::Microsoft::Console::PerfCounters::Histogram::name }
+#else
+#define PERF_COUNTER_ADD(name, value)
+#define PERF_HISTOGRAM_RECORD(name, value)
+#define PERF_HISTOGRAM_SCOPED_DURATION(name)
+#endif
@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "atomic.h"
+#include "recursive_lock.h"
+
+namespace til
+{
+    // adaptive_lock is an unfair lock with bounded unfairness: Threads spin briefly before
+    // they go to sleep with WaitOnAddress and a thread releasing the lock doesn't hand it over
+    // to a specific waiter. This makes it a lot faster than ticket_lock when one thread
+    // locks and unlocks it in a tight loop (for instance the VT parser, which acquires the lock
+    // once per chunk of output), because it can immediately reacquire the lock, instead of
+    // waiting until all other threads had their turn, which costs 2 context switches each.
+    //
+    // To prevent the other threads from starving, a waiter that didn't get the lock for longer than
+    // starvation_threshold switches the lock into a "starving" mode. New arrivals then stop
+    // barging in and the lock is only passed around between the waiters until the starving
+    // thread got its turn. The worst case latency is thus roughly that of a fair lock.
+    //
+    // Since a plain unlock() + lock() pair lets the releasing thread barge right back in,
+    // a thread that wants to give others a turn while holding the lock must use yield().
+    //
+    // The same caveats as for ticket_lock apply: Always use std::unique_lock or similar.
+    //
+    // Terminal still uses recursive_ticket_lock. Switching it over needs measurements on Windows first,
+    // which show that the UI thread's LockForWriting() isn't held up any longer than with the fair lock.
+    struct adaptive_lock
+    {
+        // The number of times lock() checks the state before it goes to sleep.
+        // Each check takes about 100-150 cycles on current x64 CPUs, due to the pause instruction.
+        static constexpr uint32_t spin_count = 128;
+        static constexpr std::chrono::microseconds starvation_threshold{ 1000 };
+
+        void lock() noexcept
+        {
+            auto state = _state.load(std::memory_order_relaxed);
+            if ((state & (locked | starving | handoff)) == 0 && _state.compare_exchange_weak(state, state | locked, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return;
+            }
+            _lock_slow();
+        }
+
+        bool try_lock() noexcept
+        {
+            auto state = _state.load(std::memory_order_relaxed);
+            return (state & (locked | starving | handoff)) == 0 && _state.compare_exchange_strong(state, state | locked, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() noexcept
+        {
+            const auto state = _state.fetch_sub(locked, std::memory_order_release) - locked;
+            _wake_waiters(state);
+        }
+
+        // Gives every thread that's sleeping in lock() at the time of the call one turn, before
+        // reacquiring the lock. Threads that arrive in the meantime don't count, so a steady stream
+        // of new arrivals can't keep the caller out forever. The caller must hold the lock.
+        void yield() noexcept
+        {
+            for (auto rounds = _state.load(std::memory_order_relaxed) / waiter; rounds && _handoff(); --rounds)
+            {
+            }
+        }
+
+    private:
+        // The lowest bit is set while the lock is held, the second one while a waiter is starving
+        // and the third one while _handoff() waits for a waiter to take the lock. The remaining
+        // bits count the threads in the sleeping part of _lock_slow().
+        static constexpr uint32_t locked = 1;
+        static constexpr uint32_t starving = 2;
+        static constexpr uint32_t handoff = 4;
+        static constexpr uint32_t waiter = 8;
+
+        // Releases the lock and reacquires it after one of the sleeping waiters got it.
+        // Returns false without releasing the lock if there aren't any.
+        bool _handoff() noexcept
+        {
+            auto state = _state.load(std::memory_order_relaxed);
+            do
+            {
+                if (state < waiter)
+                {
+                    return false;
+                }
+            } while (!_state.compare_exchange_weak(state, (state & ~locked) | handoff, std::memory_order_release, std::memory_order_relaxed));
+
+            state = (state & ~locked) | handoff;
+            _wake_waiters(state);
+
+            // The waiter that takes the lock clears the handoff bit and wakes us up.
+            // We aren't counted as a waiter ourselves, so we can't take it in the meantime.
+            do
+            {
+                til::atomic_wait(_state, state);
+                state = _state.load(std::memory_order_relaxed);
+            } while (state & handoff);
+
+            lock();
+            return true;
+        }
+
+        void _wake_waiters(uint32_t state) noexcept
+        {
+            if (state >= waiter)
+            {
+                // In the starving mode only the starving waiter may take the lock,
+                // but we don't know which one it is. Those that aren't will go back to sleep.
+                if (state & starving)
+                {
+                    til::atomic_notify_all(_state);
+                }
+                else
+                {
+                    til::atomic_notify_one(_state);
+                }
+            }
+        }
+
+        __declspec(noinline) void _lock_slow() noexcept
+        {
+            // Spinning only makes sense as long as we're allowed to barge in. As soon as there
+            // are waiters, the lock is most likely held for longer than a few microseconds anyway.
+            for (uint32_t i = 0; i < spin_count; ++i)
+            {
+                auto state = _state.load(std::memory_order_relaxed);
+                if (state & ~locked)
+                {
+                    break;
+                }
+                if (state == 0 && _state.compare_exchange_weak(state, locked, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return;
+                }
+                YieldProcessor();
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            auto isStarving = false;
+            auto state = _state.fetch_add(waiter, std::memory_order_relaxed) + waiter;
+
+            for (;;)
+            {
+                if ((state & locked) == 0 && (isStarving || (state & starving) == 0))
+                {
+                    // A starving waiter resets the starving mode once it got the lock. If there's
+                    // another starving waiter, it'll set it again the next time it wakes up.
+                    auto desired = ((state | locked) - waiter) & ~handoff;
+                    if (isStarving)
+                    {
+                        desired &= ~starving;
+                    }
+                    if (_state.compare_exchange_weak(state, desired, std::memory_order_acquire, std::memory_order_relaxed))
+                    {
+                        // The yielding thread sleeps on the same address.
+                        if (state & handoff)
+                        {
+                            til::atomic_notify_all(_state);
+                        }
+                        return;
+                    }
+                    continue;
+                }
+
+                if (!isStarving && std::chrono::steady_clock::now() - start > starvation_threshold)
+                {
+                    isStarving = true;
+                }
+                if (isStarving && (state & starving) == 0)
+                {
+                    state = _state.fetch_or(starving, std::memory_order_relaxed) | starving;
+                    continue;
+                }
+
+                til::atomic_wait(_state, state);
+                state = _state.load(std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<uint32_t> _state{ 0 };
+    };
+
+    using recursive_adaptive_lock = recursive_lock<adaptive_lock>;
+    using recursive_adaptive_lock_suspension = recursive_adaptive_lock::suspension;
+}
@@ -70,4 +70,141 @@ namespace til::pmr
         return std::pmr::get_default_resource();
     }
 #endif
+
+    // arena is a monotonic memory resource for allocations that share the same short
+    // lifetime, like the temporaries needed to paint a single frame. Deallocating
+    // is a no-op and reset() frees everything that was allocated at once.
+    //
+    // Unlike std::pmr::monotonic_buffer_resource it keeps its memory across reset()s.
+    // If the last cycle needed more than one block, reset() frees them and the next
+    // allocation gets a single block that's as large as all of them combined.
+    // Once the arena went through its largest cycle, it stops allocating from upstream.
+    class arena : public std::pmr::memory_resource
+    {
+    public:
+        explicit arena(const size_t initialSize = 16 * 1024, std::pmr::memory_resource* const upstream = get_default_resource()) noexcept :
+            _upstream{ upstream },
+            _nextSize{ initialSize }
+        {
+        }
+
+        ~arena() override
+        {
+            _freeBlocks();
+        }
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        // Invalidates everything that was allocated since the last reset().
+        void reset() noexcept
+        {
+            if (_head && _head->next)
+            {
+                size_t total = 0;
+                for (auto b = _head; b; b = b->next)
+                {
+                    total += b->size;
+                }
+                _freeBlocks();
+                _nextSize = total;
+            }
+            else if (_head)
+            {
+                _current = _head->data();
+            }
+
+            _bytesUsed = 0;
+            _upstreamAllocations = 0;
+        }
+
+        // The number of blocks that were allocated from upstream since the last reset().
+        size_t upstream_allocations() const noexcept
+        {
+            return _upstreamAllocations;
+        }
+
+        // The number of bytes that were allocated since the last reset(), not counting padding.
+        size_t bytes_used() const noexcept
+        {
+            return _bytesUsed;
+        }
+
+    private:
+        struct alignas(std::max_align_t) block
+        {
+            block* next;
+            // The size of the entire block, including this header.
+            size_t size;
+
+            std::byte* data() noexcept
+            {
+                return reinterpret_cast<std::byte*>(this + 1);
+            }
+        };
+
+        static std::byte* _align(std::byte* const ptr, const size_t alignment) noexcept
+        {
+            const auto value = reinterpret_cast<uintptr_t>(ptr);
+            return reinterpret_cast<std::byte*>((value + alignment - 1) & ~(alignment - 1));
+        }
+
+        void* do_allocate(const size_t bytes, const size_t alignment) override
+        {
+            auto ptr = _align(_current, alignment);
+            if (!_head || ptr > _end || bytes > static_cast<size_t>(_end - ptr))
+            {
+                _grow(bytes + alignment);
+                ptr = _align(_current, alignment);
+            }
+
+            _current = ptr + bytes;
+            _bytesUsed += bytes;
+            return ptr;
+        }
+
+        void do_deallocate(void* const /*ptr*/, const size_t /*bytes*/, const size_t /*alignment*/) noexcept override
+        {
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        void _grow(const size_t minimum)
+        {
+            const auto size = std::max(_nextSize, minimum + sizeof(block));
+            const auto b = new (_upstream->allocate(size, alignof(block))) block{ _head, size };
+
+            _head = b;
+            _current = b->data();
+            _end = reinterpret_cast<std::byte*>(b) + size;
+            // Within a cycle the blocks grow geometrically, so that only few of them are needed.
+            _nextSize = size * 2;
+            _upstreamAllocations++;
+        }
+
+        void _freeBlocks() noexcept
+        {
+            for (auto b = _head; b;)
+            {
+                const auto next = b->next;
+                _upstream->deallocate(b, b->size, alignof(block));
+                b = next;
+            }
+
+            _head = nullptr;
+            _current = nullptr;
+            _end = nullptr;
+        }
+
+        std::pmr::memory_resource* _upstream;
+        block* _head = nullptr;
+        std::byte* _current = nullptr;
+        std::byte* _end = nullptr;
+        size_t _nextSize = 0;
+        size_t _bytesUsed = 0;
+        size_t _upstreamAllocations = 0;
+    };
 }
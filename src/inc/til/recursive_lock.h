@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+namespace til
+{
+    // recursive_lock turns any non-recursive lock (like ticket_lock or adaptive_lock) into a recursive one.
+    // Additionally, it allows the owning thread to temporarily give up the lock via suspend().
+    template<typename Lock>
+    struct recursive_lock
+    {
+        struct suspension
+        {
+            constexpr suspension(recursive_lock& lock, uint32_t owner, uint32_t recursion) noexcept :
+                _lock{ lock },
+                _owner{ owner },
+                _recursion{ recursion }
+            {
+            }
+
+            // When this class is destroyed it restores the recursive_lock state.
+            // This of course only works if the lock wasn't moved to another thread or something.
+            suspension(const suspension&) = delete;
+            suspension& operator=(const suspension&) = delete;
+            suspension(suspension&&) = delete;
+            suspension& operator=(suspension&&) = delete;
+
+            ~suspension()
+            {
+                if (_owner)
+                {
+                    // If someone reacquired the lock on the current thread, we shouldn't lock it again.
+                    if (_lock._owner.load(std::memory_order_relaxed) != _owner)
+                    {
+                        _lock._lock.lock(); // lock-lock-lock lol
+                        _lock._owner.store(_owner, std::memory_order_relaxed);
+                    }
+                    // ...but we should restore the original recursion count.
+                    _lock._recursion += _recursion;
+                }
+            }
+
+        private:
+            friend struct recursive_lock;
+
+            recursive_lock& _lock;
+            uint32_t _owner = 0;
+            uint32_t _recursion = 0;
+        };
+
+        void lock() noexcept
+        {
+            const auto id = GetCurrentThreadId();
+
+            if (_owner.load(std::memory_order_relaxed) != id)
+            {
+                _lock.lock();
+                _owner.store(id, std::memory_order_relaxed);
+            }
+
+            _recursion++;
+        }
+
+        void unlock() noexcept
+        {
+            if (--_recursion == 0)
+            {
+                _owner.store(0, std::memory_order_relaxed);
+                _lock.unlock();
+            }
+        }
+
+        [[nodiscard]] suspension suspend() noexcept
+        {
+            const auto id = GetCurrentThreadId();
+            uint32_t owner = 0;
+            uint32_t recursion = 0;
+
+            if (_owner.load(std::memory_order_relaxed) == id)
+            {
+                owner = id;
+                recursion = _recursion;
+                _owner.store(0, std::memory_order_relaxed);
+                _recursion = 0;
+                _lock.unlock();
+            }
+
+            return { *this, owner, recursion };
+        }
+
+        // Unlike suspend(), this lets threads that are already waiting for the lock go first.
+        // Only available if the underlying lock has a yield() method (like adaptive_lock).
+        void yield() noexcept
+        {
+            const auto id = GetCurrentThreadId();
+
+            if (_owner.load(std::memory_order_relaxed) == id)
+            {
+                const auto recursion = _recursion;
+                _owner.store(0, std::memory_order_relaxed);
+                _recursion = 0;
+                _lock.yield();
+                _owner.store(id, std::memory_order_relaxed);
+                _recursion = recursion;
+            }
+        }
+
+        uint32_t is_locked() const noexcept
+        {
+            const auto id = GetCurrentThreadId();
+            return _owner.load(std::memory_order_relaxed) == id;
+        }
+
+        uint32_t recursion_depth() const noexcept
+        {
+            return is_locked() ? _recursion : 0;
+        }
+
+    private:
+        Lock _lock;
+        std::atomic<uint32_t> _owner = 0;
+        uint32_t _recursion = 0;
+    };
+}
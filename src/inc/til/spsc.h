@@ -278,6 +278,32 @@ namespace til::spsc
                 release(_consumer, acquisition);
             }
 
+            // The batch APIs (reserve/commit and peek/release) may release fewer slots than they acquired.
+            // shrink returns an acquisition of just the first count slots of the given one.
+            acquisition shrink(acquisition acquisition, size_type count) const noexcept
+            {
+                const auto end = acquisition.begin + count;
+                if (end == acquisition.end)
+                {
+                    return acquisition;
+                }
+
+                // Since end < acquisition.end <= _capacity, the shrunk range never wraps around
+                // the ring buffer and "next" keeps the revolution flag of the current position.
+                auto revolution = acquisition.next & revolution_flag;
+                if (acquisition.end == _capacity)
+                {
+                    revolution ^= revolution_flag;
+                }
+
+                return {
+                    acquisition.begin,
+                    end,
+                    end | revolution,
+                    acquisition.alive,
+                };
+            }
+
             T* data() const noexcept
             {
                 return _data;
@@ -398,6 +424,8 @@ namespace til::spsc
                 throw std::overflow_error{ "size too large for spsc" };
             }
         }
+
+        inline constexpr acquisition empty_acquisition{ 0, 0, 0, true };
     }
 
     // Block until at least one item has been written into the sender / read from the receiver.
@@ -419,12 +447,14 @@ namespace til::spsc
         {
             drop();
             _arc = std::exchange(other._arc, nullptr);
+            _reservation = std::exchange(other._reservation, details::empty_acquisition);
         }
 
         producer<T>& operator=(producer<T>&& other) noexcept
         {
             drop();
             _arc = std::exchange(other._arc, nullptr);
+            _reservation = std::exchange(other._reservation, details::empty_acquisition);
             return *this;
         }
 
@@ -513,6 +543,42 @@ namespace til::spsc
             return { count - remaining, ok };
         }
 
+        // reserve returns up to count contiguous, uninitialized slots at the end of the queue,
+        // blocking until at least one slot is free. Write the items into the slots and
+        // publish them with commit(). Unlike push_n this doesn't require a copy of the items
+        // and costs a single pair of atomic operations no matter how many items are written.
+        // The span is shorter than requested if the free slots wrap around the end of the
+        // ring buffer. The next reserve() after commit() will then return the remainder.
+        // The second pair field will be false (and the span empty) if the consumer is gone.
+        //
+        // The slots are raw memory: Unless T is trivial, use std::construct_at to fill them.
+        std::pair<std::span<T>, bool> reserve(size_t count)
+        {
+            return _reserve(count, true);
+        }
+
+        // try_reserve is like reserve, but returns an empty span instead of blocking if the queue is full.
+        std::pair<std::span<T>, bool> try_reserve(size_t count)
+        {
+            return _reserve(count, false);
+        }
+
+        // commit publishes the first count items of the span returned by the last
+        // reserve() to the consumer. The remaining slots are left unused.
+        void commit(size_t count)
+        {
+            if (count > static_cast<size_t>(_reservation.end - _reservation.begin))
+            {
+                throw std::out_of_range{ "commit exceeds the reserved slots" };
+            }
+
+            if (count != 0)
+            {
+                _arc->producer_release(_arc->shrink(_reservation, static_cast<size_type>(count)));
+            }
+            _reservation = details::empty_acquisition;
+        }
+
     private:
         void drop()
         {
@@ -522,7 +588,28 @@ namespace til::spsc
             }
         }
 
+        std::pair<std::span<T>, bool> _reserve(size_t count, bool blocking)
+        {
+            details::validate_size(count);
+
+            _reservation = details::empty_acquisition;
+            if (count == 0)
+            {
+                return { {}, true };
+            }
+
+            const auto acquisition = _arc->producer_acquire(static_cast<size_type>(count), blocking);
+            if (!acquisition.end)
+            {
+                return { {}, acquisition.alive };
+            }
+
+            _reservation = acquisition;
+            return { { _arc->data() + acquisition.begin, _arc->data() + acquisition.end }, true };
+        }
+
         details::arc<T>* _arc = nullptr;
+        details::acquisition _reservation = details::empty_acquisition;
     };
 
     template<typename T>
@@ -538,12 +625,14 @@ namespace til::spsc
         {
             drop();
             _arc = std::exchange(other._arc, nullptr);
+            _peeked = std::exchange(other._peeked, details::empty_acquisition);
         }
 
         consumer<T>& operator=(consumer<T>&& other) noexcept
         {
             drop();
             _arc = std::exchange(other._arc, nullptr);
+            _peeked = std::exchange(other._peeked, details::empty_acquisition);
             return *this;
         }
 
@@ -617,6 +706,42 @@ namespace til::spsc
             return { count - remaining, ok };
         }
 
+        // peek returns up to count contiguous items at the front of the queue without
+        // removing them, blocking until at least one item is available. Once you're done
+        // with (some of) them, remove them with release(). Just like reserve() this
+        // avoids copies and costs a single pair of atomic operations per batch.
+        // The span is shorter than requested if the items wrap around the end of the ring buffer.
+        // The second pair field will be false (and the span empty) if the producer is gone
+        // and all items have been consumed.
+        std::pair<std::span<T>, bool> peek(size_t count)
+        {
+            return _peek(count, true);
+        }
+
+        // try_peek is like peek, but returns an empty span instead of blocking if the queue is empty.
+        std::pair<std::span<T>, bool> try_peek(size_t count)
+        {
+            return _peek(count, false);
+        }
+
+        // release destroys the first count items of the span returned by the
+        // last peek() and frees their slots. The remaining items stay in the queue.
+        void release(size_t count)
+        {
+            if (count > static_cast<size_t>(_peeked.end - _peeked.begin))
+            {
+                throw std::out_of_range{ "release exceeds the peeked items" };
+            }
+
+            if (count != 0)
+            {
+                const auto beg = _arc->data() + _peeked.begin;
+                std::destroy(beg, beg + count);
+                _arc->consumer_release(_arc->shrink(_peeked, static_cast<size_type>(count)));
+            }
+            _peeked = details::empty_acquisition;
+        }
+
     private:
         void drop()
         {
@@ -626,7 +751,28 @@ namespace til::spsc
             }
         }
 
+        std::pair<std::span<T>, bool> _peek(size_t count, bool blocking)
+        {
+            details::validate_size(count);
+
+            _peeked = details::empty_acquisition;
+            if (count == 0)
+            {
+                return { {}, true };
+            }
+
+            const auto acquisition = _arc->consumer_acquire(static_cast<size_type>(count), blocking);
+            if (!acquisition.end)
+            {
+                return { {}, acquisition.alive };
+            }
+
+            _peeked = acquisition;
+            return { { _arc->data() + acquisition.begin, _arc->data() + acquisition.end }, true };
+        }
+
         details::arc<T>* _arc = nullptr;
+        details::acquisition _peeked = details::empty_acquisition;
     };
 
     // channel returns a bounded, lock-free, single-producer, single-consumer
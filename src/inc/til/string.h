@@ -394,4 +394,120 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
         return hasSign ? result * -1 : result;
     }
+
+    // Same as `str.find_first_not_of(L' ')`, but vectorized with SSE2 or NEON. ROW and the renderer use
+    // this to skip over the whitespace that makes up most of a typical terminal row. ROW adds an AVX2
+    // path on top, which lives in Row.cpp, because it needs to check the CPU features at runtime.
+    inline size_t find_first_not_space(const std::wstring_view& str) noexcept
+    {
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+        const auto beg = str.data();
+        const auto end = beg + str.size();
+        auto it = beg;
+
+#if defined(TIL_SSE_INTRINSICS)
+        for (const auto end8 = beg + (str.size() & ~size_t{ 7 }); it < end8; it += 8)
+        {
+            const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            const auto mask = static_cast<uint32_t>(~_mm_movemask_epi8(_mm_cmpeq_epi16(wch, _mm_set1_epi16(L' ')))) & 0xffff;
+            if (mask)
+            {
+                unsigned long offset;
+                _BitScanForward(&offset, mask);
+                return static_cast<size_t>(it - beg) + offset / 2;
+            }
+        }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+        for (const auto end8 = beg + (str.size() & ~size_t{ 7 }); it < end8; it += 8)
+        {
+            const auto c = vreinterpretq_u64_u16(vmvnq_u16(vceqq_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(it)), vdupq_n_u16(L' '))));
+            // Each uint64_t lane covers 4 characters with 16 bits each.
+            const uint64_t lo = vgetq_lane_u64(c, 0);
+            const uint64_t hi = vgetq_lane_u64(c, 1);
+            unsigned long offset;
+            if (_BitScanForward64(&offset, lo))
+            {
+                return static_cast<size_t>(it - beg) + offset / 16;
+            }
+            if (_BitScanForward64(&offset, hi))
+            {
+                return static_cast<size_t>(it - beg) + 4 + offset / 16;
+            }
+        }
+#endif
+
+        for (; it < end; ++it)
+        {
+            if (*it != L' ')
+            {
+                return static_cast<size_t>(it - beg);
+            }
+        }
+
+        return std::wstring_view::npos;
+#pragma warning(pop)
+    }
+
+    // Same as `str.find_last_not_of(L' ')`, but vectorized. See find_first_not_space().
+    inline size_t find_last_not_space(const std::wstring_view& str) noexcept
+    {
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+        const auto beg = str.data();
+        // The vectorized loops below walk backwards from `it` in chunks, and
+        // stop once less than a full chunk is left in front of it.
+        auto it = beg + str.size();
+
+#if defined(TIL_SSE_INTRINSICS)
+        for (const auto beg8 = beg + (str.size() & 7); it > beg8; it -= 8)
+        {
+            const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it - 8));
+            const auto mask = static_cast<uint32_t>(~_mm_movemask_epi8(_mm_cmpeq_epi16(wch, _mm_set1_epi16(L' ')))) & 0xffff;
+            if (mask)
+            {
+                unsigned long offset;
+                _BitScanReverse(&offset, mask);
+                return static_cast<size_t>(it - 8 - beg) + offset / 2;
+            }
+        }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+        for (const auto beg8 = beg + (str.size() & 7); it > beg8; it -= 8)
+        {
+            const auto c = vreinterpretq_u64_u16(vmvnq_u16(vceqq_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(it - 8)), vdupq_n_u16(L' '))));
+            // Each uint64_t lane covers 4 characters with 16 bits each.
+            const uint64_t lo = vgetq_lane_u64(c, 0);
+            const uint64_t hi = vgetq_lane_u64(c, 1);
+            unsigned long offset;
+            if (_BitScanReverse64(&offset, hi))
+            {
+                return static_cast<size_t>(it - 8 - beg) + 4 + offset / 16;
+            }
+            if (_BitScanReverse64(&offset, lo))
+            {
+                return static_cast<size_t>(it - 8 - beg) + offset / 16;
+            }
+        }
+#endif
+
+        while (it != beg)
+        {
+            --it;
+            if (*it != L' ')
+            {
+                return static_cast<size_t>(it - beg);
+            }
+        }
+
+        return std::wstring_view::npos;
+#pragma warning(pop)
+    }
+
+    // Returns true if `str` is empty or consists of nothing but spaces (U+0020).
+    inline bool is_all_spaces(const std::wstring_view& str) noexcept
+    {
+        return find_first_not_space(str) == std::wstring_view::npos;
+    }
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "atomic.h"
+#include "recursive_lock.h"
 
 namespace til
 {
@@ -54,103 +55,6 @@ namespace til
         std::atomic<uint32_t> _now_serving{ 0 };
     };
 
-    struct recursive_ticket_lock
-    {
-        struct recursive_ticket_lock_suspension
-        {
-            constexpr recursive_ticket_lock_suspension(recursive_ticket_lock& lock, uint32_t owner, uint32_t recursion) noexcept :
-                _lock{ lock },
-                _owner{ owner },
-                _recursion{ recursion }
-            {
-            }
-
-            // When this class is destroyed it restores the recursive_ticket_lock state.
-            // This of course only works if the lock wasn't moved to another thread or something.
-            recursive_ticket_lock_suspension(const recursive_ticket_lock_suspension&) = delete;
-            recursive_ticket_lock_suspension& operator=(const recursive_ticket_lock_suspension&) = delete;
-            recursive_ticket_lock_suspension(recursive_ticket_lock_suspension&&) = delete;
-            recursive_ticket_lock_suspension& operator=(recursive_ticket_lock_suspension&&) = delete;
-
-            ~recursive_ticket_lock_suspension()
-            {
-                if (_owner)
-                {
-                    // If someone reacquired the lock on the current thread, we shouldn't lock it again.
-                    if (_lock._owner.load(std::memory_order_relaxed) != _owner)
-                    {
-                        _lock._lock.lock(); // lock-lock-lock lol
-                        _lock._owner.store(_owner, std::memory_order_relaxed);
-                    }
-                    // ...but we should restore the original recursion count.
-                    _lock._recursion += _recursion;
-                }
-            }
-
-        private:
-            friend struct recursive_ticket_lock;
-
-            recursive_ticket_lock& _lock;
-            uint32_t _owner = 0;
-            uint32_t _recursion = 0;
-        };
-
-        void lock() noexcept
-        {
-            const auto id = GetCurrentThreadId();
-
-            if (_owner.load(std::memory_order_relaxed) != id)
-            {
-                _lock.lock();
-                _owner.store(id, std::memory_order_relaxed);
-            }
-
-            _recursion++;
-        }
-
-        void unlock() noexcept
-        {
-            if (--_recursion == 0)
-            {
-                _owner.store(0, std::memory_order_relaxed);
-                _lock.unlock();
-            }
-        }
-
-        [[nodiscard]] recursive_ticket_lock_suspension suspend() noexcept
-        {
-            const auto id = GetCurrentThreadId();
-            uint32_t owner = 0;
-            uint32_t recursion = 0;
-
-            if (_owner.load(std::memory_order_relaxed) == id)
-            {
-                owner = id;
-                recursion = _recursion;
-                _owner.store(0, std::memory_order_relaxed);
-                _recursion = 0;
-                _lock.unlock();
-            }
-
-            return { *this, owner, recursion };
-        }
-
-        uint32_t is_locked() const noexcept
-        {
-            const auto id = GetCurrentThreadId();
-            return _owner.load(std::memory_order_relaxed) == id;
-        }
-
-        uint32_t recursion_depth() const noexcept
-        {
-            return is_locked() ? _recursion : 0;
-        }
-
-    private:
-        ticket_lock _lock;
-        std::atomic<uint32_t> _owner = 0;
-        uint32_t _recursion = 0;
-    };
-
-    using recursive_ticket_lock_suspension = recursive_ticket_lock::recursive_ticket_lock_suspension;
+    using recursive_ticket_lock = recursive_lock<ticket_lock>;
+    using recursive_ticket_lock_suspension = recursive_ticket_lock::suspension;
 }
@@ -4,16 +4,18 @@
 #include "precomp.h"
 #include "renderer.hpp"
 
+#include "../../inc/PerfCounters.hpp"
+
 #pragma hdrstop
 
 using namespace Microsoft::Console::Render;
 using namespace Microsoft::Console::Types;
 
-using PointTree = interval_tree::IntervalTree<til::point, size_t>;
-
 static constexpr auto maxRetriesForRenderEngine = 3;
 // The renderer will wait this number of milliseconds * how many tries have elapsed before trying again.
 static constexpr auto renderBackoffBaseTimeMilliseconds{ 150 };
+// If more invalidations than this are queued up between two frames, they're collapsed into a full repaint.
+static constexpr size_t maxPendingInvalidations{ 1024 };
 
 #define FOREACH_ENGINE(var)   \
     for (auto var : _engines) \
@@ -64,6 +66,9 @@ Renderer::~Renderer()
 // - HRESULT S_OK, GDI error, Safe Math error, or state/argument errors.
 [[nodiscard]] HRESULT Renderer::PaintFrame()
 {
+    PERF_COUNTER_ADD(RendererFrames, 1);
+    PERF_HISTOGRAM_SCOPED_DURATION(RendererFrameDuration);
+
     FOREACH_ENGINE(pEngine)
     {
         auto tries = maxRetriesForRenderEngine;
@@ -115,9 +120,16 @@ try
         _pData->UnlockConsole();
     });
 
+    // The engine lock is taken after the console lock, which allows us to
+    // release the console lock early below, while still holding on to the engines.
+    auto engineLock = LockEngines();
+
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
+    // Hand the invalidations that were queued up since the last frame to the engines.
+    _ApplyPendingInvalidations();
+
     // Try to start painting a frame
     const auto hr = pEngine->StartPaint();
     RETURN_IF_FAILED(hr);
@@ -142,6 +154,18 @@ try
         }
     });
 
+    // Everything the previous frame allocated is released at once.
+    _frame.ReleaseScratch();
+    _frameArena.reset();
+
+    // Gather everything we need from the console. If this frame is a snapshot,
+    // the dirty rows were copied and we can paint without the console lock.
+    _PrepareFrame(pEngine);
+    if (_frame.snapshot)
+    {
+        unlock.reset();
+    }
+
     // A. Prep Colors
     RETURN_IF_FAILED(_UpdateDrawingBrushes(pEngine, {}, false, true));
 
@@ -169,10 +193,15 @@ try
     // 6. Paint window title
     RETURN_IF_FAILED(_PaintTitle(pEngine));
 
+    // Once the arena has grown large enough for the frame, this is always 0.
+    PERF_HISTOGRAM_RECORD(RendererArenaAllocations, _frameArena.upstream_allocations());
+    PERF_HISTOGRAM_RECORD(RendererArenaBytes, _frameArena.bytes_used());
+
     // Force scope exit end paint to finish up collecting information and possibly painting
     endPaint.reset();
 
     // Force scope exit unlock to let go of global lock so other threads can run
+    engineLock.unlock();
     unlock.reset();
 
     // Trigger out-of-lock presentation for renderers that can support it
@@ -183,6 +212,128 @@ try
 }
 CATCH_RETURN()
 
+// Routine Description:
+// - Gathers everything the frame needs from the console into _frame.
+// - If snapshot painting is enabled, the dirty rows are copied as well,
+//   so that the frame can be painted without holding the console lock.
+// - The console lock must be held and the engine must have started painting.
+// Arguments:
+// - pEngine - The engine that's about to paint the frame.
+// Return Value:
+// - <none>
+void Renderer::_PrepareFrame(_In_ IRenderEngine* const pEngine)
+{
+    _frame.view = _pData->GetViewport();
+    _frame.cursor = _GetCursorInfo();
+    _frame.selectionRects = _GetSelectionRects();
+    _frame.searchSelectionRects = _GetSearchSelectionRects();
+    _frame.title = _pData->GetConsoleTitle();
+    _frame.gridLinesAllowed = _pData->IsGridLineDrawingAllowed();
+    _frame.hyperlinkHoveredId = _hyperlinkHoveredId;
+    _frame.hoveredInterval = _hoveredInterval;
+
+    // A run of clusters is at most a row long, unless it starts with the trailing half of a wide glyph.
+    _frame.clusters.reserve(gsl::narrow_cast<size_t>(_frame.view.Width()) + 1);
+
+    // Overlays reference buffers we don't own. Frames with overlays are painted under the lock.
+    _frame.snapshot = _snapshotPainting && _pData->GetOverlays().empty();
+
+    if (_frame.snapshot)
+    {
+        _SnapshotDirtyRows(pEngine);
+    }
+    else
+    {
+        _frame.buffer = &_pData->GetTextBuffer();
+        _frame.settings = &_renderSettings;
+    }
+}
+
+// Routine Description:
+// - Gives the memory of all containers back to _frameArena, so that it can be reset.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::FrameState::ReleaseScratch() noexcept
+{
+    // clear() would keep the capacity, which is memory the arena is about to hand out again.
+    const auto release = [](auto& container) noexcept {
+        std::remove_reference_t<decltype(container)>{ container.get_allocator() }.swap(container);
+    };
+    release(patternIntervals);
+    release(patternRowOffsets);
+    release(clusters);
+
+    // The arena is reset right after this. Any container still holding its memory would dangle.
+    assert(patternIntervals.capacity() == 0 && patternRowOffsets.capacity() == 0 && clusters.capacity() == 0);
+}
+
+// Routine Description:
+// - Copies the rows of the viewport that the engine considers dirty into
+//   _snapshotBuffer, whose first row corresponds to the top of the viewport.
+//   The render settings and the pattern intervals of the viewport are copied too.
+// Arguments:
+// - pEngine - The engine that's about to paint the frame.
+// Return Value:
+// - <none>
+void Renderer::_SnapshotDirtyRows(_In_ IRenderEngine* const pEngine)
+{
+    const auto& buffer = _pData->GetTextBuffer();
+    const auto view = _frame.view;
+    const til::size size{ buffer.GetSize().Width(), view.Height() };
+
+    if (!_snapshotBuffer || _snapshotBuffer->GetSize().Dimensions() != size)
+    {
+        _snapshotBuffer.reset();
+        _snapshotBuffer = std::make_unique<TextBuffer>(size, TextAttribute{}, 0, false, *this);
+    }
+
+    std::span<const til::rect> dirtyAreas;
+    LOG_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
+
+    for (const auto& dirtyRect : dirtyAreas)
+    {
+        const auto top = std::max(dirtyRect.top, 0);
+        const auto bottom = std::min(dirtyRect.bottom, size.height);
+
+        for (auto y = top; y < bottom; ++y)
+        {
+            const auto& source = buffer.GetRowByOffset(view.Top() + y);
+            auto& target = _snapshotBuffer->GetMutableRowByOffset(y);
+            target.Reset(TextAttribute{});
+            target.CopyFrom(source);
+
+            // We paint with a copy of the render settings. Let the original know about
+            // blinking cells the same way that painting them would have (see ToggleBlinkRendition).
+            for (const auto& run : source.Attributes().runs())
+            {
+                if (run.value.IsBlinking())
+                {
+                    _renderSettings.GetAttributeColors(run.value);
+                    break;
+                }
+            }
+        }
+    }
+
+    _frame.patternIntervals.clear();
+    _frame.patternRowOffsets.clear();
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        const auto intervals = _pData->GetPatternIntervalsInRow(y);
+        _frame.patternRowOffsets.emplace_back(_frame.patternIntervals.size());
+        _frame.patternIntervals.insert(_frame.patternIntervals.end(), intervals.begin(), intervals.end());
+    }
+    _frame.patternRowOffsets.emplace_back(_frame.patternIntervals.size());
+
+    _snapshotSettings = _renderSettings;
+
+    _frame.buffer = _snapshotBuffer.get();
+    _frame.settings = &*_snapshotSettings;
+    _frame.view = Viewport::FromDimensions({ view.Left(), 0 }, view.Dimensions());
+}
+
 void Renderer::NotifyPaintFrame() noexcept
 {
     // If we're running in the unittests, we might not have a render thread.
@@ -193,6 +344,44 @@ void Renderer::NotifyPaintFrame() noexcept
     }
 }
 
+// Routine Description:
+// - Called after the given amount of output was processed, so that the
+//   render thread can reduce its frame rate during bulk output.
+void Renderer::NotifyOutput(const size_t codeUnits) noexcept
+{
+    if (_pThread)
+    {
+        _pThread->NotifyOutput(codeUnits);
+    }
+}
+
+// Routine Description:
+// - Called when the user interacted with the console (key presses, scrolling, etc.).
+//   This returns the render thread to its full frame rate, if it was throttled.
+void Renderer::NotifyUserInput() noexcept
+{
+    if (_pThread)
+    {
+        _pThread->NotifyUserInput();
+    }
+}
+
+// Routine Description:
+// - Returns the frame scheduling counters of the render thread, if there's one.
+RenderThread::Metrics Renderer::GetMetrics() const noexcept
+{
+    return _pThread ? _pThread->GetMetrics() : RenderThread::Metrics{};
+}
+
+// Routine Description:
+// - Returns how many blocks the last painted frame had to allocate from the heap for its temporaries.
+// - Once the frame arena has grown large enough for the workload, this stays at 0.
+// - Must be called on the thread that calls PaintFrame().
+size_t Renderer::GetFrameArenaAllocations() const noexcept
+{
+    return _frameArena.upstream_allocations();
+}
+
 // Routine Description:
 // - Called when the system has requested we redraw a portion of the console.
 // Arguments:
@@ -201,10 +390,7 @@ void Renderer::NotifyPaintFrame() noexcept
 // - <none>
 void Renderer::TriggerSystemRedraw(const til::rect* const prcDirtyClient)
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateSystem(prcDirtyClient));
-    }
+    _InvalidateEngines({ .kind = PendingInvalidation::Kind::System, .rect = *prcDirtyClient });
 
     NotifyPaintFrame();
 }
@@ -235,10 +421,7 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
-        FOREACH_ENGINE(pEngine)
-        {
-            LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
-        }
+        _InvalidateEngines({ .kind = PendingInvalidation::Kind::Region, .rect = srUpdateRegion });
 
         NotifyPaintFrame();
     }
@@ -286,10 +469,7 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
         if (view.TrimToViewport(&updateRect))
         {
             view.ConvertToOrigin(&updateRect);
-            FOREACH_ENGINE(pEngine)
-            {
-                LOG_IF_FAILED(pEngine->InvalidateCursor(&updateRect));
-            }
+            _InvalidateEngines({ .kind = PendingInvalidation::Kind::Cursor, .rect = updateRect });
 
             NotifyPaintFrame();
         }
@@ -306,10 +486,7 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll(const bool backgroundChanged, const bool frameChanged)
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateAll());
-    }
+    _InvalidateEngines({ .kind = PendingInvalidation::Kind::All });
 
     NotifyPaintFrame();
 
@@ -373,13 +550,10 @@ void Renderer::TriggerSelection()
             sr &= viewport;
         }
 
-        FOREACH_ENGINE(pEngine)
-        {
-            LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSearchSelection));
-            LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSelection));
-            LOG_IF_FAILED(pEngine->InvalidateSelection(searchSelections));
-            LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
-        }
+        _InvalidateEnginesSelection(_previousSearchSelection);
+        _InvalidateEnginesSelection(_previousSelection);
+        _InvalidateEnginesSelection(searchSelections);
+        _InvalidateEnginesSelection(rects);
 
         _previousSelection = std::move(rects);
         _previousSearchSelection = std::move(searchSelections);
@@ -412,13 +586,14 @@ bool Renderer::_CheckViewportAndScroll()
     coordDelta.x = srOldViewport.left - srNewViewport.left;
     coordDelta.y = srOldViewport.top - srNewViewport.top;
 
-    FOREACH_ENGINE(engine)
-    {
-        LOG_IF_FAILED(engine->UpdateViewport(srNewViewport));
-        LOG_IF_FAILED(engine->InvalidateScroll(&coordDelta));
-    }
+    _InvalidateEngines({ .kind = PendingInvalidation::Kind::Viewport, .rect = til::rect{ srNewViewport } });
+    _InvalidateEngines({ .kind = PendingInvalidation::Kind::Scroll, .delta = coordDelta });
 
     _ScrollPreviousSelection(coordDelta);
+    if (_pThread)
+    {
+        _pThread->NotifyScroll(coordDelta.y);
+    }
     return true;
 }
 
@@ -448,13 +623,14 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const til::point* const pcoordDelta)
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
-    }
+    _InvalidateEngines({ .kind = PendingInvalidation::Kind::Scroll, .delta = *pcoordDelta });
 
     _ScrollPreviousSelection(*pcoordDelta);
 
+    if (_pThread)
+    {
+        _pThread->NotifyScroll(pcoordDelta->y);
+    }
     NotifyPaintFrame();
 }
 
@@ -469,6 +645,15 @@ void Renderer::TriggerFlush(const bool circling)
 {
     const auto rects = _GetSelectionRects();
 
+    // The engines can't be painted synchronously while they're owned by the
+    // render thread. It'll paint the next frame soon enough anyway.
+    if (_snapshotPainting)
+    {
+        _QueueInvalidation({ .kind = PendingInvalidation::Kind::Flush, .circling = circling });
+        _InvalidateEnginesSelection(rects);
+        return;
+    }
+
     FOREACH_ENGINE(pEngine)
     {
         auto fEngineRequestsRepaint = false;
@@ -494,21 +679,257 @@ void Renderer::TriggerFlush(const bool circling)
 void Renderer::TriggerTitleChange()
 {
     const auto newTitle = _pData->GetConsoleTitle();
-    FOREACH_ENGINE(pEngine)
+    if (_snapshotPainting)
     {
-        LOG_IF_FAILED(pEngine->InvalidateTitle(newTitle));
+        _pendingTitle.emplace(newTitle);
+    }
+    else
+    {
+        FOREACH_ENGINE(pEngine)
+        {
+            LOG_IF_FAILED(pEngine->InvalidateTitle(newTitle));
+        }
     }
     NotifyPaintFrame();
 }
 
 void Renderer::TriggerNewTextNotification(const std::wstring_view newText)
 {
+    if (_snapshotPainting)
+    {
+        _pendingNewText.append(newText);
+        return;
+    }
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->NotifyNewText(newText));
     }
 }
 
+// Routine Description:
+// - Hands the invalidation to all engines, or queues it up for the next frame if snapshot painting is enabled.
+// Arguments:
+// - invalidation - The invalidation to apply.
+// Return Value:
+// - <none>
+void Renderer::_InvalidateEngines(const PendingInvalidation& invalidation)
+{
+    if (_snapshotPainting)
+    {
+        _QueueInvalidation(invalidation);
+        return;
+    }
+
+    FOREACH_ENGINE(pEngine)
+    {
+        s_ApplyInvalidation(pEngine, invalidation);
+    }
+}
+
+// Routine Description:
+// - Same as _InvalidateEngines, but for a list of selection rectangles.
+// Arguments:
+// - rectangles - The areas to invalidate.
+// Return Value:
+// - <none>
+void Renderer::_InvalidateEnginesSelection(const std::vector<til::rect>& rectangles)
+{
+    if (_snapshotPainting)
+    {
+        for (const auto& rect : rectangles)
+        {
+            _QueueInvalidation({ .kind = PendingInvalidation::Kind::Selection, .rect = rect });
+        }
+        return;
+    }
+
+    FOREACH_ENGINE(pEngine)
+    {
+        LOG_IF_FAILED(pEngine->InvalidateSelection(rectangles));
+    }
+}
+
+// Routine Description:
+// - Appends the invalidation to _pendingInvalidations. The console lock must be held.
+// - Consecutive invalidations of the same kind are merged where possible and if too many
+//   of them pile up between two frames, they're replaced with a full repaint.
+// Arguments:
+// - invalidation - The invalidation to queue up.
+// Return Value:
+// - <none>
+void Renderer::_QueueInvalidation(const PendingInvalidation& invalidation)
+{
+    using Kind = PendingInvalidation::Kind;
+
+    if (!_pendingInvalidations.empty())
+    {
+        auto& last = _pendingInvalidations.back();
+
+        // Everything but the viewport and scroll offset is covered by a full repaint.
+        if (last.kind == Kind::All && invalidation.kind != Kind::Viewport && invalidation.kind != Kind::Scroll)
+        {
+            return;
+        }
+
+        if (last.kind == invalidation.kind)
+        {
+            switch (invalidation.kind)
+            {
+            case Kind::Region:
+                // Text is mostly written line by line, from top to bottom.
+                if (last.rect.left == invalidation.rect.left && last.rect.right == invalidation.rect.right &&
+                    invalidation.rect.top <= last.rect.bottom && invalidation.rect.bottom >= last.rect.top)
+                {
+                    last.rect |= invalidation.rect;
+                    return;
+                }
+                break;
+            case Kind::Scroll:
+                last.delta += invalidation.delta;
+                return;
+            case Kind::Viewport:
+                last.rect = invalidation.rect;
+                return;
+            case Kind::Flush:
+                if (last.circling == invalidation.circling)
+                {
+                    return;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    if (_pendingInvalidations.size() >= maxPendingInvalidations)
+    {
+        // The engines only need to know about the most recent viewport.
+        std::optional<til::rect> viewport;
+        if (invalidation.kind == Kind::Viewport)
+        {
+            viewport = invalidation.rect;
+        }
+        else
+        {
+            for (auto it = _pendingInvalidations.rbegin(); it != _pendingInvalidations.rend(); ++it)
+            {
+                if (it->kind == Kind::Viewport)
+                {
+                    viewport = it->rect;
+                    break;
+                }
+            }
+        }
+
+        _pendingInvalidations.clear();
+        if (viewport)
+        {
+            _pendingInvalidations.push_back({ .kind = Kind::Viewport, .rect = *viewport });
+        }
+        _pendingInvalidations.push_back({ .kind = Kind::All });
+        return;
+    }
+
+    _pendingInvalidations.emplace_back(invalidation);
+}
+
+// Routine Description:
+// - Hands everything that was queued up by _QueueInvalidation to the engines.
+// - Both, the console lock and the engine lock must be held.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_ApplyPendingInvalidations()
+{
+    if (_pendingInvalidations.empty() && !_pendingTitle && _pendingNewText.empty())
+    {
+        return;
+    }
+
+    std::vector<til::rect> selection;
+
+    FOREACH_ENGINE(pEngine)
+    {
+        for (auto it = _pendingInvalidations.begin(), end = _pendingInvalidations.end(); it != end;)
+        {
+            // Selection rectangles are queued one by one, but we can hand them over in bulk.
+            if (it->kind == PendingInvalidation::Kind::Selection)
+            {
+                selection.clear();
+                for (; it != end && it->kind == PendingInvalidation::Kind::Selection; ++it)
+                {
+                    selection.emplace_back(it->rect);
+                }
+                LOG_IF_FAILED(pEngine->InvalidateSelection(selection));
+                continue;
+            }
+
+            s_ApplyInvalidation(pEngine, *it);
+            ++it;
+        }
+
+        if (_pendingTitle)
+        {
+            LOG_IF_FAILED(pEngine->InvalidateTitle(*_pendingTitle));
+        }
+
+        if (!_pendingNewText.empty())
+        {
+            LOG_IF_FAILED(pEngine->NotifyNewText(_pendingNewText));
+        }
+    }
+
+    _pendingInvalidations.clear();
+    _pendingTitle.reset();
+    _pendingNewText.clear();
+}
+
+// Routine Description:
+// - Calls the engine method that corresponds to the given invalidation.
+// Arguments:
+// - pEngine - The engine to invalidate.
+// - invalidation - The invalidation to apply.
+// Return Value:
+// - <none>
+void Renderer::s_ApplyInvalidation(_In_ IRenderEngine* const pEngine, const PendingInvalidation& invalidation)
+{
+    switch (invalidation.kind)
+    {
+    case PendingInvalidation::Kind::Region:
+        LOG_IF_FAILED(pEngine->Invalidate(&invalidation.rect));
+        break;
+    case PendingInvalidation::Kind::Cursor:
+        LOG_IF_FAILED(pEngine->InvalidateCursor(&invalidation.rect));
+        break;
+    case PendingInvalidation::Kind::System:
+        LOG_IF_FAILED(pEngine->InvalidateSystem(&invalidation.rect));
+        break;
+    case PendingInvalidation::Kind::Selection:
+        LOG_IF_FAILED(pEngine->InvalidateSelection({ invalidation.rect }));
+        break;
+    case PendingInvalidation::Kind::Scroll:
+        LOG_IF_FAILED(pEngine->InvalidateScroll(&invalidation.delta));
+        break;
+    case PendingInvalidation::Kind::Viewport:
+        LOG_IF_FAILED(pEngine->UpdateViewport(invalidation.rect.to_inclusive_rect()));
+        break;
+    case PendingInvalidation::Kind::Flush:
+    {
+        // We're about to paint a frame anyway, so the engine's request for one can be ignored.
+        auto forcePaint = false;
+        LOG_IF_FAILED(pEngine->InvalidateFlush(invalidation.circling, &forcePaint));
+        break;
+    }
+    case PendingInvalidation::Kind::All:
+    default:
+        LOG_IF_FAILED(pEngine->InvalidateAll());
+        break;
+    }
+}
+
 // Routine Description:
 // - Update the title for a particular engine.
 // Arguments:
@@ -517,8 +938,7 @@ void Renderer::TriggerNewTextNotification(const std::wstring_view newText)
 // - the HRESULT of the underlying engine's UpdateTitle call.
 HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 {
-    const auto newTitle = _pData->GetConsoleTitle();
-    return pEngine->UpdateTitle(newTitle);
+    return pEngine->UpdateTitle(_frame.title);
 }
 
 // Routine Description:
@@ -531,6 +951,7 @@ HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 // - <none>
 void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo)
 {
+    const auto engineLock = LockEngines();
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->UpdateDpi(iDpi));
@@ -555,6 +976,7 @@ void Renderer::UpdateSoftFont(const std::span<const uint16_t> bitPattern, const
     // bitPattern. If it's empty (i.e. no soft font is set), then nothing will
     // match, and those code points will be treated the same as everything else.
     const auto softFontCharCount = cellSize.height ? bitPattern.size() / cellSize.height : 0;
+    const auto engineLock = LockEngines();
     _lastSoftFontChar = _firstSoftFontChar + softFontCharCount - 1;
 
     FOREACH_ENGINE(pEngine)
@@ -587,6 +1009,7 @@ bool Renderer::s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSo
     //      renderer. We won't know which is which, so iterate over them.
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
     // TODO: 14560740 - The Window might be able to get at this info in a more sane manner
+    const auto engineLock = LockEngines();
     FOREACH_ENGINE(pEngine)
     {
         const auto hr = LOG_IF_FAILED(pEngine->GetProposedFont(FontInfoDesired, FontInfo, iDpi));
@@ -618,6 +1041,7 @@ bool Renderer::IsGlyphWideByFont(const std::wstring_view glyph)
     //      renderer. We won't know which is which, so iterate over them.
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
     // TODO: 14560740 - The Window might be able to get at this info in a more sane manner
+    const auto engineLock = LockEngines();
     FOREACH_ENGINE(pEngine)
     {
         const auto hr = LOG_IF_FAILED(pEngine->IsGlyphWideByFont(glyph, &fIsFullWidth));
@@ -688,7 +1112,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
     // This is the subsection of the entire screen buffer that is currently being presented.
     // It can move left/right or top/bottom depending on how the viewport is scrolled
     // relative to the entire buffer.
-    const auto view = _pData->GetViewport();
+    const auto view = _frame.view;
 
     // This is effectively the number of cells on the visible screen that need to be redrawn.
     // The origin is always 0, 0 because it represents the screen itself, not the underlying buffer.
@@ -719,11 +1143,13 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
         const auto redraw = Viewport::Intersect(dirty, view);
 
         // Retrieve the text buffer so we can read information out of it.
-        const auto& buffer = _pData->GetTextBuffer();
+        const auto& buffer = *_frame.buffer;
 
         // Now walk through each row of text that we need to redraw.
         for (auto row = redraw.Top(); row < redraw.BottomExclusive(); row++)
         {
+            PERF_COUNTER_ADD(RendererDirtyRows, 1);
+
             // Calculate the boundaries of a single line. This is from the left to right edge of the dirty
             // area in width and exactly 1 tall.
             const auto screenLine = til::inclusive_rect{ redraw.Left(), row, redraw.RightInclusive(), row };
@@ -761,8 +1187,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
 
 static bool _IsAllSpaces(const std::wstring_view v)
 {
-    // first non-space char is not found (is npos)
-    return v.find_first_not_of(L' ') == decltype(v)::npos;
+    return til::is_all_spaces(v);
 }
 
 void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
@@ -770,7 +1195,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                                         const til::point target,
                                         const bool lineWrapped)
 {
-    auto globalInvert{ _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed) };
+    auto globalInvert{ _frame.settings->GetRenderMode(RenderSettings::Mode::ScreenReversed) };
 
     // If we have valid data, let's figure out how to draw it.
     if (it)
@@ -783,8 +1208,23 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
         // Retrieve the first color.
         auto color = it->TextAttr();
+        // Retrieve the pattern intervals of this row once instead of looking up the pattern ids of each cell.
+        // They're sorted and don't overlap, so we can walk through them alongside the columns.
+        const auto patternIntervals = _GetPatternIntervalsInRow(target.y);
+        auto patternIt = patternIntervals.begin();
+        const auto getPatternId = [&](const til::point point) noexcept -> std::optional<size_t> {
+            while (patternIt != patternIntervals.end() && patternIt->stop <= point)
+            {
+                ++patternIt;
+            }
+            if (patternIt != patternIntervals.end() && patternIt->start <= point)
+            {
+                return patternIt->value;
+            }
+            return std::nullopt;
+        };
         // Retrieve the first pattern id
-        auto patternIds = _pData->GetPatternId(target);
+        auto patternId = getPatternId(target);
         // Determine whether we're using a soft font.
         auto usingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
 
@@ -800,9 +1240,6 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // when we go to draw gridlines for the length of the run.
             const auto currentRunColor = color;
 
-            // Hold onto the current pattern id as well
-            const auto currentPatternId = patternIds;
-
             // Update the drawing brushes with our color and font usage.
             THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, usingSoftFont, false));
 
@@ -816,7 +1253,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             const auto currentRunTargetStart = screenPoint;
 
             // Ensure that our cluster vector is clear.
-            _clusterBuffer.clear();
+            _frame.clusters.clear();
 
             // Reset our flag to know when we're in the special circumstance
             // of attempting to draw only the right-half of a two-column character
@@ -832,9 +1269,9 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             do
             {
                 til::point thisPoint{ screenPoint.x + cols, screenPoint.y };
-                const auto thisPointPatterns = _pData->GetPatternId(thisPoint);
+                const auto thisPointPattern = getPatternId(thisPoint);
                 const auto thisUsingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
-                const auto changedPatternOrFont = patternIds != thisPointPatterns || usingSoftFont != thisUsingSoftFont;
+                const auto changedPatternOrFont = patternId != thisPointPattern || usingSoftFont != thisUsingSoftFont;
                 if (color != it->TextAttr() || changedPatternOrFont)
                 {
                     auto newAttr{ it->TextAttr() };
@@ -843,7 +1280,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                     if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
                     {
                         color = newAttr;
-                        patternIds = thisPointPatterns;
+                        patternId = thisPointPattern;
                         usingSoftFont = thisUsingSoftFont;
                         break; // vend this run
                     }
@@ -855,7 +1292,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
                 // If we're on the first cluster to be added and it's marked as "trailing"
                 // (a.k.a. the right half of a two column character), then we need some special handling.
-                if (_clusterBuffer.empty() && it->DbcsAttr() == DbcsAttribute::Trailing)
+                if (_frame.clusters.empty() && it->DbcsAttr() == DbcsAttribute::Trailing)
                 {
                     // Move left to the one so the whole character can be struck correctly.
                     --screenPoint.x;
@@ -871,18 +1308,19 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 }
 
                 // Advance the cluster and column counts.
-                _clusterBuffer.emplace_back(it->Chars(), columnCount);
+                _frame.clusters.emplace_back(it->Chars(), columnCount);
                 it += std::max(it->Columns(), 1); // prevent infinite loop for no visible columns
                 cols += columnCount;
 
             } while (it);
 
             // Do the painting.
-            THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped));
+            PERF_COUNTER_ADD(RendererClusters, _frame.clusters.size());
+            THROW_IF_FAILED(pEngine->PaintBufferLine({ _frame.clusters.data(), _frame.clusters.size() }, screenPoint, trimLeft, lineWrapped));
 
             // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
             // We're only allowed to draw the grid lines under certain circumstances.
-            if (_pData->IsGridLineDrawingAllowed())
+            if (_frame.gridLinesAllowed)
             {
                 // See GH: 803
                 // If we found a wide character while we looped above, it's possible we skipped over the right half
@@ -1007,7 +1445,7 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
     if (lines.any())
     {
         // Get the current foreground color to render the lines.
-        const auto rgb = _renderSettings.GetAttributeColors(textAttribute).first;
+        const auto rgb = _frame.settings->GetAttributeColors(textAttribute).first;
         // Draw the lines
         LOG_IF_FAILED(pEngine->PaintBufferGridLines(lines, rgb, cchLine, coordTarget));
     }
@@ -1015,14 +1453,43 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
 
 bool Renderer::_isHoveredHyperlink(const TextAttribute& textAttribute) const noexcept
 {
-    return _hyperlinkHoveredId && _hyperlinkHoveredId == textAttribute.GetHyperlinkId();
+    return _frame.hyperlinkHoveredId && _frame.hyperlinkHoveredId == textAttribute.GetHyperlinkId();
 }
 
 bool Renderer::_isInHoveredInterval(const til::point coordTarget) const noexcept
 {
-    return _hoveredInterval &&
-           _hoveredInterval->start <= coordTarget && coordTarget <= _hoveredInterval->stop &&
-           _pData->GetPatternId(coordTarget).size() > 0;
+    if (!_frame.hoveredInterval || !(_frame.hoveredInterval->start <= coordTarget && coordTarget <= _frame.hoveredInterval->stop))
+    {
+        return false;
+    }
+
+    const auto intervals = _GetPatternIntervalsInRow(coordTarget.y);
+    return std::any_of(intervals.begin(), intervals.end(), [&](const auto& interval) {
+        return interval.start <= coordTarget && coordTarget < interval.stop;
+    });
+}
+
+// Routine Description:
+// - Returns the pattern intervals that intersect the given viewport row, sorted by their start.
+// Arguments:
+// - row - The viewport-relative row.
+// Return Value:
+// - The intervals. They're only valid until the next frame.
+std::span<const Renderer::PointTree::interval> Renderer::_GetPatternIntervalsInRow(const til::CoordType row) const
+{
+    if (!_frame.snapshot)
+    {
+        return _pData->GetPatternIntervalsInRow(row);
+    }
+
+    if (row < 0 || gsl::narrow_cast<size_t>(row) + 1 >= _frame.patternRowOffsets.size())
+    {
+        return {};
+    }
+
+    const auto beg = til::at(_frame.patternRowOffsets, row);
+    const auto end = til::at(_frame.patternRowOffsets, row + 1);
+    return std::span{ _frame.patternIntervals }.subspan(beg, end - beg);
 }
 
 // Routine Description:
@@ -1097,10 +1564,9 @@ bool Renderer::_isInHoveredInterval(const til::point coordTarget) const noexcept
 // - <none>
 void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
 {
-    const auto cursorInfo = _GetCursorInfo();
-    if (cursorInfo.has_value())
+    if (_frame.cursor.has_value())
     {
-        LOG_IF_FAILED(pEngine->PaintCursor(cursorInfo.value()));
+        LOG_IF_FAILED(pEngine->PaintCursor(_frame.cursor.value()));
     }
 }
 
@@ -1118,7 +1584,7 @@ void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
 [[nodiscard]] HRESULT Renderer::_PrepareRenderInfo(_In_ IRenderEngine* const pEngine)
 {
     RenderFrameInfo info;
-    info.cursorInfo = _GetCursorInfo();
+    info.cursorInfo = _frame.cursor;
     return pEngine->PrepareRenderInfo(info);
 }
 
@@ -1174,6 +1640,13 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
 // - <none>
 void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
 {
+    // Frames with overlays are never snapshots (see _PrepareFrame),
+    // but we mustn't ask the console about them without holding its lock.
+    if (_frame.snapshot)
+    {
+        return;
+    }
+
     try
     {
         const auto overlays = _pData->GetOverlays();
@@ -1200,9 +1673,8 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
         LOG_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
 
         // Get selection rectangles
-        const auto rectangles = _GetSelectionRects();
-        const auto searchRectangles = _GetSearchSelectionRects();
-        LOG_IF_FAILED(pEngine->PaintSelections(searchRectangles));
+        const auto& rectangles = _frame.selectionRects;
+        LOG_IF_FAILED(pEngine->PaintSelections(_frame.searchSelectionRects));
         for (const auto& rect : rectangles)
         {
             for (auto& dirtyRect : dirtyAreas)
@@ -1236,7 +1708,7 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 {
     // The last color needs to be each engine's responsibility. If it's local to this function,
     //      then on the next engine we might not update the color.
-    return pEngine->UpdateDrawingBrushes(textAttributes, _renderSettings, _pData, usingSoftFont, isSettingDefaultBrushes);
+    return pEngine->UpdateDrawingBrushes(textAttributes, *_frame.settings, _pData, usingSoftFont, isSettingDefaultBrushes);
 }
 
 // Routine Description:
@@ -1333,6 +1805,8 @@ void Renderer::AddRenderEngine(_In_ IRenderEngine* const pEngine)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, pEngine);
 
+    const auto engineLock = LockEngines();
+
     for (auto& p : _engines)
     {
         if (!p)
@@ -1349,6 +1823,8 @@ void Renderer::RemoveRenderEngine(_In_ IRenderEngine* const pEngine)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, pEngine);
 
+    const auto engineLock = LockEngines();
+
     for (auto& p : _engines)
     {
         if (p == pEngine)
@@ -1403,6 +1879,7 @@ void Renderer::ResetErrorStateAndResume()
 
 void Renderer::UpdateHyperlinkHoveredId(uint16_t id) noexcept
 {
+    const auto engineLock = LockEngines();
     _hyperlinkHoveredId = id;
     FOREACH_ENGINE(pEngine)
     {
@@ -1415,6 +1892,29 @@ void Renderer::UpdateLastHoveredInterval(const std::optional<PointTree::interval
     _hoveredInterval = newInterval;
 }
 
+// Method Description:
+// - Allows the renderer to paint frames without holding the console lock.
+//   Every frame copies the dirty rows of the viewport under the console lock
+//   and then releases it before painting them. In turn, invalidations are
+//   queued up and handed to the engines at the start of the next frame.
+// - Callers need to hold LockEngines() whenever they use an engine directly
+//   and must not call this once the renderer has started painting.
+void Renderer::EnableSnapshotPainting() noexcept
+{
+    _snapshotPainting = true;
+}
+
+// Method Description:
+// - Acquires the lock that protects the render engines. If the console lock
+//   is needed as well, it must be acquired first.
+// Return Value:
+// - a unique_lock which can be used to unlock the engines.
+[[nodiscard]] std::unique_lock<til::recursive_ticket_lock> Renderer::LockEngines() noexcept
+{
+#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'recursive_ticket_lock>()' which may throw exceptions (f.6).
+    return std::unique_lock{ _engineLock };
+}
+
 // Method Description:
 // - Blocks until the engines are able to render without blocking.
 void Renderer::WaitUntilCanRender()
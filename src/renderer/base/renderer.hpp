@@ -23,6 +23,8 @@ Author(s):
 
 #include "../../buffer/out/textBuffer.hpp"
 
+#include <til/ticket_lock.h>
+
 // fwdecl unittest classes
 #ifdef UNIT_TESTING
 namespace TerminalCoreUnitTests
@@ -47,6 +49,10 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT PaintFrame();
 
         void NotifyPaintFrame() noexcept;
+        void NotifyOutput(const size_t codeUnits) noexcept;
+        void NotifyUserInput() noexcept;
+        RenderThread::Metrics GetMetrics() const noexcept;
+        size_t GetFrameArenaAllocations() const noexcept;
         void TriggerSystemRedraw(const til::rect* const prcDirtyClient);
         void TriggerRedraw(const Microsoft::Console::Types::Viewport& region);
         void TriggerRedraw(const til::point* const pcoord);
@@ -92,11 +98,82 @@ namespace Microsoft::Console::Render
         void UpdateHyperlinkHoveredId(uint16_t id) noexcept;
         void UpdateLastHoveredInterval(const std::optional<interval_tree::IntervalTree<til::point, size_t>::interval>& newInterval);
 
+        void EnableSnapshotPainting() noexcept;
+        [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> LockEngines() noexcept;
+
     private:
+        using PointTree = interval_tree::IntervalTree<til::point, size_t>;
+
+        // An engine invalidation that was triggered while snapshot painting is enabled.
+        // They're recorded under the console lock and replayed at the start of the next frame.
+        struct PendingInvalidation
+        {
+            enum class Kind : uint8_t
+            {
+                Region,
+                Cursor,
+                System,
+                Selection,
+                Scroll,
+                Viewport,
+                Flush,
+                All,
+            };
+
+            Kind kind = Kind::All;
+            bool circling = false;
+            til::point delta;
+            til::rect rect;
+        };
+
+        // Everything a frame is painted from. It's gathered under the console lock by _PrepareFrame.
+        // With snapshot painting enabled the dirty rows are copied into a private buffer first,
+        // so that the frame can be painted after the console lock was released.
+        // The pmr containers allocate from _frameArena. Their memory is only valid until the next frame
+        // releases them and resets the arena, so nothing may hold on to it past the frame that filled them.
+        // That's why the selection rects, which UiaEngine keeps around, are plain vectors.
+        struct FrameState
+        {
+            explicit FrameState(std::pmr::memory_resource* const arena) noexcept :
+                patternIntervals(arena),
+                patternRowOffsets(arena),
+                clusters(arena)
+            {
+            }
+
+            void ReleaseScratch() noexcept;
+
+            const TextBuffer* buffer = nullptr;
+            const RenderSettings* settings = nullptr;
+            Microsoft::Console::Types::Viewport view;
+            std::optional<CursorOptions> cursor;
+            std::vector<til::rect> selectionRects;
+            std::vector<til::rect> searchSelectionRects;
+            std::wstring title;
+            bool gridLinesAllowed = false;
+            bool snapshot = false;
+            uint16_t hyperlinkHoveredId = 0;
+            std::optional<PointTree::interval> hoveredInterval;
+            // The pattern intervals of each viewport row, if snapshot is true.
+            // The intervals of row y are patternIntervals[patternRowOffsets[y]..patternRowOffsets[y + 1]].
+            std::pmr::vector<PointTree::interval> patternIntervals;
+            std::pmr::vector<size_t> patternRowOffsets;
+            // The clusters of the run that _PaintBufferOutputHelper is about to paint.
+            std::pmr::vector<Cluster> clusters;
+        };
+
         static GridLineSet s_GetGridlines(const TextAttribute& textAttribute) noexcept;
         static bool s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSoftFontChar, const size_t lastSoftFontChar);
 
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
+        void _PrepareFrame(_In_ IRenderEngine* const pEngine);
+        void _SnapshotDirtyRows(_In_ IRenderEngine* const pEngine);
+        void _InvalidateEngines(const PendingInvalidation& invalidation);
+        void _InvalidateEnginesSelection(const std::vector<til::rect>& rectangles);
+        void _QueueInvalidation(const PendingInvalidation& invalidation);
+        void _ApplyPendingInvalidations();
+        static void s_ApplyInvalidation(_In_ IRenderEngine* const pEngine, const PendingInvalidation& invalidation);
+        std::span<const PointTree::interval> _GetPatternIntervalsInRow(const til::CoordType row) const;
         bool _CheckViewportAndScroll();
         [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
@@ -119,6 +196,9 @@ namespace Microsoft::Console::Render
 
         const RenderSettings& _renderSettings;
         std::array<IRenderEngine*, 2> _engines{};
+        // Protects the engines while they're used outside of the console lock.
+        // Anyone who holds both locks must acquire the console lock first.
+        til::recursive_ticket_lock _engineLock;
         IRenderData* _pData = nullptr; // Non-ownership pointer
         std::unique_ptr<RenderThread> _pThread;
         static constexpr size_t _firstSoftFontChar = 0xEF20;
@@ -126,7 +206,6 @@ namespace Microsoft::Console::Render
         uint16_t _hyperlinkHoveredId = 0;
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _hoveredInterval;
         Microsoft::Console::Types::Viewport _viewport;
-        std::vector<Cluster> _clusterBuffer;
         std::vector<til::rect> _previousSelection;
         std::vector<til::rect> _previousSearchSelection;
         std::function<void()> _pfnBackgroundColorChanged;
@@ -135,6 +214,16 @@ namespace Microsoft::Console::Render
         bool _destructing = false;
         bool _forceUpdateViewport = false;
 
+        bool _snapshotPainting = false;
+        std::vector<PendingInvalidation> _pendingInvalidations;
+        std::optional<std::wstring> _pendingTitle;
+        std::wstring _pendingNewText;
+        // Frame-scoped temporaries are allocated from here and released all at once by the next frame.
+        til::pmr::arena _frameArena;
+        FrameState _frame{ &_frameArena };
+        std::unique_ptr<TextBuffer> _snapshotBuffer;
+        std::optional<RenderSettings> _snapshotSettings;
+
 #ifdef UNIT_TESTING
         friend class ConptyOutputTests;
         friend class TerminalCoreUnitTests::ConptyRoundtripTests;
@@ -10,6 +10,18 @@
 
 using namespace Microsoft::Console::Render;
 
+// Once this many lines scrolled by or this much output arrived since the last
+// frame, nobody can read the intermediate frames anymore and we throttle.
+constexpr uint64_t BulkOutputScrollLines = 64;
+constexpr uint64_t BulkOutputCodeUnits = 16 * 1024;
+
+// The reduced frame cadence during bulk output.
+constexpr auto BulkOutputFrameInterval = std::chrono::milliseconds(100);
+
+// If no output arrives for this long, the bulk output is considered to be over.
+// It's also roughly the time a frame takes at the full frame rate.
+constexpr auto BulkOutputIdleTimeout = std::chrono::milliseconds(16);
+
 RenderThread::RenderThread() :
     _pRenderer(nullptr),
     _hThread(nullptr),
@@ -213,14 +225,78 @@ DWORD WINAPI RenderThread::_ThreadProc()
             ResetEvent(_hEvent);
         }
 
+        if (_bulkOutputThrottling.load(std::memory_order_relaxed))
+        {
+            _DeferFrameDuringBulkOutput();
+        }
+
         ResetEvent(_hPaintCompletedEvent);
         LOG_IF_FAILED(_pRenderer->PaintFrame());
         SetEvent(_hPaintCompletedEvent);
+
+        _framesPainted.fetch_add(1, std::memory_order_relaxed);
+        _scrolledLinesAtLastFrame = _scrolledLines.load(std::memory_order_relaxed);
+        _outputCodeUnitsAtLastFrame = _outputCodeUnits.load(std::memory_order_relaxed);
+        _lastFrameTime = std::chrono::steady_clock::now();
     }
 
     return S_OK;
 }
 
+// Method Description:
+// - During bulk output (think `cat` of a huge file) the intermediate frames scroll by
+//   faster than anyone can read them and painting them only steals CPU time from parsing.
+//   In that case this delays the next frame until BulkOutputFrameInterval has passed
+//   since the last one, so that only the latest state of the viewport gets painted.
+// - User input or the output coming to a rest immediately return to the full frame rate.
+void RenderThread::_DeferFrameDuringBulkOutput() noexcept
+{
+    // NotifyUserInput() only signals _hEvent while we're deferring.
+    // We set _deferring before checking _userInput to avoid missing it.
+    _deferring.store(true);
+
+    const auto bulk = _scrolledLines.load(std::memory_order_relaxed) - _scrolledLinesAtLastFrame >= BulkOutputScrollLines ||
+                      _outputCodeUnits.load(std::memory_order_relaxed) - _outputCodeUnitsAtLastFrame >= BulkOutputCodeUnits;
+
+    if (!_userInput.exchange(false) && bulk)
+    {
+        const auto deadline = _lastFrameTime + BulkOutputFrameInterval;
+        auto activity = _Activity();
+
+        for (;;)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+            {
+                break;
+            }
+
+            // NotifyUserInput() and our destructor signal _hEvent to cut this short.
+            const auto timeout = std::min<std::chrono::steady_clock::duration>(deadline - now, BulkOutputIdleTimeout);
+            if (WaitForSingleObject(_hEvent, gsl::narrow_cast<DWORD>(std::chrono::ceil<std::chrono::milliseconds>(timeout).count())) == WAIT_OBJECT_0)
+            {
+                break;
+            }
+
+            const auto newActivity = _Activity();
+            if (newActivity == activity)
+            {
+                break;
+            }
+
+            activity = newActivity;
+            _framesSkipped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    _deferring.store(false);
+}
+
+uint64_t RenderThread::_Activity() const noexcept
+{
+    return _scrolledLines.load(std::memory_order_relaxed) + _outputCodeUnits.load(std::memory_order_relaxed);
+}
+
 void RenderThread::NotifyPaint() noexcept
 {
     if (_fWaiting.load(std::memory_order_acquire))
@@ -233,6 +309,50 @@ void RenderThread::NotifyPaint() noexcept
     }
 }
 
+// Method Description:
+// - Tells the scheduler how much output was just processed.
+//   Used to detect bulk output, during which the frame rate is reduced.
+void RenderThread::NotifyOutput(const size_t codeUnits) noexcept
+{
+    _outputCodeUnits.fetch_add(codeUnits, std::memory_order_relaxed);
+}
+
+// Method Description:
+// - Tells the scheduler that the viewport contents scrolled by the given number of lines.
+void RenderThread::NotifyScroll(const til::CoordType lines) noexcept
+{
+    _scrolledLines.fetch_add(gsl::narrow_cast<uint64_t>(std::abs(lines)), std::memory_order_relaxed);
+}
+
+// Method Description:
+// - Tells the scheduler that the user interacted with the terminal,
+//   which ends any bulk output throttling until the next frame.
+void RenderThread::NotifyUserInput() noexcept
+{
+    _userInput.store(true);
+    if (_deferring.load())
+    {
+        SetEvent(_hEvent);
+    }
+}
+
+// Method Description:
+// - Opts into reducing the frame rate during bulk output. See _DeferFrameDuringBulkOutput.
+void RenderThread::EnableBulkOutputThrottling() noexcept
+{
+    _bulkOutputThrottling.store(true, std::memory_order_relaxed);
+}
+
+RenderThread::Metrics RenderThread::GetMetrics() const noexcept
+{
+    return {
+        .framesPainted = _framesPainted.load(std::memory_order_relaxed),
+        .framesSkipped = _framesSkipped.load(std::memory_order_relaxed),
+        .scrolledLines = _scrolledLines.load(std::memory_order_relaxed),
+        .outputCodeUnits = _outputCodeUnits.load(std::memory_order_relaxed),
+    };
+}
+
 void RenderThread::EnablePainting() noexcept
 {
     SetEvent(_hPaintEnabledEvent);
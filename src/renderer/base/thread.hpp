@@ -21,19 +21,39 @@ namespace Microsoft::Console::Render
     class RenderThread
     {
     public:
+        // Counters to validate the frame scheduling with. The output rate
+        // can be derived by sampling outputCodeUnits at two points in time.
+        struct Metrics
+        {
+            uint64_t framesPainted = 0;
+            // Frames that would've been painted at the full frame rate, but
+            // were skipped because bulk output would've superseded them.
+            uint64_t framesSkipped = 0;
+            uint64_t scrolledLines = 0;
+            uint64_t outputCodeUnits = 0;
+        };
+
         RenderThread();
         ~RenderThread();
 
         [[nodiscard]] HRESULT Initialize(Renderer* const pRendererParent) noexcept;
 
         void NotifyPaint() noexcept;
+        void NotifyOutput(const size_t codeUnits) noexcept;
+        void NotifyScroll(const til::CoordType lines) noexcept;
+        void NotifyUserInput() noexcept;
         void EnablePainting() noexcept;
         void DisablePainting() noexcept;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) noexcept;
 
+        void EnableBulkOutputThrottling() noexcept;
+        Metrics GetMetrics() const noexcept;
+
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
+        void _DeferFrameDuringBulkOutput() noexcept;
+        uint64_t _Activity() const noexcept;
 
         HANDLE _hThread;
         HANDLE _hEvent;
@@ -46,5 +66,18 @@ namespace Microsoft::Console::Render
         bool _fKeepRunning;
         std::atomic<bool> _fNextFrameRequested;
         std::atomic<bool> _fWaiting;
+
+        std::atomic<bool> _bulkOutputThrottling{ false };
+        std::atomic<bool> _deferring{ false };
+        std::atomic<bool> _userInput{ false };
+        std::atomic<uint64_t> _framesPainted{ 0 };
+        std::atomic<uint64_t> _framesSkipped{ 0 };
+        std::atomic<uint64_t> _scrolledLines{ 0 };
+        std::atomic<uint64_t> _outputCodeUnits{ 0 };
+
+        // Only accessed by the render thread.
+        uint64_t _scrolledLinesAtLastFrame = 0;
+        uint64_t _outputCodeUnitsAtLastFrame = 0;
+        std::chrono::steady_clock::time_point _lastFrameTime;
     };
 }
@@ -46,6 +46,8 @@ namespace Microsoft::Console::Render
         virtual til::point GetTextBufferEndPosition() const noexcept = 0;
         virtual const TextBuffer& GetTextBuffer() const noexcept = 0;
         virtual const FontInfo& GetFontInfo() const noexcept = 0;
+        // These allocate their result on the heap, even though the Renderer copies it into its frame
+        // arena right away. Frames with a selection or search highlights are thus never allocation-free.
         virtual std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept = 0;
         virtual std::vector<Microsoft::Console::Types::Viewport> GetSearchSelectionRects() noexcept = 0;
         virtual void LockConsole() noexcept = 0;
@@ -65,6 +67,7 @@ namespace Microsoft::Console::Render
         virtual const std::wstring GetHyperlinkUri(uint16_t id) const = 0;
         virtual const std::wstring GetHyperlinkCustomId(uint16_t id) const = 0;
         virtual const std::vector<size_t> GetPatternId(const til::point location) const = 0;
+        virtual std::span<const interval_tree::IntervalTree<til::point, size_t>::interval> GetPatternIntervalsInRow(const til::CoordType row) const = 0;
 
         // This block used to be IUiaData.
         virtual std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept = 0;
@@ -31,6 +31,7 @@ namespace Microsoft::Console::VirtualTerminal
         virtual bool WriteInput(const std::span<const INPUT_RECORD>& inputEvents) = 0;
 
         virtual bool WriteCtrlKey(const INPUT_RECORD& event) = 0;
+        virtual bool WriteCtrlKeys(const std::span<const INPUT_RECORD>& events) = 0;
 
         virtual bool WriteString(const std::wstring_view string) = 0;
 
@@ -15,7 +15,6 @@
 #include "InteractDispatch.hpp"
 #include "../../host/conddkrefs.h"
 #include "../../interactivity/inc/ServiceLocator.hpp"
-#include "../../interactivity/inc/EventSynthesis.hpp"
 #include "../../types/inc/Viewport.hpp"
 
 using namespace Microsoft::Console::Interactivity;
@@ -57,6 +56,17 @@ bool InteractDispatch::WriteCtrlKey(const INPUT_RECORD& event)
     return true;
 }
 
+// Method Description:
+// - Writes a batch of key events to the host, like WriteCtrlKey does for a single one.
+//   Consecutive ordinary keys are written to the input buffer in a single call.
+// Arguments:
+// - events: The keys to send to the host.
+bool InteractDispatch::WriteCtrlKeys(const std::span<const INPUT_RECORD>& events)
+{
+    HandleGenericKeyEvents(events);
+    return true;
+}
+
 // Method Description:
 // - Writes a string of input to the host.
 // Arguments:
@@ -67,15 +77,10 @@ bool InteractDispatch::WriteString(const std::wstring_view string)
 {
     if (!string.empty())
     {
-        const auto codepage = _api.GetConsoleOutputCP();
-        InputEventQueue keyEvents;
-
-        for (const auto& wch : string)
-        {
-            CharToKeyEvents(wch, codepage, keyEvents);
-        }
-
-        WriteInput(keyEvents);
+        // The InputBuffer stores runs of printable characters as text and only
+        // synthesizes key events for them if they're read via ReadConsoleInput.
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.GetActiveInputBuffer()->WriteString(string, _api.GetConsoleOutputCP());
     }
     return true;
 }
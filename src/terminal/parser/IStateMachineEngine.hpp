@@ -50,6 +50,9 @@ namespace Microsoft::Console::VirtualTerminal
 
         virtual bool ActionSs3Dispatch(const wchar_t wch, const VTParameters parameters) = 0;
 
+        // Called at the end of StateMachine::ProcessString, allowing engines to flush batched up work.
+        virtual bool ActionEndOfString() = 0;
+
     protected:
         IStateMachineEngine() = default;
     };
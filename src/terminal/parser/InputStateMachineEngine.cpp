@@ -116,6 +116,7 @@ void InputStateMachineEngine::SetLookingForDSR(const bool looking) noexcept
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionExecute(const wchar_t wch)
 {
+    _FlushPendingInput();
     return _DoControlCharacter(wch, false);
 }
 
@@ -223,6 +224,8 @@ bool InputStateMachineEngine::_DoControlCharacter(const wchar_t wch, const bool
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 {
+    _FlushPendingInput();
+
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -240,6 +243,8 @@ bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPrint(const wchar_t wch)
 {
+    _FlushPendingInput();
+
     short vkey = 0;
     DWORD modifierState = 0;
     auto success = _GenerateKeyFromChar(wch, vkey, modifierState);
@@ -259,6 +264,8 @@ bool InputStateMachineEngine::ActionPrint(const wchar_t wch)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPrintString(const std::wstring_view string)
 {
+    _FlushPendingInput();
+
     if (string.empty())
     {
         return true;
@@ -275,6 +282,8 @@ bool InputStateMachineEngine::ActionPrintString(const std::wstring_view string)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPassThroughString(const std::wstring_view string)
 {
+    _FlushPendingInput();
+
     if (_pDispatch->IsVtInputEnabled())
     {
         // Synthesize string into key events that we'll write to the buffer
@@ -302,6 +311,8 @@ bool InputStateMachineEngine::ActionPassThroughString(const std::wstring_view st
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionEscDispatch(const VTID id)
 {
+    _FlushPendingInput();
+
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -367,11 +378,28 @@ bool InputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameter
     // INPUT_RECORD back to the same sequence we say here later on, when the
     // client reads it.
     //
-    // Focus events in conpty are special, so don't flush those through either.
+    // Consecutive win32-input-mode keys (for instance from key repeat or automated input)
+    // are batched up, so that they can be written to the input buffer all at once.
+    if (id == CsiActionCodes::Win32KeyboardInput)
+    {
+        if (_pendingMouseMove)
+        {
+            _FlushPendingInput();
+        }
+        _win32InputBatch.push_back(_GenerateWin32Key(parameters));
+        return true;
+    }
+
+    // Mouse reports are flushed by _WriteMouseEvent, so that motion can be coalesced.
+    if (id != CsiActionCodes::MouseDown && id != CsiActionCodes::MouseUp)
+    {
+        _FlushPendingInput();
+    }
+
+    // Focus events in conpty are special, so don't flush those through to the client.
     // See GH#12799, GH#12900 for details
     if (_pDispatch->IsVtInputEnabled() &&
         _pfnFlushToInputQueue &&
-        id != CsiActionCodes::Win32KeyboardInput &&
         id != CsiActionCodes::FocusIn &&
         id != CsiActionCodes::FocusOut)
     {
@@ -441,15 +469,6 @@ bool InputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameter
     case CsiActionCodes::FocusOut:
         success = _pDispatch->FocusChanged(false);
         break;
-    case CsiActionCodes::Win32KeyboardInput:
-    {
-        // Use WriteCtrlKey here, even for keys that _aren't_ control keys,
-        // because that will take extra steps to make sure things like
-        // Ctrl+C, Ctrl+Break are handled correctly.
-        const auto key = _GenerateWin32Key(parameters);
-        success = _pDispatch->WriteCtrlKey(key);
-        break;
-    }
     default:
         success = false;
         break;
@@ -484,6 +503,8 @@ IStateMachineEngine::StringHandler InputStateMachineEngine::ActionDcsDispatch(co
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionSs3Dispatch(const wchar_t wch, const VTParameters /*parameters*/)
 {
+    _FlushPendingInput();
+
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -544,6 +565,49 @@ bool InputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
     return false;
 }
 
+// Method Description:
+// - Triggers the EndOfString action to indicate that the state machine has
+//      finished processing the current string. Flushes any pending input.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the pending input.
+bool InputStateMachineEngine::ActionEndOfString()
+{
+    return _FlushPendingInput();
+}
+
+// Method Description:
+// - Writes out all the win32-input-mode keys collected by ActionCsiDispatch
+//   and the last coalesced mouse motion report, if any. At most one of the two
+//   is pending at a time, so the order of the input is preserved.
+//   Keys are written with WriteCtrlKeys, even for keys that _aren't_ control
+//   keys, because that will take extra steps to make sure things like
+//   Ctrl+C, Ctrl+Break are handled correctly.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the pending input.
+bool InputStateMachineEngine::_FlushPendingInput()
+{
+    auto success = true;
+
+    if (!_win32InputBatch.empty())
+    {
+        success = _pDispatch->WriteCtrlKeys(_win32InputBatch);
+        _win32InputBatch.clear();
+    }
+
+    if (_pendingMouseMove)
+    {
+        const auto event = *_pendingMouseMove;
+        _pendingMouseMove.reset();
+        success = _pDispatch->WriteInput({ &event, 1 }) && success;
+    }
+
+    return success;
+}
+
 // Method Description:
 // - Writes a sequence of keypresses to the buffer based on the wch,
 //      vkey and modifiers passed in. Will create both the appropriate key downs
@@ -695,6 +759,9 @@ bool InputStateMachineEngine::_WriteSingleKey(const short vkey, const DWORD modi
 
 // Method Description:
 // - Writes a Mouse Event Record to the input callback based on the state of the mouse.
+// - Motion reports are held back and replaced by any directly following motion
+//   report with the same button and modifier state. Only the last one of such a
+//   run is written. Clicks and wheel events are never coalesced.
 // Arguments:
 // - column - the X/Column position on the viewport (0 = left-most)
 // - line - the Y/Line/Row position on the viewport (0 = top-most)
@@ -706,6 +773,20 @@ bool InputStateMachineEngine::_WriteSingleKey(const short vkey, const DWORD modi
 bool InputStateMachineEngine::_WriteMouseEvent(const til::point uiPos, const DWORD buttonState, const DWORD controlKeyState, const DWORD eventFlags)
 {
     const auto rgInput = SynthesizeMouseEvent(uiPos, buttonState, controlKeyState, eventFlags);
+
+    if (eventFlags == MOUSE_MOVED)
+    {
+        if (!_pendingMouseMove ||
+            _pendingMouseMove->Event.MouseEvent.dwButtonState != buttonState ||
+            _pendingMouseMove->Event.MouseEvent.dwControlKeyState != controlKeyState)
+        {
+            _FlushPendingInput();
+        }
+        _pendingMouseMove = rgInput;
+        return true;
+    }
+
+    _FlushPendingInput();
     return _pDispatch->WriteInput({ &rgInput, 1 });
 }
 
@@ -161,6 +161,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionSs3Dispatch(const wchar_t wch, const VTParameters parameters) override;
 
+        bool ActionEndOfString() override;
+
         void SetFlushToInputQueueCallback(std::function<bool()> pfnFlushToInputQueue);
 
     private:
@@ -172,6 +174,12 @@ namespace Microsoft::Console::VirtualTerminal
         std::optional<til::point> _lastMouseClickPos{};
         std::optional<std::chrono::steady_clock::time_point> _lastMouseClickTime{};
         std::optional<size_t> _lastMouseClickButton{};
+        // win32-input-mode keys are collected here and written out together
+        // once a different kind of input is encountered or the string ends.
+        InputEventQueue _win32InputBatch;
+        // Consecutive mouse motion reports with the same button and modifier
+        // state are coalesced into this one, which only keeps the last position.
+        std::optional<INPUT_RECORD> _pendingMouseMove;
 
         DWORD _GetCursorKeysModifierState(const VTParameters parameters, const VTID id) noexcept;
         DWORD _GetGenericKeysModifierState(const VTParameters parameters) noexcept;
@@ -192,6 +200,8 @@ namespace Microsoft::Console::VirtualTerminal
         bool _WriteSingleKey(const short vkey, const DWORD modifierState);
         bool _WriteSingleKey(const wchar_t wch, const short vkey, const DWORD modifierState);
 
+        bool _FlushPendingInput();
+
         bool _WriteMouseEvent(const til::point uiPos, const DWORD buttonState, const DWORD controlKeyState, const DWORD eventFlags);
 
         void _GenerateWrappedSequence(const wchar_t wch,
@@ -737,6 +737,19 @@ bool OutputStateMachineEngine::ActionIgnore() noexcept
     return true;
 }
 
+// Routine Description:
+// - Triggers the EndOfString action to indicate that the state machine has
+//      finished processing the current string.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+bool OutputStateMachineEngine::ActionEndOfString() noexcept
+{
+    // do nothing.
+    return true;
+}
+
 // Routine Description:
 // - Triggers the OscDispatch action to indicate that the listener should handle a control sequence.
 //   These sequences perform various API-type commands that can include many parameters.
@@ -5,6 +5,8 @@
 
 #include "stateMachine.hpp"
 
+#include "../../inc/PerfCounters.hpp"
+
 #include "ascii.hpp"
 
 using namespace Microsoft::Console::VirtualTerminal;
@@ -378,6 +380,7 @@ static constexpr bool _isApcIndicator(const wchar_t wch) noexcept
 // - <none>
 void StateMachine::_ActionExecute(const wchar_t wch)
 {
+    PERF_COUNTER_ADD(ParserExecutes, 1);
     _trace.TraceOnExecute(wch);
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionExecute(wch);
@@ -394,6 +397,7 @@ void StateMachine::_ActionExecute(const wchar_t wch)
 // - <none>
 void StateMachine::_ActionExecuteFromEscape(const wchar_t wch)
 {
+    PERF_COUNTER_ADD(ParserExecutes, 1);
     _trace.TraceOnExecuteFromEscape(wch);
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionExecuteFromEscape(wch);
@@ -408,6 +412,7 @@ void StateMachine::_ActionExecuteFromEscape(const wchar_t wch)
 // - <none>
 void StateMachine::_ActionPrint(const wchar_t wch)
 {
+    PERF_COUNTER_ADD(ParserPrintedCodeUnits, 1);
     _trace.TraceOnAction(L"Print");
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionPrint(wch);
@@ -422,6 +427,7 @@ void StateMachine::_ActionPrint(const wchar_t wch)
 // - <none>
 void StateMachine::_ActionPrintString(const std::wstring_view string)
 {
+    PERF_COUNTER_ADD(ParserPrintedCodeUnits, string.size());
     _SafeExecute([=]() {
         return _engine->ActionPrintString(string);
     });
@@ -437,6 +443,7 @@ void StateMachine::_ActionPrintString(const std::wstring_view string)
 // - <none>
 void StateMachine::_ActionEscDispatch(const wchar_t wch)
 {
+    PERF_COUNTER_ADD(ParserEscDispatches, 1);
     _trace.TraceOnAction(L"EscDispatch");
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionEscDispatch(_identifier.Finalize(wch));
@@ -452,6 +459,7 @@ void StateMachine::_ActionEscDispatch(const wchar_t wch)
 // - <none>
 void StateMachine::_ActionVt52EscDispatch(const wchar_t wch)
 {
+    PERF_COUNTER_ADD(ParserVt52Dispatches, 1);
     _trace.TraceOnAction(L"Vt52EscDispatch");
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionVt52EscDispatch(_identifier.Finalize(wch), { _parameters.data(), _parameters.size() });
@@ -467,6 +475,7 @@ void StateMachine::_ActionVt52EscDispatch(const wchar_t wch)
 // - <none>
 void StateMachine::_ActionCsiDispatch(const wchar_t wch)
 {
+    PERF_COUNTER_ADD(ParserCsiDispatches, 1);
     _trace.TraceOnAction(L"CsiDispatch");
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionCsiDispatch(_identifier.Finalize(wch),
@@ -693,6 +702,7 @@ void StateMachine::_ActionOscPut(const wchar_t wch)
 // - <none>
 void StateMachine::_ActionOscDispatch(const wchar_t wch)
 {
+    PERF_COUNTER_ADD(ParserOscDispatches, 1);
     _trace.TraceOnAction(L"OscDispatch");
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionOscDispatch(wch, _oscParameter, _oscString);
@@ -708,6 +718,7 @@ void StateMachine::_ActionOscDispatch(const wchar_t wch)
 // - <none>
 void StateMachine::_ActionSs3Dispatch(const wchar_t wch)
 {
+    PERF_COUNTER_ADD(ParserSs3Dispatches, 1);
     _trace.TraceOnAction(L"Ss3Dispatch");
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionSs3Dispatch(wch, { _parameters.data(), _parameters.size() });
@@ -723,6 +734,7 @@ void StateMachine::_ActionSs3Dispatch(const wchar_t wch)
 // - <none>
 void StateMachine::_ActionDcsDispatch(const wchar_t wch)
 {
+    PERF_COUNTER_ADD(ParserDcsDispatches, 1);
     _trace.TraceOnAction(L"DcsDispatch");
 
     const auto success = _SafeExecute([=]() {
@@ -2078,6 +2090,10 @@ exitWithMask:
 // - <none>
 void StateMachine::ProcessString(const std::wstring_view string)
 {
+    PERF_COUNTER_ADD(ParserStrings, 1);
+    PERF_COUNTER_ADD(ParserCodeUnits, string.size());
+    PERF_HISTOGRAM_RECORD(ParserStringLength, string.size());
+
     size_t i = 0;
     _currentString = string;
     _runOffset = 0;
@@ -2207,6 +2223,8 @@ void StateMachine::ProcessString(const std::wstring_view string)
             cachedSequence.append(run);
         }
     }
+
+    _engine->ActionEndOfString();
 }
 
 // Routine Description:
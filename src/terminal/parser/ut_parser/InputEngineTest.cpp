@@ -266,6 +266,8 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
     TEST_METHOD(SGRMouseTest_Scroll);
     TEST_METHOD(SGRMouseTest_DoubleClick);
     TEST_METHOD(SGRMouseTest_Hover);
+    TEST_METHOD(SGRMouseTest_CoalesceMotion);
+    TEST_METHOD(SGRMouseTest_MotionStress);
     TEST_METHOD(CtrlAltZCtrlAltXTest);
     TEST_METHOD(TestSs3Entry);
     TEST_METHOD(TestSs3Immediate);
@@ -273,6 +275,8 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
 
     TEST_METHOD(TestWin32InputParsing);
     TEST_METHOD(TestWin32InputOptionals);
+    TEST_METHOD(TestWin32InputBatching);
+    TEST_METHOD(TestWin32InputKeyRepeatPerformance);
 
     friend class TestInteractDispatch;
 };
@@ -318,6 +322,7 @@ public:
     virtual bool WriteInput(_In_ const std::span<const INPUT_RECORD>& inputEvents) override;
 
     virtual bool WriteCtrlKey(const INPUT_RECORD& event) override;
+    virtual bool WriteCtrlKeys(const std::span<const INPUT_RECORD>& events) override;
     virtual bool WindowManipulation(const DispatchTypes::WindowManipulationType function,
                                     const VTParameter parameter1,
                                     const VTParameter parameter2) override; // DTTERM_WindowManipulation
@@ -354,6 +359,11 @@ bool TestInteractDispatch::WriteCtrlKey(const INPUT_RECORD& event)
     return WriteInput({ &event, 1 });
 }
 
+bool TestInteractDispatch::WriteCtrlKeys(const std::span<const INPUT_RECORD>& events)
+{
+    return WriteInput(events);
+}
+
 bool TestInteractDispatch::WindowManipulation(const DispatchTypes::WindowManipulationType function,
                                               const VTParameter parameter1,
                                               const VTParameter parameter2)
@@ -1307,6 +1317,104 @@ void InputEngineTest::SGRMouseTest_Hover()
     VerifySGRMouseData(testData);
 }
 
+void InputEngineTest::SGRMouseTest_CoalesceMotion()
+{
+    std::vector<INPUT_RECORD> records;
+    auto pfn = [&](const std::span<const INPUT_RECORD>& events) {
+        records.insert(records.end(), events.begin(), events.end());
+    };
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    StateMachine stateMachine{ std::move(inputEngine) };
+
+    const auto hover = CsiMouseButtonCodes::Released;
+    const auto drag = CsiMouseModifierCodes::Drag;
+
+    std::wstring input;
+    input += GenerateSgrMouseSequence(hover, drag, { 1, 1 }, CsiActionCodes::MouseUp);
+    input += GenerateSgrMouseSequence(hover, drag, { 2, 1 }, CsiActionCodes::MouseUp);
+    input += GenerateSgrMouseSequence(hover, drag, { 3, 1 }, CsiActionCodes::MouseUp);
+    input += GenerateSgrMouseSequence(CsiMouseButtonCodes::Left, 0, { 3, 1 }, CsiActionCodes::MouseDown);
+    input += GenerateSgrMouseSequence(CsiMouseButtonCodes::Left, drag, { 3, 2 }, CsiActionCodes::MouseDown);
+    input += GenerateSgrMouseSequence(CsiMouseButtonCodes::Left, drag, { 3, 3 }, CsiActionCodes::MouseDown);
+    input += GenerateSgrMouseSequence(CsiMouseButtonCodes::Left, drag | CsiMouseModifierCodes::Shift, { 3, 4 }, CsiActionCodes::MouseDown);
+    input += GenerateSgrMouseSequence(CsiMouseButtonCodes::Left, 0, { 3, 4 }, CsiActionCodes::MouseUp);
+    input += GenerateSgrMouseSequence(CsiMouseButtonCodes::ScrollForward, 0, { 3, 4 }, CsiActionCodes::MouseDown);
+    input += GenerateSgrMouseSequence(hover, drag, { 4, 4 }, CsiActionCodes::MouseUp);
+    input += GenerateSgrMouseSequence(hover, drag, { 5, 5 }, CsiActionCodes::MouseUp);
+    stateMachine.ProcessString(input);
+
+    const std::array<INPUT_RECORD, 7> expected{
+        SynthesizeMouseEvent({ 2, 0 }, 0, 0, MOUSE_MOVED),
+        SynthesizeMouseEvent({ 2, 0 }, FROM_LEFT_1ST_BUTTON_PRESSED, 0, 0),
+        SynthesizeMouseEvent({ 2, 2 }, FROM_LEFT_1ST_BUTTON_PRESSED, 0, MOUSE_MOVED),
+        SynthesizeMouseEvent({ 2, 3 }, FROM_LEFT_1ST_BUTTON_PRESSED, SHIFT_PRESSED, MOUSE_MOVED),
+        SynthesizeMouseEvent({ 2, 3 }, 0, 0, 0),
+        SynthesizeMouseEvent({ 2, 3 }, SCROLL_DELTA_FORWARD, 0, MOUSE_WHEELED),
+        SynthesizeMouseEvent({ 4, 4 }, 0, 0, MOUSE_MOVED),
+    };
+
+    VERIFY_ARE_EQUAL(expected.size(), records.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        VERIFY_ARE_EQUAL(expected[i], records[i]);
+    }
+}
+
+void InputEngineTest::SGRMouseTest_MotionStress()
+{
+    static constexpr int eventCount = 10'000;
+    static constexpr int clickInterval = 1'000;
+
+    std::vector<INPUT_RECORD> records;
+    auto pfn = [&](const std::span<const INPUT_RECORD>& events) {
+        records.insert(records.end(), events.begin(), events.end());
+    };
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    StateMachine stateMachine{ std::move(inputEngine) };
+
+    // A stream of hover reports, with a click every now and then.
+    std::wstring input;
+    for (auto i = 0; i < eventCount; i++)
+    {
+        const til::point pos{ i % 80 + 1, i / 80 % 24 + 1 };
+        if (i % clickInterval == clickInterval - 1)
+        {
+            input += GenerateSgrMouseSequence(CsiMouseButtonCodes::Left, 0, pos, CsiActionCodes::MouseDown);
+            input += GenerateSgrMouseSequence(CsiMouseButtonCodes::Left, 0, pos, CsiActionCodes::MouseUp);
+        }
+        else
+        {
+            input += GenerateSgrMouseSequence(CsiMouseButtonCodes::Released, CsiMouseModifierCodes::Drag, pos, CsiActionCodes::MouseUp);
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    stateMachine.ProcessString(input);
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    // Every run of motion reports before a click is coalesced into one,
+    // while none of the button presses and releases may get lost.
+    static constexpr auto clickCount = eventCount / clickInterval;
+    VERIFY_ARE_EQUAL(static_cast<size_t>(clickCount * 3), records.size());
+
+    for (auto i = 0; i < clickCount; i++)
+    {
+        const auto clickIndex = (i + 1) * clickInterval - 1;
+        const til::point pos{ clickIndex % 80, clickIndex / 80 % 24 };
+        const til::point lastMovePos{ (clickIndex - 1) % 80, (clickIndex - 1) / 80 % 24 };
+
+        VERIFY_ARE_EQUAL(SynthesizeMouseEvent(lastMovePos, 0, 0, MOUSE_MOVED), records[i * 3 + 0]);
+        VERIFY_ARE_EQUAL(static_cast<DWORD>(FROM_LEFT_1ST_BUTTON_PRESSED), records[i * 3 + 1].Event.MouseEvent.dwButtonState);
+        VERIFY_ARE_EQUAL(pos, til::wrap_coord(records[i * 3 + 1].Event.MouseEvent.dwMousePosition));
+        VERIFY_ARE_EQUAL(SynthesizeMouseEvent(pos, 0, 0, 0), records[i * 3 + 2]);
+    }
+
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    Log::Comment(NoThrowString().Format(L"Parsed %d mouse reports in %lldus", eventCount, us));
+}
+
 void InputEngineTest::CtrlAltZCtrlAltXTest()
 {
     auto pfn = std::bind(&TestState::TestInputCallback, &testState, std::placeholders::_1);
@@ -1593,3 +1701,65 @@ void InputEngineTest::TestWin32InputOptionals()
         }
     }
 }
+
+void InputEngineTest::TestWin32InputBatching()
+{
+    std::vector<std::vector<INPUT_RECORD>> writes;
+    auto pfn = [&](const std::span<const INPUT_RECORD>& records) {
+        writes.emplace_back(records.begin(), records.end());
+    };
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    StateMachine stateMachine{ std::move(inputEngine) };
+
+    Log::Comment(L"Consecutive win32-input-mode keys should be written at once, in order with other input.");
+    stateMachine.ProcessString(L"\x1b[65;30;97;1;0;1_\x1b[65;30;97;0;0;1_b\x1b[67;46;99;1;0;1_");
+
+    VERIFY_ARE_EQUAL(3u, writes.size());
+
+    VERIFY_ARE_EQUAL(2u, writes[0].size());
+    VERIFY_ARE_EQUAL(SynthesizeKeyEvent(true, 1, 65, 30, L'a', 0), writes[0][0]);
+    VERIFY_ARE_EQUAL(SynthesizeKeyEvent(false, 1, 65, 30, L'a', 0), writes[0][1]);
+
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(writes[1].size(), 1u);
+    VERIFY_ARE_EQUAL(L'b', writes[1][0].Event.KeyEvent.uChar.UnicodeChar);
+
+    VERIFY_ARE_EQUAL(1u, writes[2].size());
+    VERIFY_ARE_EQUAL(SynthesizeKeyEvent(true, 1, 67, 46, L'c', 0), writes[2][0]);
+}
+
+void InputEngineTest::TestWin32InputKeyRepeatPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    static constexpr size_t keyCount = 100'000;
+
+    size_t writeCount = 0;
+    size_t recordCount = 0;
+    auto pfn = [&](const std::span<const INPUT_RECORD>& records) {
+        writeCount++;
+        recordCount += records.size();
+    };
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    StateMachine stateMachine{ std::move(inputEngine) };
+
+    // This is what holding down the "a" key looks like in win32-input-mode.
+    std::wstring input;
+    for (size_t i = 0; i < keyCount; i++)
+    {
+        input.append(L"\x1b[65;30;97;1;0;1_");
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    stateMachine.ProcessString(input);
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    VERIFY_ARE_EQUAL(1u, writeCount);
+    VERIFY_ARE_EQUAL(keyCount, recordCount);
+
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    Log::Comment(NoThrowString().Format(L"Parsed %zu repeated keys in %lldus", keyCount, us));
+}
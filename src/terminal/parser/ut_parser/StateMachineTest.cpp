@@ -68,6 +68,8 @@ public:
 
     bool ActionIgnore() override { return true; };
 
+    bool ActionEndOfString() override { return true; };
+
     bool ActionOscDispatch(const wchar_t /* wch */,
                            const size_t /* parameter */,
                            const std::wstring_view /* string */) override
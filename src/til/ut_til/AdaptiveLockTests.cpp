@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+#include <til/adaptive_lock.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class AdaptiveLockTests
+{
+    BEGIN_TEST_CLASS(AdaptiveLockTests)
+        TEST_CLASS_PROPERTY(L"TestTimeout", L"0:0:30") // 30s timeout
+    END_TEST_CLASS()
+
+    TEST_METHOD(MutualExclusion)
+    {
+        til::adaptive_lock lock;
+        uint64_t counter = 0;
+        std::vector<std::thread> threads;
+
+        for (auto i = 0; i < 4; ++i)
+        {
+            threads.emplace_back([&]() {
+                for (auto j = 0; j < 100000; ++j)
+                {
+                    const std::lock_guard guard{ lock };
+                    counter++;
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        VERIFY_ARE_EQUAL(uint64_t{ 400000 }, counter);
+        VERIFY_IS_TRUE(lock.try_lock());
+        VERIFY_IS_FALSE(lock.try_lock());
+        lock.unlock();
+    }
+
+    TEST_METHOD(Recursion)
+    {
+        til::recursive_adaptive_lock lock;
+        VERIFY_IS_FALSE(lock.is_locked());
+
+        lock.lock();
+        lock.lock();
+        VERIFY_IS_TRUE(lock.is_locked());
+        VERIFY_ARE_EQUAL(2u, lock.recursion_depth());
+
+        {
+            const auto suspension = lock.suspend();
+            VERIFY_IS_FALSE(lock.is_locked());
+
+            // Other threads can acquire the lock while it's suspended.
+            std::thread{ [&]() {
+                const std::lock_guard guard{ lock };
+            } }.join();
+        }
+
+        VERIFY_IS_TRUE(lock.is_locked());
+        VERIFY_ARE_EQUAL(2u, lock.recursion_depth());
+        lock.unlock();
+        lock.unlock();
+        VERIFY_IS_FALSE(lock.is_locked());
+    }
+
+    TEST_METHOD(YieldLetsWaitersGoFirst)
+    {
+        til::recursive_adaptive_lock lock;
+        std::atomic<int> turns{ 0 };
+
+        lock.lock();
+        lock.lock();
+
+        // Without any waiters yield() doesn't release the lock at all.
+        lock.yield();
+        VERIFY_ARE_EQUAL(2u, lock.recursion_depth());
+
+        std::vector<std::thread> threads;
+        for (auto i = 0; i < 2; ++i)
+        {
+            threads.emplace_back([&]() {
+                const std::lock_guard guard{ lock };
+                turns.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+
+        // Give the threads enough time to stop spinning and go to sleep.
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+        VERIFY_ARE_EQUAL(0, turns.load(std::memory_order_relaxed));
+
+        // A plain unlock() + lock() would let us barge right back in.
+        lock.yield();
+        VERIFY_ARE_EQUAL(2, turns.load(std::memory_order_relaxed));
+        VERIFY_ARE_EQUAL(2u, lock.recursion_depth());
+
+        lock.unlock();
+        lock.unlock();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    TEST_METHOD(NoStarvation)
+    {
+        // One thread reacquires the lock right after releasing it, like the VT parser does between
+        // chunks of output. An unfair lock without any starvation protection would let it win
+        // almost every time, but the other thread must still get the lock within a few milliseconds.
+        til::adaptive_lock lock;
+        std::atomic<bool> done{ false };
+
+        std::thread hog{ [&]() {
+            while (!done.load(std::memory_order_relaxed))
+            {
+                const std::lock_guard guard{ lock };
+                const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds{ 50 };
+                while (std::chrono::steady_clock::now() < until)
+                {
+                }
+            }
+        } };
+
+        std::chrono::steady_clock::duration maxWait{};
+        for (auto i = 0; i < 200; ++i)
+        {
+            const auto beg = std::chrono::steady_clock::now();
+            {
+                const std::lock_guard guard{ lock };
+                maxWait = std::max(maxWait, std::chrono::steady_clock::now() - beg);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+        }
+
+        done.store(true, std::memory_order_relaxed);
+        hog.join();
+
+        // starvation_threshold is 1ms, so this leaves plenty of room for the scheduler.
+        const auto maxWaitUs = std::chrono::duration_cast<std::chrono::microseconds>(maxWait).count();
+        Log::Comment(NoThrowString().Format(L"max wait: %lld us", maxWaitUs));
+        VERIFY_IS_LESS_THAN(maxWaitUs, 100000ll);
+    }
+};
@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+// This is the default, but the solution might've been built with /p:OpenConsoleEnablePerfCounters=true.
+#undef CONSOLE_PERF_COUNTERS
+#define CONSOLE_PERF_COUNTERS 0
+#include "../../inc/PerfCounters.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace PerfCounters = Microsoft::Console::PerfCounters;
+using PerfCounters::Counter;
+using PerfCounters::Histogram;
+
+class PerfCountersDisabledTests
+{
+    TEST_CLASS(PerfCountersDisabledTests);
+
+    TEST_METHOD(ProbesAreCompiledOut)
+    {
+        VERIFY_IS_FALSE(PerfCounters::Enabled);
+
+        // The probes must not even evaluate their arguments.
+        auto evaluated = 0;
+        PERF_COUNTER_ADD(ParserStrings, ++evaluated);
+        PERF_HISTOGRAM_RECORD(ParserStringLength, ++evaluated);
+        PERF_HISTOGRAM_SCOPED_DURATION(RendererFrameDuration);
+        VERIFY_ARE_EQUAL(0, evaluated);
+    }
+
+    TEST_METHOD(SnapshotsAreEmpty)
+    {
+        // Even if something calls the functions directly, snapshots stay empty.
+        PerfCounters::Add(Counter::ParserStrings, 1);
+        PerfCounters::Record(Histogram::ParserStringLength, 1);
+        PerfCounters::Reset();
+
+        const auto snapshot = PerfCounters::TakeSnapshot();
+        for (const auto value : snapshot.counters)
+        {
+            VERIFY_ARE_EQUAL(0u, value);
+        }
+        for (const auto& histogram : snapshot.histograms)
+        {
+            VERIFY_ARE_EQUAL(0u, histogram.count);
+            VERIFY_ARE_EQUAL(0u, histogram.sum);
+        }
+        VERIFY_ARE_EQUAL(std::string{}, PerfCounters::FormatSnapshot(snapshot));
+    }
+};
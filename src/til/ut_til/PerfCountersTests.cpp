@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+// The probes are compiled out by default. PerfCountersDisabledTests.cpp covers that configuration.
+#undef CONSOLE_PERF_COUNTERS
+#define CONSOLE_PERF_COUNTERS 1
+#include "../../inc/PerfCounters.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace PerfCounters = Microsoft::Console::PerfCounters;
+using PerfCounters::Counter;
+using PerfCounters::Histogram;
+
+class PerfCountersTests
+{
+    BEGIN_TEST_CLASS(PerfCountersTests)
+        TEST_CLASS_PROPERTY(L"TestTimeout", L"0:0:30") // 30s timeout
+    END_TEST_CLASS()
+
+    TEST_METHOD(ProbesAreCompiledIn)
+    {
+        VERIFY_IS_TRUE(PerfCounters::Enabled);
+
+        PerfCounters::Reset();
+        PERF_COUNTER_ADD(ParserStrings, 2);
+        PERF_COUNTER_ADD(ParserStrings, 3);
+        PERF_HISTOGRAM_RECORD(ParserStringLength, 5);
+        {
+            PERF_HISTOGRAM_SCOPED_DURATION(RendererFrameDuration);
+        }
+
+        const auto snapshot = PerfCounters::TakeSnapshot();
+        VERIFY_ARE_EQUAL(5u, snapshot[Counter::ParserStrings]);
+        VERIFY_ARE_EQUAL(0u, snapshot[Counter::ParserCodeUnits]);
+        VERIFY_ARE_EQUAL(1u, snapshot[Histogram::ParserStringLength].count);
+        VERIFY_ARE_EQUAL(5u, snapshot[Histogram::ParserStringLength].sum);
+        VERIFY_ARE_EQUAL(1u, snapshot[Histogram::RendererFrameDuration].count);
+    }
+
+    TEST_METHOD(HistogramBuckets)
+    {
+        PerfCounters::Reset();
+        for (const auto value : { 0u, 1u, 5u, 1000u })
+        {
+            PERF_HISTOGRAM_RECORD(ParserStringLength, value);
+        }
+
+        const auto snapshot = PerfCounters::TakeSnapshot();
+        const auto& histogram = snapshot[Histogram::ParserStringLength];
+        VERIFY_ARE_EQUAL(4u, histogram.count);
+        VERIFY_ARE_EQUAL(1006u, histogram.sum);
+
+        // Bucket i holds the values with a std::bit_width of i.
+        VERIFY_ARE_EQUAL(1u, histogram.buckets[0]);
+        VERIFY_ARE_EQUAL(1u, histogram.buckets[1]);
+        VERIFY_ARE_EQUAL(1u, histogram.buckets[3]);
+        VERIFY_ARE_EQUAL(1u, histogram.buckets[10]);
+
+        VERIFY_ARE_EQUAL(1u, histogram.Percentile(0.5));
+        VERIFY_ARE_EQUAL(7u, histogram.Percentile(0.75));
+        VERIFY_ARE_EQUAL(1023u, histogram.Percentile(1.0));
+    }
+
+    TEST_METHOD(CountsAreSummedAcrossThreads)
+    {
+        static constexpr auto threadCount = 4;
+        static constexpr auto iterations = 10000;
+
+        PerfCounters::Reset();
+        PERF_COUNTER_ADD(ParserCodeUnits, 1);
+
+        std::atomic<int> finished{ 0 };
+        std::atomic<bool> exit{ false };
+        std::vector<std::thread> threads;
+
+        for (auto i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back([&]() {
+                for (auto j = 0; j < iterations; ++j)
+                {
+                    PERF_COUNTER_ADD(ParserCodeUnits, 1);
+                    PERF_HISTOGRAM_RECORD(ParserStringLength, 3);
+                }
+                finished.fetch_add(1, std::memory_order_release);
+                while (!exit.load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        while (finished.load(std::memory_order_acquire) != threadCount)
+        {
+            std::this_thread::yield();
+        }
+
+        static constexpr uint64_t expected = threadCount * iterations;
+
+        // The counts of threads that are still running...
+        auto snapshot = PerfCounters::TakeSnapshot();
+        VERIFY_ARE_EQUAL(expected + 1, snapshot[Counter::ParserCodeUnits]);
+        VERIFY_ARE_EQUAL(expected, snapshot[Histogram::ParserStringLength].count);
+        VERIFY_ARE_EQUAL(expected * 3, snapshot[Histogram::ParserStringLength].sum);
+
+        exit.store(true, std::memory_order_release);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        // ...aren't lost once they've exited.
+        snapshot = PerfCounters::TakeSnapshot();
+        VERIFY_ARE_EQUAL(expected + 1, snapshot[Counter::ParserCodeUnits]);
+        VERIFY_ARE_EQUAL(expected, snapshot[Histogram::ParserStringLength].count);
+        VERIFY_ARE_EQUAL(expected * 3, snapshot[Histogram::ParserStringLength].sum);
+    }
+
+    TEST_METHOD(ResetOnlyHidesEarlierCounts)
+    {
+        PERF_COUNTER_ADD(BufferReflows, 10);
+        PERF_HISTOGRAM_RECORD(TerminalLockWait, 100);
+        std::thread{ []() {
+            PERF_COUNTER_ADD(BufferReflows, 10);
+        } }.join();
+
+        PerfCounters::Reset();
+
+        auto snapshot = PerfCounters::TakeSnapshot();
+        VERIFY_ARE_EQUAL(0u, snapshot[Counter::BufferReflows]);
+        VERIFY_ARE_EQUAL(0u, snapshot[Histogram::TerminalLockWait].count);
+        VERIFY_ARE_EQUAL(0u, snapshot[Histogram::TerminalLockWait].sum);
+        VERIFY_ARE_EQUAL(0u, snapshot[Histogram::TerminalLockWait].buckets[7]);
+
+        PERF_COUNTER_ADD(BufferReflows, 1);
+        PERF_HISTOGRAM_RECORD(TerminalLockWait, 100);
+        std::thread{ []() {
+            PERF_COUNTER_ADD(BufferReflows, 1);
+        } }.join();
+
+        snapshot = PerfCounters::TakeSnapshot();
+        VERIFY_ARE_EQUAL(2u, snapshot[Counter::BufferReflows]);
+        VERIFY_ARE_EQUAL(1u, snapshot[Histogram::TerminalLockWait].count);
+        VERIFY_ARE_EQUAL(100u, snapshot[Histogram::TerminalLockWait].sum);
+        VERIFY_ARE_EQUAL(1u, snapshot[Histogram::TerminalLockWait].buckets[7]);
+        VERIFY_ARE_EQUAL("BufferReflows                             2\n"
+                         "TerminalLockWait                          1 samples, mean 100, p50 <= 127, p99 <= 127, max <= 127\n",
+                         PerfCounters::FormatSnapshot(snapshot));
+    }
+};
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+// Forwards to new/delete and counts the outstanding allocations.
+struct CountingResource : std::pmr::memory_resource
+{
+    size_t allocations = 0;
+    size_t outstanding = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        allocations++;
+        outstanding++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+    {
+        outstanding--;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+class PmrTests
+{
+    TEST_CLASS(PmrTests);
+
+    TEST_METHOD(ArenaReachesSteadyState)
+    {
+        CountingResource upstream;
+
+        {
+            til::pmr::arena arena{ 256, &upstream };
+
+            // Simulates frames of the same size, where each frame allocates a little more than the initial size.
+            for (auto frame = 0; frame < 4; ++frame)
+            {
+                arena.reset();
+
+                std::pmr::vector<int> a{ &arena };
+                std::pmr::vector<til::rect> b{ &arena };
+                for (auto i = 0; i < 100; ++i)
+                {
+                    a.emplace_back(i);
+                    b.emplace_back(i, i, i + 1, i + 1);
+                }
+
+                if (frame == 0)
+                {
+                    VERIFY_IS_GREATER_THAN(arena.upstream_allocations(), 1u);
+                }
+                else if (frame == 1)
+                {
+                    // The first reset() replaced all blocks with a single one that's large enough.
+                    VERIFY_ARE_EQUAL(1u, arena.upstream_allocations());
+                }
+                else
+                {
+                    VERIFY_ARE_EQUAL(0u, arena.upstream_allocations());
+                }
+                VERIFY_IS_GREATER_THAN_OR_EQUAL(arena.bytes_used(), 100 * (sizeof(int) + sizeof(til::rect)));
+            }
+
+            VERIFY_ARE_EQUAL(1u, upstream.outstanding);
+        }
+
+        VERIFY_ARE_EQUAL(0u, upstream.outstanding);
+    }
+
+    TEST_METHOD(ArenaAlignment)
+    {
+        til::pmr::arena arena{ 256 };
+
+        for (const auto alignment : { 1u, 2u, 4u, 8u, 16u, 64u, 256u })
+        {
+            // Misalign the arena on purpose before each allocation.
+            std::ignore = arena.allocate(1, 1);
+            const auto ptr = arena.allocate(alignment, alignment);
+            VERIFY_ARE_EQUAL(0u, reinterpret_cast<uintptr_t>(ptr) % alignment);
+        }
+
+        // Larger than the initial size.
+        const auto ptr = arena.allocate(4096, 128);
+        VERIFY_ARE_EQUAL(0u, reinterpret_cast<uintptr_t>(ptr) % 128);
+    }
+
+    TEST_METHOD(ArenaReset)
+    {
+        til::pmr::arena arena{ 256 };
+
+        const auto first = arena.allocate(16, 16);
+        std::ignore = arena.allocate(16, 16);
+        VERIFY_ARE_EQUAL(32u, arena.bytes_used());
+
+        // With a single block reset() rewinds it, so the memory is handed out again.
+        arena.reset();
+        VERIFY_ARE_EQUAL(0u, arena.bytes_used());
+        VERIFY_ARE_EQUAL(0u, arena.upstream_allocations());
+        VERIFY_ARE_EQUAL(first, arena.allocate(16, 16));
+    }
+};
@@ -57,6 +57,8 @@ class SPSCTests
     TEST_METHOD(DropSameRevolutionTest);
     TEST_METHOD(DropDifferentRevolutionTest);
     TEST_METHOD(IntegrationTest);
+    TEST_METHOD(BatchTest);
+    TEST_METHOD(BatchIntegrationTest);
 };
 
 void SPSCTests::SmokeTest()
@@ -88,6 +90,16 @@ void SPSCTests::SmokeTest()
     auto x = rx.pop();
     rx.pop_n(til::spsc::block_initially, data.begin(), data.size());
     rx.pop_n(til::spsc::block_forever, data.begin(), data.size());
+
+    // batches
+    tx.reserve(2);
+    tx.commit(0);
+    tx.try_reserve(2);
+    tx.commit(0);
+    rx.peek(2);
+    rx.release(0);
+    rx.try_peek(2);
+    rx.release(0);
 }
 
 void SPSCTests::DropEmptyTest()
@@ -227,3 +239,108 @@ void SPSCTests::IntegrationTest()
 
     t.join();
 }
+
+void SPSCTests::BatchTest()
+{
+    auto [tx, rx] = til::spsc::channel<int>(5);
+
+    {
+        // Committing less than was reserved leaves the rest unused.
+        auto [slots, ok] = tx.reserve(4);
+        VERIFY_IS_TRUE(ok);
+        VERIFY_ARE_EQUAL(4u, slots.size());
+        std::iota(slots.begin(), slots.end(), 0);
+        tx.commit(3);
+    }
+    {
+        // Releasing less than was peeked leaves the rest in the queue.
+        auto [items, ok] = rx.peek(10);
+        VERIFY_IS_TRUE(ok);
+        VERIFY_ARE_EQUAL(3u, items.size());
+        VERIFY_ARE_EQUAL(0, items[0]);
+        VERIFY_ARE_EQUAL(2, items[2]);
+        rx.release(2);
+    }
+    {
+        // The free slots are [3, 5) and [0, 2), which is returned as two separate spans.
+        auto [slots1, ok1] = tx.reserve(10);
+        VERIFY_ARE_EQUAL(2u, slots1.size());
+        std::iota(slots1.begin(), slots1.end(), 3);
+        tx.commit(slots1.size());
+
+        auto [slots2, ok2] = tx.try_reserve(10);
+        VERIFY_ARE_EQUAL(2u, slots2.size());
+        std::iota(slots2.begin(), slots2.end(), 5);
+        tx.commit(slots2.size());
+
+        auto [slots3, ok3] = tx.try_reserve(10);
+        VERIFY_IS_TRUE(ok3);
+        VERIFY_IS_TRUE(slots3.empty());
+    }
+    {
+        // The queue now contains 2 to 6, wrapping around the end of the ring buffer.
+        std::vector<int> actual;
+        while (actual.size() < 5)
+        {
+            auto [items, ok] = rx.peek(10);
+            actual.insert(actual.end(), items.begin(), items.end());
+            rx.release(items.size());
+        }
+        VERIFY_IS_TRUE((actual == std::vector<int>{ 2, 3, 4, 5, 6 }));
+
+        auto [items, ok] = rx.try_peek(10);
+        VERIFY_IS_TRUE(ok);
+        VERIFY_IS_TRUE(items.empty());
+    }
+
+    VERIFY_THROWS(tx.commit(1), std::out_of_range);
+    VERIFY_THROWS(rx.release(1), std::out_of_range);
+
+    // The element-wise API continues where the batches left off.
+    tx.emplace(7);
+    VERIFY_ARE_EQUAL(7, rx.pop());
+
+    drop(tx);
+    auto [items, ok] = rx.peek(10);
+    VERIFY_IS_FALSE(ok);
+    VERIFY_IS_TRUE(items.empty());
+}
+
+void SPSCTests::BatchIntegrationTest()
+{
+    auto [tx, rx] = til::spsc::channel<uint8_t>(61);
+    constexpr size_t total = 100000;
+
+    std::thread t([tx = std::move(tx)]() mutable {
+        size_t written = 0;
+        for (size_t batch = 1; written < total; batch = batch % 97 + 1)
+        {
+            auto [slots, ok] = tx.reserve(std::min(batch, total - written));
+            for (auto& slot : slots)
+            {
+                slot = static_cast<uint8_t>(written++);
+            }
+            tx.commit(slots.size());
+        }
+    });
+
+    size_t read = 0;
+    size_t mismatches = 0;
+    for (size_t batch = 1;; batch = batch % 89 + 1)
+    {
+        auto [items, ok] = rx.peek(batch);
+        if (!ok)
+        {
+            break;
+        }
+        for (const auto item : items)
+        {
+            mismatches += item != static_cast<uint8_t>(read++);
+        }
+        rx.release(items.size());
+    }
+
+    VERIFY_ARE_EQUAL(total, read);
+    VERIFY_ARE_EQUAL(0u, mismatches);
+    t.join();
+}
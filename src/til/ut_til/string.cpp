@@ -181,4 +181,81 @@ class StringTests
         VERIFY_IS_TRUE(til::is_legal_path(LR"(C:\Users\Documents and Settings\Users\;\Why not)"));
         VERIFY_IS_FALSE(til::is_legal_path(LR"(C:\Users\Documents and Settings\"Quote-un-quote users")"));
     }
+
+    TEST_METHOD(FindNotSpace)
+    {
+        WEX::TestExecution::SetVerifyOutput settings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+
+        // Test every length up to a couple of vector widths with the non-space characters in
+        // every position, so that all combinations of vectorized and scalar code paths are covered.
+        for (size_t length = 0; length <= 40; ++length)
+        {
+            std::wstring str(length, L' ');
+            VERIFY_ARE_EQUAL(std::wstring_view::npos, til::find_first_not_space(str));
+            VERIFY_ARE_EQUAL(std::wstring_view::npos, til::find_last_not_space(str));
+            VERIFY_IS_TRUE(til::is_all_spaces(str));
+
+            for (size_t i = 0; i < length; ++i)
+            {
+                for (size_t j = i; j < length; ++j)
+                {
+                    str.assign(length, L' ');
+                    // U+2020 shares its lower byte with a space, which catches kernels that compare bytes instead of words.
+                    str[i] = L'\x2020';
+                    str[j] = L'a';
+                    VERIFY_ARE_EQUAL(i, til::find_first_not_space(str));
+                    VERIFY_ARE_EQUAL(j, til::find_last_not_space(str));
+                    VERIFY_IS_FALSE(til::is_all_spaces(str));
+                }
+            }
+        }
+    }
+
+    TEST_METHOD(FindNotSpacePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        // Typical rows are mostly whitespace: a prompt or a short line of output followed by padding.
+        static constexpr std::array<size_t, 4> widths{ 80, 120, 240, 400 };
+        static constexpr size_t iterations = 1000000;
+
+        const auto measure = [](const std::wstring& row, auto&& func) {
+            using namespace std::chrono;
+
+            size_t sum = 0;
+            const auto beg = steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                sum += func(std::wstring_view{ row });
+            }
+            const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - beg);
+            // Prevent the compiler from optimizing the loop away.
+            VERIFY_ARE_NOT_EQUAL(size_t{ 0 }, sum);
+            return static_cast<double>(elapsed.count()) / iterations;
+        };
+
+        for (const auto width : widths)
+        {
+            std::wstring row(width, L' ');
+            row.replace(0, 16, L"PS C:\\Users> dir");
+
+            const auto scalarTrailing = measure(row, [](std::wstring_view str) { return str.find_last_not_of(L' ') + 1; });
+            const auto vectorTrailing = measure(row, [](std::wstring_view str) { return til::find_last_not_space(str) + 1; });
+
+            row.assign(width, L' ');
+            row.back() = L'x';
+            const auto scalarLeading = measure(row, [](std::wstring_view str) { return str.find_first_not_of(L' ') + 1; });
+            const auto vectorLeading = measure(row, [](std::wstring_view str) { return til::find_first_not_space(str) + 1; });
+
+            Log::Comment(NoThrowString().Format(
+                L"%3zu columns: find_last_not_space %.1fns (scalar %.1fns), find_first_not_space %.1fns (scalar %.1fns)",
+                width,
+                vectorTrailing,
+                scalarTrailing,
+                vectorLeading,
+                scalarLeading));
+        }
+    }
 };
@@ -0,0 +1,382 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "HeadlessTerminal.hpp"
+
+#include "../../terminal/adapter/adaptDispatch.hpp"
+#include "../../terminal/parser/OutputStateMachineEngine.hpp"
+#include "../../types/inc/utils.hpp"
+
+using namespace VtFuzz;
+using namespace Microsoft::Console;
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+using namespace Microsoft::Console::VirtualTerminal;
+
+HeadlessTerminal::HeadlessTerminal(const til::size viewportSize, const til::CoordType scrollbackLines) :
+    _renderer{ _renderSettings, this, nullptr, 0, nullptr },
+    _mutableViewport{ Viewport::FromDimensions({ 0, 0 }, viewportSize) }
+{
+    _renderer.AddRenderEngine(&_engine);
+
+    // This matches Terminal::Create().
+    const til::size bufferSize{ viewportSize.width, Utils::ClampToShortMax(viewportSize.height + scrollbackLines, 1) };
+    _mainBuffer = std::make_unique<TextBuffer>(bufferSize, TextAttribute{}, 12, true, _renderer);
+
+    auto dispatch = std::make_unique<AdaptDispatch>(*this, _renderer, _renderSettings, _terminalInput);
+    auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+    _stateMachine = std::make_unique<StateMachine>(std::move(engine));
+    _stateMachine->SetParserMode(StateMachine::Mode::AlwaysAcceptC1, true);
+
+    _renderer.EnablePainting();
+}
+
+void HeadlessTerminal::Write(const std::wstring_view text)
+{
+    _stateMachine->ProcessString(text);
+}
+
+TextBuffer& HeadlessTerminal::_activeBuffer() const noexcept
+{
+    return _altBuffer ? *_altBuffer : *_mainBuffer;
+}
+
+Viewport HeadlessTerminal::_getMutableViewport() const noexcept
+{
+    // The alt buffer is exactly the size of the viewport, which is thus fixed at 0,0.
+    return _altBuffer ? Viewport::FromDimensions(_mutableViewport.Dimensions()) : _mutableViewport;
+}
+
+#pragma region ITerminalApi
+
+void HeadlessTerminal::ReturnResponse(const std::wstring_view /*response*/)
+{
+}
+
+StateMachine& HeadlessTerminal::GetStateMachine() noexcept
+{
+    return *_stateMachine;
+}
+
+TextBuffer& HeadlessTerminal::GetTextBuffer() noexcept
+{
+    return _activeBuffer();
+}
+
+til::rect HeadlessTerminal::GetViewport() const noexcept
+{
+    return til::rect{ _getMutableViewport().ToInclusive() };
+}
+
+void HeadlessTerminal::SetViewportPosition(const til::point position) noexcept
+try
+{
+    if (!_altBuffer)
+    {
+        _mutableViewport = Viewport::FromDimensions(position, _mutableViewport.Dimensions());
+        // There's no render thread that would pick up the new viewport position on the next frame.
+        // Without this the Renderer would clip all invalidations to the initial viewport.
+        _renderer.TriggerScroll();
+    }
+}
+CATCH_LOG()
+
+bool HeadlessTerminal::IsVtInputEnabled() const noexcept
+{
+    return false;
+}
+
+void HeadlessTerminal::SetTextAttributes(const TextAttribute& attrs) noexcept
+{
+    _activeBuffer().SetCurrentAttributes(attrs);
+}
+
+void HeadlessTerminal::SetSystemMode(const Mode mode, const bool enabled) noexcept
+{
+    _systemMode.set(mode, enabled);
+}
+
+bool HeadlessTerminal::GetSystemMode(const Mode mode) const noexcept
+{
+    return _systemMode.test(mode);
+}
+
+void HeadlessTerminal::WarningBell() noexcept
+{
+}
+
+void HeadlessTerminal::SetWindowTitle(const std::wstring_view title)
+{
+    _title = title;
+}
+
+void HeadlessTerminal::UseAlternateScreenBuffer(const TextAttribute& attrs)
+{
+    const auto& mainCursor = _mainBuffer->GetCursor();
+
+    _altBuffer = std::make_unique<TextBuffer>(_mutableViewport.Dimensions(), attrs, mainCursor.GetSize(), true, _renderer);
+    _mainBuffer->SetAsActiveBuffer(false);
+
+    auto& altCursor = _altBuffer->GetCursor();
+    altCursor.SetStyle(mainCursor.GetSize(), mainCursor.GetType());
+    altCursor.SetIsVisible(mainCursor.IsVisible());
+    altCursor.SetBlinkingAllowed(mainCursor.IsBlinkingAllowed());
+    altCursor.SetPosition(mainCursor.GetPosition() - til::point{ 0, _mutableViewport.Top() });
+
+    _terminalInput.UseAlternateScreenBuffer();
+    _activeBuffer().TriggerRedrawAll();
+}
+
+void HeadlessTerminal::UseMainScreenBuffer()
+{
+    const auto altBuffer = std::exchange(_altBuffer, nullptr);
+    if (!altBuffer)
+    {
+        return;
+    }
+
+    _mainBuffer->SetAsActiveBuffer(true);
+
+    const auto& altCursor = altBuffer->GetCursor();
+    auto& mainCursor = _mainBuffer->GetCursor();
+    mainCursor.SetStyle(altCursor.GetSize(), altCursor.GetType());
+    mainCursor.SetIsVisible(altCursor.IsVisible());
+    mainCursor.SetBlinkingAllowed(altCursor.IsBlinkingAllowed());
+    mainCursor.SetPosition(altCursor.GetPosition() + til::point{ 0, _mutableViewport.Top() });
+
+    _terminalInput.UseMainScreenBuffer();
+    _activeBuffer().TriggerRedrawAll();
+}
+
+CursorType HeadlessTerminal::GetUserDefaultCursorStyle() const noexcept
+{
+    return CursorType::Legacy;
+}
+
+void HeadlessTerminal::ShowWindow(bool /*showOrHide*/) noexcept
+{
+}
+
+void HeadlessTerminal::SetConsoleOutputCP(const unsigned int /*codepage*/) noexcept
+{
+}
+
+unsigned int HeadlessTerminal::GetConsoleOutputCP() const noexcept
+{
+    return CP_UTF8;
+}
+
+void HeadlessTerminal::CopyToClipboard(const std::wstring_view /*content*/) noexcept
+{
+}
+
+void HeadlessTerminal::SetTaskbarProgress(const DispatchTypes::TaskbarState /*state*/, const size_t /*progress*/) noexcept
+{
+}
+
+void HeadlessTerminal::SetWorkingDirectory(const std::wstring_view /*uri*/) noexcept
+{
+}
+
+void HeadlessTerminal::PlayMidiNote(const int /*noteNumber*/, const int /*velocity*/, const std::chrono::microseconds /*duration*/) noexcept
+{
+}
+
+bool HeadlessTerminal::ResizeWindow(const til::CoordType /*width*/, const til::CoordType /*height*/) noexcept
+{
+    return false;
+}
+
+bool HeadlessTerminal::IsConsolePty() const noexcept
+{
+    return false;
+}
+
+void HeadlessTerminal::NotifyAccessibilityChange(const til::rect& /*changedRect*/) noexcept
+{
+}
+
+void HeadlessTerminal::NotifyBufferRotation(const int /*delta*/) noexcept
+{
+}
+
+void HeadlessTerminal::MarkPrompt(const ScrollMark& /*mark*/) noexcept
+{
+}
+
+void HeadlessTerminal::MarkCommandStart() noexcept
+{
+}
+
+void HeadlessTerminal::MarkOutputStart() noexcept
+{
+}
+
+void HeadlessTerminal::MarkCommandFinish(std::optional<unsigned int> /*error*/) noexcept
+{
+}
+
+void HeadlessTerminal::InvokeCompletions(std::wstring_view /*menuJson*/, unsigned int /*replaceLength*/) noexcept
+{
+}
+
+#pragma endregion
+
+#pragma region IRenderData
+
+Viewport HeadlessTerminal::GetViewport() noexcept
+{
+    // There's no user scrolling, so the visible viewport is always the mutable one.
+    return _getMutableViewport();
+}
+
+til::point HeadlessTerminal::GetTextBufferEndPosition() const noexcept
+{
+    const auto viewport = _getMutableViewport();
+    return { viewport.RightInclusive(), viewport.BottomInclusive() };
+}
+
+const TextBuffer& HeadlessTerminal::GetTextBuffer() const noexcept
+{
+    return _activeBuffer();
+}
+
+const FontInfo& HeadlessTerminal::GetFontInfo() const noexcept
+{
+    return _fontInfo;
+}
+
+std::vector<Viewport> HeadlessTerminal::GetSelectionRects() noexcept
+{
+    return {};
+}
+
+std::vector<Viewport> HeadlessTerminal::GetSearchSelectionRects() noexcept
+{
+    return {};
+}
+
+void HeadlessTerminal::LockConsole() noexcept
+{
+}
+
+void HeadlessTerminal::UnlockConsole() noexcept
+{
+}
+
+til::point HeadlessTerminal::GetCursorPosition() const noexcept
+{
+    return _activeBuffer().GetCursor().GetPosition();
+}
+
+bool HeadlessTerminal::IsCursorVisible() const noexcept
+{
+    return _activeBuffer().GetCursor().IsVisible();
+}
+
+bool HeadlessTerminal::IsCursorOn() const noexcept
+{
+    return _activeBuffer().GetCursor().IsOn();
+}
+
+ULONG HeadlessTerminal::GetCursorHeight() const noexcept
+{
+    return _activeBuffer().GetCursor().GetSize();
+}
+
+CursorType HeadlessTerminal::GetCursorStyle() const noexcept
+{
+    return _activeBuffer().GetCursor().GetType();
+}
+
+ULONG HeadlessTerminal::GetCursorPixelWidth() const noexcept
+{
+    return 1;
+}
+
+bool HeadlessTerminal::IsCursorDoubleWidth() const
+{
+    const auto& buffer = _activeBuffer();
+    const auto position = buffer.GetCursor().GetPosition();
+    return buffer.GetRowByOffset(position.y).DbcsAttrAt(position.x) != DbcsAttribute::Single;
+}
+
+const std::vector<RenderOverlay> HeadlessTerminal::GetOverlays() const noexcept
+{
+    return {};
+}
+
+const bool HeadlessTerminal::IsGridLineDrawingAllowed() noexcept
+{
+    return true;
+}
+
+const std::wstring_view HeadlessTerminal::GetConsoleTitle() const noexcept
+{
+    return _title;
+}
+
+const std::wstring HeadlessTerminal::GetHyperlinkUri(uint16_t id) const
+{
+    return _activeBuffer().GetHyperlinkUriFromId(id);
+}
+
+const std::wstring HeadlessTerminal::GetHyperlinkCustomId(uint16_t id) const
+{
+    return _activeBuffer().GetCustomIdFromId(id);
+}
+
+const std::vector<size_t> HeadlessTerminal::GetPatternId(const til::point /*location*/) const
+{
+    return {};
+}
+
+std::span<const interval_tree::IntervalTree<til::point, size_t>::interval> HeadlessTerminal::GetPatternIntervalsInRow(const til::CoordType /*row*/) const
+{
+    return {};
+}
+
+std::pair<COLORREF, COLORREF> HeadlessTerminal::GetAttributeColors(const TextAttribute& attr) const noexcept
+{
+    return _renderSettings.GetAttributeColors(attr);
+}
+
+const bool HeadlessTerminal::IsSelectionActive() const noexcept
+{
+    return false;
+}
+
+const bool HeadlessTerminal::IsBlockSelection() const noexcept
+{
+    return false;
+}
+
+void HeadlessTerminal::ClearSelection() noexcept
+{
+}
+
+void HeadlessTerminal::SelectNewRegion(const til::point /*coordStart*/, const til::point /*coordEnd*/) noexcept
+{
+}
+
+void HeadlessTerminal::SelectSearchRegions(std::vector<til::inclusive_rect> /*source*/) noexcept
+{
+}
+
+const til::point HeadlessTerminal::GetSelectionAnchor() const noexcept
+{
+    return {};
+}
+
+const til::point HeadlessTerminal::GetSelectionEnd() const noexcept
+{
+    return {};
+}
+
+const bool HeadlessTerminal::IsUiaDataInitialized() const noexcept
+{
+    return true;
+}
+
+#pragma endregion
@@ -0,0 +1,144 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- HeadlessTerminal.hpp
+
+Abstract:
+- Wires StateMachine, OutputStateMachineEngine, AdaptDispatch and TextBuffer together
+  without a console host, a terminal control or a window. The ITerminalApi callbacks
+  that would reach the UI are stubs and the Renderer has a single NullRenderEngine,
+  which accepts invalidations, but never paints.
+- This is what vtfuzz runs its inputs against: It exercises the parser, the adapter and
+  the text buffer (including the invalidation bookkeeping), but nothing else.
+--*/
+
+#pragma once
+
+#include "NullRenderEngine.hpp"
+
+#include "../../inc/DefaultSettings.h"
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/base/renderer.hpp"
+#include "../../renderer/inc/IRenderData.hpp"
+#include "../../terminal/adapter/ITerminalApi.hpp"
+#include "../../terminal/input/terminalInput.hpp"
+#include "../../terminal/parser/stateMachine.hpp"
+#include "../../types/inc/Viewport.hpp"
+
+namespace VtFuzz
+{
+    class HeadlessTerminal final :
+        public Microsoft::Console::VirtualTerminal::ITerminalApi,
+        public Microsoft::Console::Render::IRenderData
+    {
+        using RenderSettings = Microsoft::Console::Render::RenderSettings;
+        using Viewport = Microsoft::Console::Types::Viewport;
+
+    public:
+        HeadlessTerminal(const til::size viewportSize, const til::CoordType scrollbackLines);
+
+        void Write(const std::wstring_view text);
+
+#pragma region ITerminalApi
+        void ReturnResponse(const std::wstring_view response) override;
+
+        Microsoft::Console::VirtualTerminal::StateMachine& GetStateMachine() noexcept override;
+        TextBuffer& GetTextBuffer() noexcept override;
+        til::rect GetViewport() const noexcept override;
+        void SetViewportPosition(const til::point position) noexcept override;
+
+        bool IsVtInputEnabled() const noexcept override;
+
+        void SetTextAttributes(const TextAttribute& attrs) noexcept override;
+
+        void SetSystemMode(const Mode mode, const bool enabled) noexcept override;
+        bool GetSystemMode(const Mode mode) const noexcept override;
+
+        void WarningBell() noexcept override;
+        void SetWindowTitle(const std::wstring_view title) override;
+        void UseAlternateScreenBuffer(const TextAttribute& attrs) override;
+        void UseMainScreenBuffer() override;
+
+        CursorType GetUserDefaultCursorStyle() const noexcept override;
+
+        void ShowWindow(bool showOrHide) noexcept override;
+
+        void SetConsoleOutputCP(const unsigned int codepage) noexcept override;
+        unsigned int GetConsoleOutputCP() const noexcept override;
+
+        void CopyToClipboard(const std::wstring_view content) noexcept override;
+        void SetTaskbarProgress(const Microsoft::Console::VirtualTerminal::DispatchTypes::TaskbarState state, const size_t progress) noexcept override;
+        void SetWorkingDirectory(const std::wstring_view uri) noexcept override;
+        void PlayMidiNote(const int noteNumber, const int velocity, const std::chrono::microseconds duration) noexcept override;
+
+        bool ResizeWindow(const til::CoordType width, const til::CoordType height) noexcept override;
+        bool IsConsolePty() const noexcept override;
+
+        void NotifyAccessibilityChange(const til::rect& changedRect) noexcept override;
+        void NotifyBufferRotation(const int delta) noexcept override;
+
+        void MarkPrompt(const ScrollMark& mark) noexcept override;
+        void MarkCommandStart() noexcept override;
+        void MarkOutputStart() noexcept override;
+        void MarkCommandFinish(std::optional<unsigned int> error) noexcept override;
+
+        void InvokeCompletions(std::wstring_view menuJson, unsigned int replaceLength) noexcept override;
+#pragma endregion
+
+#pragma region IRenderData
+        Viewport GetViewport() noexcept override;
+        til::point GetTextBufferEndPosition() const noexcept override;
+        const TextBuffer& GetTextBuffer() const noexcept override;
+        const FontInfo& GetFontInfo() const noexcept override;
+        std::vector<Viewport> GetSelectionRects() noexcept override;
+        std::vector<Viewport> GetSearchSelectionRects() noexcept override;
+        void LockConsole() noexcept override;
+        void UnlockConsole() noexcept override;
+
+        til::point GetCursorPosition() const noexcept override;
+        bool IsCursorVisible() const noexcept override;
+        bool IsCursorOn() const noexcept override;
+        ULONG GetCursorHeight() const noexcept override;
+        CursorType GetCursorStyle() const noexcept override;
+        ULONG GetCursorPixelWidth() const noexcept override;
+        bool IsCursorDoubleWidth() const override;
+        const std::vector<Microsoft::Console::Render::RenderOverlay> GetOverlays() const noexcept override;
+        const bool IsGridLineDrawingAllowed() noexcept override;
+        const std::wstring_view GetConsoleTitle() const noexcept override;
+        const std::wstring GetHyperlinkUri(uint16_t id) const override;
+        const std::wstring GetHyperlinkCustomId(uint16_t id) const override;
+        const std::vector<size_t> GetPatternId(const til::point location) const override;
+        std::span<const interval_tree::IntervalTree<til::point, size_t>::interval> GetPatternIntervalsInRow(const til::CoordType row) const override;
+
+        std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept override;
+        const bool IsSelectionActive() const noexcept override;
+        const bool IsBlockSelection() const noexcept override;
+        void ClearSelection() noexcept override;
+        void SelectNewRegion(const til::point coordStart, const til::point coordEnd) noexcept override;
+        void SelectSearchRegions(std::vector<til::inclusive_rect> source) noexcept override;
+        const til::point GetSelectionAnchor() const noexcept override;
+        const til::point GetSelectionEnd() const noexcept override;
+        const bool IsUiaDataInitialized() const noexcept override;
+#pragma endregion
+
+    private:
+        TextBuffer& _activeBuffer() const noexcept;
+        Viewport _getMutableViewport() const noexcept;
+
+        RenderSettings _renderSettings;
+        NullRenderEngine _engine;
+        Microsoft::Console::Render::Renderer _renderer;
+        Microsoft::Console::VirtualTerminal::TerminalInput _terminalInput;
+        std::unique_ptr<Microsoft::Console::VirtualTerminal::StateMachine> _stateMachine;
+
+        std::unique_ptr<TextBuffer> _mainBuffer;
+        std::unique_ptr<TextBuffer> _altBuffer;
+        Viewport _mutableViewport;
+
+        til::enumset<Mode> _systemMode{ Mode::AutoWrap };
+        std::wstring _title;
+        FontInfo _fontInfo{ DEFAULT_FONT_FACE, TMPF_TRUETYPE, 10, { 0, DEFAULT_FONT_SIZE }, CP_UTF8, false };
+    };
+}
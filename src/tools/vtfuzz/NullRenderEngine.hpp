@@ -0,0 +1,67 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- NullRenderEngine.hpp
+
+Abstract:
+- A render engine that never paints anything. The Renderer still calls its
+  Invalidate*() methods, so the code producing the invalidations is exercised.
+--*/
+
+#pragma once
+
+#include "../../renderer/inc/RenderEngineBase.hpp"
+
+namespace VtFuzz
+{
+    class NullRenderEngine final : public Microsoft::Console::Render::RenderEngineBase
+    {
+    public:
+        [[nodiscard]] HRESULT StartPaint() noexcept override { return S_FALSE; }
+        [[nodiscard]] HRESULT EndPaint() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT Present() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+        [[nodiscard]] HRESULT ScrollFrame() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT Invalidate(const til::rect* /*psrRegion*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateCursor(const til::rect* /*psrRegion*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateSystem(const til::rect* /*prcDirtyClient*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateSelection(const std::vector<til::rect>& /*rectangles*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateScroll(const til::point* /*pcoordDelta*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateAll() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintBackground() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintBufferLine(std::span<const Microsoft::Console::Render::Cluster> /*clusters*/, til::point /*coord*/, bool /*fTrimLeft*/, bool /*lineWrapped*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintBufferGridLines(Microsoft::Console::Render::GridLineSet /*lines*/, COLORREF /*color*/, size_t /*cchLine*/, til::point /*coordTarget*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintSelection(const til::rect& /*rect*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintSelections(const std::vector<til::rect>& /*rects*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintCursor(const Microsoft::Console::Render::CursorOptions& /*options*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateDrawingBrushes(const TextAttribute& /*textAttributes*/, const Microsoft::Console::Render::RenderSettings& /*renderSettings*/, gsl::not_null<Microsoft::Console::Render::IRenderData*> /*pData*/, bool /*usingSoftFont*/, bool /*isSettingDefaultBrushes*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateDpi(int /*iDpi*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateViewport(const til::inclusive_rect& /*srNewViewport*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/, int /*iDpi*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT GetDirtyArea(std::span<const til::rect>& area) noexcept override
+        {
+            area = {};
+            return S_OK;
+        }
+        [[nodiscard]] HRESULT GetFontSize(_Out_ til::size* pFontSize) noexcept override
+        {
+            *pFontSize = {};
+            return S_OK;
+        }
+        [[nodiscard]] HRESULT IsGlyphWideByFont(std::wstring_view /*glyph*/, _Out_ bool* pResult) noexcept override
+        {
+            *pResult = false;
+            return S_OK;
+        }
+
+    protected:
+        [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view /*newTitle*/) noexcept override { return S_OK; }
+    };
+}
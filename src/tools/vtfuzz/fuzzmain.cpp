@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// libFuzzer entry point for the VT output path: StateMachine, OutputStateMachineEngine,
+// AdaptDispatch and TextBuffer, running in a HeadlessTerminal.
+//
+// Besides crashing, an input can fail by taking longer than its time budget, which grows
+// linearly with its length. That's how accidentally quadratic behavior is caught, like scroll
+// regions that move all of their rows for every line feed, huge parameter lists or giant OSC
+// strings. Such inputs are reported by aborting, so that libFuzzer saves them as crash artifacts.
+//
+// In the Fuzzing configuration:
+//   vtfuzz.exe -max_len=65536 corpus
+// In any other configuration it replays the given files (the seed corpus or crash artifacts)
+// and prints how long each one took, which turns the corpus into a regression test:
+//   vtfuzz.exe corpus
+
+#include "pch.h"
+#include "HeadlessTerminal.hpp"
+
+using namespace VtFuzz;
+
+namespace
+{
+    constexpr til::size viewportSize{ 80, 24 };
+    // Every input gets a new terminal. This is small enough to make that cheap,
+    // but large enough for long inputs to rotate the buffer.
+    constexpr til::CoordType scrollbackLines = 500;
+
+    // The budget is very generous, because Fuzzing builds are instrumented with ASan and coverage
+    // counters. The slowest sequences normally run at a few MB/s, even in such builds, whereas
+    // this allows for 0.5 MB/s. Anything slower is most likely not linear in the input length.
+    constexpr std::chrono::nanoseconds baseBudget{ std::chrono::milliseconds{ 20 } };
+    constexpr std::chrono::nanoseconds budgetPerByte{ 2000 };
+
+    std::chrono::nanoseconds budgetFor(const size_t size) noexcept
+    {
+        return baseBudget + budgetPerByte * gsl::narrow_cast<int64_t>(size);
+    }
+
+    std::chrono::nanoseconds process(const std::string_view input)
+    {
+        const auto text = til::u8u16(input);
+        // The terminal allocation isn't part of the measurement.
+        HeadlessTerminal terminal{ viewportSize, scrollbackLines };
+
+        const auto beg = std::chrono::steady_clock::now();
+        terminal.Write(text);
+        const auto end = std::chrono::steady_clock::now();
+        return end - beg;
+    }
+
+    long long micros(const std::chrono::nanoseconds duration) noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+}
+
+extern "C" __declspec(dllexport) int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const std::string_view input{ reinterpret_cast<const char*>(data), size };
+    const auto budget = budgetFor(size);
+
+    // Timings are noisy, so an input only counts as slow if it's slow twice in a row.
+    if (const auto elapsed = process(input); elapsed > budget && process(input) > budget)
+    {
+        fmt::print(stderr, "==vtfuzz== {} bytes took {} us, exceeding the budget of {} us\n", size, micros(elapsed), micros(budget));
+        std::abort();
+    }
+
+    return 0;
+}
+
+#ifndef FUZZING_BUILD
+int __cdecl wmain(int argc, const wchar_t* argv[])
+try
+{
+    std::vector<std::filesystem::path> paths;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (std::filesystem::is_directory(argv[i]))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator{ argv[i] })
+            {
+                paths.emplace_back(entry.path());
+            }
+        }
+        else
+        {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    auto slow = 0;
+    for (const auto& path : paths)
+    {
+        std::ostringstream buf;
+        buf << std::ifstream{ path, std::ios::binary }.rdbuf();
+        const auto input = buf.str();
+
+        const auto elapsed = process(input);
+        const auto budget = budgetFor(input.size());
+        const auto exceeded = elapsed > budget;
+        slow += exceeded;
+
+        fmt::print("{:>8} bytes {:>10} us {:>10} us budget  {}{}\n",
+                   input.size(),
+                   micros(elapsed),
+                   micros(budget),
+                   til::u16u8(path.native()),
+                   exceeded ? "  SLOW" : "");
+    }
+
+    return slow ? 1 : 0;
+}
+catch (const std::exception& e)
+{
+    fmt::print(stderr, "error: {}\n", e.what());
+    return 1;
+}
+#endif
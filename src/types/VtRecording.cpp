@@ -0,0 +1,403 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/VtRecording.hpp"
+
+#include <charconv>
+
+using namespace Microsoft::Console::Utils;
+
+namespace
+{
+    // Appends the UTF-8 `text` to `out`, escaped as the contents of a JSON string.
+    void appendJsonString(std::string& out, const std::string_view text)
+    {
+        for (const auto ch : text)
+        {
+            switch (ch)
+            {
+            case '"':
+                out.append("\\\"");
+                break;
+            case '\\':
+                out.append("\\\\");
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            case '\t':
+                out.append("\\t");
+                break;
+            default:
+                if (const auto byte = static_cast<uint8_t>(ch); byte < 0x20 || byte == 0x7f)
+                {
+                    fmt::format_to(std::back_inserter(out), FMT_COMPILE("\\u{:04x}"), byte);
+                }
+                else
+                {
+                    out.push_back(ch);
+                }
+                break;
+            }
+        }
+    }
+
+    // Just enough of a JSON parser to read asciicast files: the header object and event arrays.
+    // All methods return false or std::nullopt if the input isn't what they expected.
+    class JsonReader
+    {
+    public:
+        explicit JsonReader(const std::string_view text) noexcept :
+            _it{ text.data() },
+            _end{ text.data() + text.size() }
+        {
+        }
+
+        bool Consume(const char ch) noexcept
+        {
+            _skipWhitespace();
+            if (_it != _end && *_it == ch)
+            {
+                ++_it;
+                return true;
+            }
+            return false;
+        }
+
+        bool AtEnd() noexcept
+        {
+            _skipWhitespace();
+            return _it == _end;
+        }
+
+        std::optional<double> Number() noexcept
+        {
+            _skipWhitespace();
+            double value = 0;
+            const auto [ptr, ec] = std::from_chars(_it, _end, value);
+            if (ec != std::errc{})
+            {
+                return std::nullopt;
+            }
+            _it = ptr;
+            return value;
+        }
+
+        std::optional<std::wstring> String()
+        {
+            if (!Consume('"'))
+            {
+                return std::nullopt;
+            }
+
+            std::wstring out;
+            auto run = _it;
+            const auto flushRun = [&]() {
+                out.append(til::u8u16({ run, gsl::narrow_cast<size_t>(_it - run) }));
+            };
+
+            while (_it != _end)
+            {
+                const auto ch = *_it;
+                if (ch == '"')
+                {
+                    flushRun();
+                    ++_it;
+                    return out;
+                }
+                if (ch != '\\')
+                {
+                    ++_it;
+                    continue;
+                }
+
+                flushRun();
+                if (++_it == _end)
+                {
+                    break;
+                }
+
+                switch (*_it++)
+                {
+                case '"':
+                    out.push_back(L'"');
+                    break;
+                case '\\':
+                    out.push_back(L'\\');
+                    break;
+                case '/':
+                    out.push_back(L'/');
+                    break;
+                case 'b':
+                    out.push_back(L'\b');
+                    break;
+                case 'f':
+                    out.push_back(L'\f');
+                    break;
+                case 'n':
+                    out.push_back(L'\n');
+                    break;
+                case 'r':
+                    out.push_back(L'\r');
+                    break;
+                case 't':
+                    out.push_back(L'\t');
+                    break;
+                case 'u':
+                {
+                    // JSON escapes code points outside the BMP as surrogate pairs, which is exactly what we need.
+                    uint16_t codeUnit = 0;
+                    if (_end - _it < 4 || std::from_chars(_it, _it + 4, codeUnit, 16).ptr != _it + 4)
+                    {
+                        return std::nullopt;
+                    }
+                    _it += 4;
+                    out.push_back(static_cast<wchar_t>(codeUnit));
+                    break;
+                }
+                default:
+                    return std::nullopt;
+                }
+                run = _it;
+            }
+
+            return std::nullopt;
+        }
+
+        // Skips over any value, including nested objects and arrays.
+        bool SkipValue()
+        {
+            _skipWhitespace();
+            if (_it == _end)
+            {
+                return false;
+            }
+
+            switch (*_it)
+            {
+            case '"':
+                return String().has_value();
+            case '{':
+            case '[':
+            {
+                const auto close = *_it == '{' ? '}' : ']';
+                ++_it;
+                if (Consume(close))
+                {
+                    return true;
+                }
+                do
+                {
+                    if (close == '}' && !(String() && Consume(':')))
+                    {
+                        return false;
+                    }
+                    if (!SkipValue())
+                    {
+                        return false;
+                    }
+                } while (Consume(','));
+                return Consume(close);
+            }
+            default:
+                // Numbers, true, false and null.
+                while (_it != _end && *_it != ',' && *_it != '}' && *_it != ']' && !_isWhitespace(*_it))
+                {
+                    ++_it;
+                }
+                return true;
+            }
+        }
+
+    private:
+        static constexpr bool _isWhitespace(const char ch) noexcept
+        {
+            return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+        }
+
+        void _skipWhitespace() noexcept
+        {
+            while (_it != _end && _isWhitespace(*_it))
+            {
+                ++_it;
+            }
+        }
+
+        const char* _it;
+        const char* _end;
+    };
+
+    til::size parseHeader(const std::string_view line)
+    {
+        JsonReader reader{ line };
+        std::optional<double> version;
+        std::optional<double> width;
+        std::optional<double> height;
+
+        auto valid = reader.Consume('{');
+        if (valid && !reader.Consume('}'))
+        {
+            do
+            {
+                const auto key = reader.String();
+                valid = key && reader.Consume(':');
+                if (!valid)
+                {
+                    break;
+                }
+
+                if (*key == L"version")
+                {
+                    version = reader.Number();
+                }
+                else if (*key == L"width")
+                {
+                    width = reader.Number();
+                }
+                else if (*key == L"height")
+                {
+                    height = reader.Number();
+                }
+                else
+                {
+                    valid = reader.SkipValue();
+                }
+            } while (valid && reader.Consume(','));
+            valid = valid && reader.Consume('}');
+        }
+
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), !valid || version != 2.0 || !width || !height, "not an asciicast v2 header");
+        return { gsl::narrow<til::CoordType>(*width), gsl::narrow<til::CoordType>(*height) };
+    }
+
+    std::optional<VtRecordingEvent> parseEvent(const std::string_view line)
+    {
+        JsonReader reader{ line };
+        if (!reader.Consume('['))
+        {
+            return std::nullopt;
+        }
+
+        const auto time = reader.Number();
+        if (!time || !reader.Consume(','))
+        {
+            return std::nullopt;
+        }
+
+        const auto type = reader.String();
+        if (!type || type->size() != 1 || !reader.Consume(','))
+        {
+            return std::nullopt;
+        }
+
+        auto data = reader.String();
+        if (!data || !reader.Consume(']') || !reader.AtEnd())
+        {
+            return std::nullopt;
+        }
+
+        VtRecordingEvent event;
+        event.time = std::chrono::microseconds{ std::llround(*time * 1e6) };
+        event.type = static_cast<VtRecordingEvent::Type>(type->front());
+        event.data = std::move(*data);
+        return event;
+    }
+}
+
+VtRecording Microsoft::Console::Utils::ReadVtRecording(const std::filesystem::path& path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_OPEN_FAILED), !file, "failed to open %ls", path.c_str());
+
+    VtRecording recording;
+    std::string line;
+    size_t lineNumber = 1;
+
+    THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), !std::getline(file, line), "empty recording");
+    recording.size = parseHeader(line);
+
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        if (JsonReader{ line }.AtEnd())
+        {
+            continue;
+        }
+
+        auto event = parseEvent(line);
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), !event, "invalid event on line %zu", lineNumber);
+
+        if (event->type == VtRecordingEvent::Type::Output || event->type == VtRecordingEvent::Type::Resize)
+        {
+            recording.events.emplace_back(std::move(*event));
+        }
+    }
+
+    return recording;
+}
+
+VtRecorder::VtRecorder(const std::filesystem::path& path, const til::size size) :
+    _file{ path, std::ios::binary | std::ios::trunc },
+    _start{ std::chrono::steady_clock::now() }
+{
+    THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_OPEN_FAILED), !_file, "failed to create %ls", path.c_str());
+
+    const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    _file << fmt::format(R"({{"version": 2, "width": {}, "height": {}, "timestamp": {}}})", size.width, size.height, timestamp) << '\n';
+    THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), _file.fail(), "failed to write to %ls", path.c_str());
+}
+
+VtRecorder::~VtRecorder()
+{
+    if (!_stopped)
+    {
+        _file.flush();
+        LOG_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), _file.fail(), "failed to finish the VT recording");
+    }
+}
+
+void VtRecorder::RecordOutput(const std::wstring_view output)
+{
+    _writeEvent(VtRecordingEvent::Type::Output, output);
+}
+
+void VtRecorder::RecordResize(const til::size size)
+{
+    _writeEvent(VtRecordingEvent::Type::Resize, fmt::format(FMT_COMPILE(L"{}x{}"), size.width, size.height));
+}
+
+void VtRecorder::_writeEvent(const VtRecordingEvent::Type type, const std::wstring_view data)
+{
+    std::unique_lock lock{ _mutex };
+
+    if (_stopped)
+    {
+        return;
+    }
+
+    // The time is taken under the lock, so that the events are always in chronological order.
+    const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+
+    _line.clear();
+    fmt::format_to(std::back_inserter(_line), FMT_COMPILE("[{}.{:06}, \"{}\", \""), time / 1000000, time % 1000000, static_cast<char>(type));
+    // Unpaired surrogates can't be represented in UTF-8 and are recorded as U+FFFD.
+    appendJsonString(_line, til::u16u8(data));
+    _line.append("\"]\n");
+
+    // The file isn't flushed after every event, because that would slow down the output considerably.
+    // The stream's buffer is flushed when it's full and when the recorder is destroyed.
+    _file.write(_line.data(), gsl::narrow_cast<std::streamsize>(_line.size()));
+
+    // A failed write (for instance because the disk is full) fails all later ones as well.
+    // Instead of silently losing the rest of the recording, it's reported once and the recording stops.
+    if (_file.fail())
+    {
+        _stopped = true;
+        _file.close();
+        THROW_HR_MSG(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), "failed to write the VT recording, it has been stopped");
+    }
+}
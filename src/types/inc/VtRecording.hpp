@@ -0,0 +1,70 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- VtRecording.hpp
+
+Abstract:
+- Records the output a terminal receives in the asciicast v2 format, which asciinema and
+  other tools can play back, and reads such recordings back in. Every chunk of output is
+  stored exactly as it was handed to the terminal, together with the time it arrived at,
+  so that a recording can be replayed with the original chunking and timing.
+- See https://docs.asciinema.org/manual/asciicast/v2/ for the format.
+--*/
+
+#pragma once
+
+namespace Microsoft::Console::Utils
+{
+    struct VtRecordingEvent
+    {
+        enum class Type : wchar_t
+        {
+            Output = L'o',
+            Resize = L'r',
+        };
+
+        // The time relative to the start of the recording.
+        std::chrono::microseconds time{};
+        Type type = Type::Output;
+        // The output for Type::Output. For Type::Resize it's the new size as "<columns>x<rows>".
+        std::wstring data;
+    };
+
+    struct VtRecording
+    {
+        til::size size;
+        std::vector<VtRecordingEvent> events;
+    };
+
+    // Reads a recording. Unknown event types (input, markers, etc.) are skipped.
+    // Throws if the file can't be read or isn't a valid asciicast v2 file.
+    VtRecording ReadVtRecording(const std::filesystem::path& path);
+
+    // Appends events to a recording as they happen. It's safe to call
+    // RecordOutput and RecordResize from different threads.
+    // If writing to the file fails, the call that noticed it throws and the recording stops.
+    // All later calls do nothing.
+    class VtRecorder
+    {
+    public:
+        VtRecorder(const std::filesystem::path& path, const til::size size);
+        ~VtRecorder();
+
+        VtRecorder(const VtRecorder&) = delete;
+        VtRecorder& operator=(const VtRecorder&) = delete;
+
+        void RecordOutput(const std::wstring_view output);
+        void RecordResize(const til::size size);
+
+    private:
+        void _writeEvent(const VtRecordingEvent::Type type, const std::wstring_view data);
+
+        std::mutex _mutex;
+        std::ofstream _file;
+        std::string _line;
+        std::chrono::steady_clock::time_point _start;
+        bool _stopped = false;
+    };
+}
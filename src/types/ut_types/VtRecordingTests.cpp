@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../inc/VtRecording.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace std::string_view_literals;
+using namespace Microsoft::Console::Utils;
+
+class VtRecordingTests
+{
+    TEST_CLASS(VtRecordingTests);
+
+    static std::filesystem::path _tempPath()
+    {
+        return std::filesystem::temp_directory_path() / fmt::format(FMT_COMPILE(L"VtRecordingTests-{}.cast"), GetCurrentProcessId());
+    }
+
+    TEST_METHOD(RoundTrip)
+    {
+        const auto path = _tempPath();
+        const auto cleanup = wil::scope_exit([&]() { std::filesystem::remove(path); });
+
+        // ESC, quotes, backslashes, control characters, non-ASCII text and a surrogate pair must all survive.
+        const std::wstring_view output1{ L"\x1b[31mred\x1b[m \"quoted\" back\\slash\r\n" };
+        const std::wstring_view output2{ L"\x7f\t\x07 grüße 漢字 \U0001F600" };
+
+        {
+            VtRecorder recorder{ path, { 120, 30 } };
+            recorder.RecordOutput(output1);
+            recorder.RecordResize({ 80, 24 });
+            recorder.RecordOutput(output2);
+        }
+
+        const auto recording = ReadVtRecording(path);
+        VERIFY_ARE_EQUAL(til::size(120, 30), recording.size);
+        VERIFY_ARE_EQUAL(3u, recording.events.size());
+
+        VERIFY_IS_TRUE(recording.events[0].type == VtRecordingEvent::Type::Output);
+        VERIFY_ARE_EQUAL(output1, std::wstring_view{ recording.events[0].data });
+        VERIFY_IS_TRUE(recording.events[1].type == VtRecordingEvent::Type::Resize);
+        VERIFY_ARE_EQUAL(L"80x24"sv, std::wstring_view{ recording.events[1].data });
+        VERIFY_IS_TRUE(recording.events[2].type == VtRecordingEvent::Type::Output);
+        VERIFY_ARE_EQUAL(output2, std::wstring_view{ recording.events[2].data });
+
+        VERIFY_IS_TRUE(recording.events[0].time <= recording.events[1].time);
+        VERIFY_IS_TRUE(recording.events[1].time <= recording.events[2].time);
+    }
+
+    TEST_METHOD(ReadForeignRecording)
+    {
+        const auto path = _tempPath();
+        const auto cleanup = wil::scope_exit([&]() { std::filesystem::remove(path); });
+
+        // A recording as asciinema writes it: The header has additional keys,
+        // there's an input event and a non-BMP character is escaped as a surrogate pair.
+        std::ofstream{ path, std::ios::binary } << R"({"version": 2, "width": 100, "height": 50, "timestamp": 1500000000, "env": {"SHELL": "/bin/bash", "TERM": "xterm-256color"}, "tags": [], "idle_time_limit": null})" "\n"
+                                                   R"([0.25, "o", "$ "])" "\n"
+                                                   R"([1.5, "i", "ls\r"])" "\n"
+                                                   "\n"
+                                                   R"([1.75, "o", "\ud83d\ude00 \u001b[0m\/"])" "\n";
+
+        const auto recording = ReadVtRecording(path);
+        VERIFY_ARE_EQUAL(til::size(100, 50), recording.size);
+        VERIFY_ARE_EQUAL(2u, recording.events.size());
+
+        VERIFY_ARE_EQUAL(250000ll, recording.events[0].time.count());
+        VERIFY_ARE_EQUAL(L"$ "sv, std::wstring_view{ recording.events[0].data });
+        VERIFY_ARE_EQUAL(1750000ll, recording.events[1].time.count());
+        VERIFY_ARE_EQUAL(L"\U0001F600 \x1b[0m/"sv, std::wstring_view{ recording.events[1].data });
+    }
+
+    TEST_METHOD(ReadInvalidRecording)
+    {
+        const auto path = _tempPath();
+        const auto cleanup = wil::scope_exit([&]() { std::filesystem::remove(path); });
+
+        std::ofstream{ path, std::ios::binary } << R"({"version": 2, "width": 100, "height": 50})" "\n"
+                                                   R"([0.25, "o", "unterminated])" "\n";
+
+        VERIFY_THROWS(ReadVtRecording(path), wil::ResultException);
+    }
+};